@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+# Compile time of myassert.hpp's deduced macros against myassert.h's
+# typed ones.
+#
+#   bench/compile_time.sh
+#
+# Generates a C++ translation unit of TESTS (default 200) TESTs with
+# CHECKS_PER_TEST (default 10) integer checks each, once with the typed
+# macros of myassert.h and once with the same checks written with the
+# deduced macros of myassert.hpp. Each is compiled RUNS (default 11) times
+# at -O0 and -O2, interleaved with a TU that only includes the header, and
+# the median user+sys time is printed.
+
+set -e
+
+CXX=${CXX:-c++}
+TESTS=${TESTS:-200}
+CHECKS_PER_TEST=${CHECKS_PER_TEST:-10}
+RUNS=${RUNS:-11}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# $1 is typed or deduced.
+generate()
+{
+    awk -v style="$1" -v tests="$TESTS" -v checks="$CHECKS_PER_TEST" 'BEGIN {
+        split("ASSERT_EQ ASSERT_LT ASSERT_GE ASSERT_NE ASSERT_LE EXPECT_EQ EXPECT_GT EXPECT_NE EXPECT_LE EXPECT_GE", macro, " ")
+        split("INT32 UINT64 INT8 SIZE UINT16 INT64 INT32 UINT8 SIZE INT16", suffix, " ")
+        split("int32_t uint64_t int8_t size_t uint16_t int64_t int32_t uint8_t size_t int16_t", type, " ")
+        split("i32 u64 i8 sz u16 i64 i32 u8 sz i16", input, " ")
+        print(style == "typed" ? "#include \"myassert.h\"" : "#include \"myassert.hpp\"")
+        print "int32_t i32[64]; uint64_t u64[64]; int8_t i8[64]; size_t sz[64];"
+        print "uint16_t u16[64]; int64_t i64[64]; uint8_t u8[64]; int16_t i16[64];"
+        for (t = 0; t < tests; t++) {
+            printf "TEST(test_%d)\n{\n", t
+            for (c = 0; c < checks; c++) {
+                k = c % 10 + 1
+                name = style == "typed" ? macro[k] "_" suffix[k] : macro[k]
+                printf "    %s(%s[%d], (%s)%d);\n", name, input[k], (t + c) % 64, type[k], (t * checks + c) % 100
+            }
+            print "    RETURN_OK();\n}"
+        }
+    }' > "$WORK/$1.cc"
+}
+
+generate typed
+generate deduced
+echo '#include "myassert.h"' > "$WORK/empty.cc"
+
+TIMEFORMAT='%3U %3S'
+for opt in -O0 -O2; do
+    for run in $(seq "$RUNS"); do
+        for tu in empty typed deduced; do
+            { time "$CXX" -std=c++11 -I"$ROOT" $opt -c "$WORK/$tu.cc" -o /dev/null \
+                2> "$WORK/errors"; } 2>> "$WORK/$tu$opt.times" || {
+                cat "$WORK/errors"
+                exit 1
+            }
+        done
+    done
+    for tu in empty typed deduced; do
+        awk '{ print $1 + $2 }' "$WORK/$tu$opt.times" | sort -n | awk -v tu="$tu" -v opt="$opt" '
+            { t[NR] = $1 }
+            END { printf "%s %-8s %6.2f s\n", opt, tu, t[int((NR + 1) / 2)] }'
+    done
+done
@@ -0,0 +1,88 @@
+// Cost of passing assertions on a hot path: two range checks per element
+// of an array, timed against the same loop without them.
+//
+//   cc -O2 -D_GNU_SOURCE -DMYASSERT_HEADER='"path/to/myassert.h"' hot_loop.c -pthread
+
+#ifndef MYASSERT_HEADER
+#define MYASSERT_HEADER "../myassert.h"
+#endif
+#include MYASSERT_HEADER
+
+#include <time.h>
+
+#define ELEMENTS 4096
+#define ROUNDS 50000
+
+// Out of line, so the checks cannot be hoisted out of the timed loop.
+MYASSERT_ATTR((noinline))
+static uint64_t sum_checked(const int32_t *values, size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_GE_INT32(values[i], (int32_t)0);
+        ASSERT_LT_INT32(values[i], (int32_t)1000);
+        sum += (uint64_t)values[i];
+    }
+    return sum;
+}
+
+MYASSERT_ATTR((noinline))
+static uint64_t sum_plain(const int32_t *values, size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += (uint64_t)values[i];
+    }
+    return sum;
+}
+
+static double elapsed_ns(uint64_t (*sum)(const int32_t *, size_t), const int32_t *values,
+                         uint64_t *total)
+{
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        *total += sum(values, ELEMENTS);
+        __asm__ volatile("" ::: "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+}
+
+int main(void)
+{
+    static int32_t values[ELEMENTS];
+    srand(1);
+    for (size_t i = 0; i < ELEMENTS; i++)
+    {
+        values[i] = rand() % 1000;
+    }
+
+    uint64_t total = 0;
+    double best_checked = 0.0;
+    double best_plain = 0.0;
+    for (int run = 0; run < 5; run++)
+    {
+        double checked = elapsed_ns(sum_checked, values, &total);
+        double plain = elapsed_ns(sum_plain, values, &total);
+        if (run == 0 || checked < best_checked)
+        {
+            best_checked = checked;
+        }
+        if (run == 0 || plain < best_plain)
+        {
+            best_plain = plain;
+        }
+    }
+
+    double elements = (double)ELEMENTS * ROUNDS;
+    printf("checked   %.3f ns/element (%.3f ns/assertion)\n", best_checked / elements,
+           best_checked / (2.0 * elements));
+    printf("unchecked %.3f ns/element\n", best_plain / elements);
+    printf("overhead  %.3f ns/assertion\n", (best_checked - best_plain) / (2.0 * elements));
+    return total == 0;
+}
@@ -0,0 +1,60 @@
+#!/bin/sh
+# Code size of passing assertions, and their cost on a hot path.
+#
+#   bench/size.sh [header]
+#
+# Generates one translation unit with CHECKS (default 2000) distinct typed
+# assertions and prints its section sizes at -O2 and -Os, then runs
+# hot_loop.c. The header defaults to the myassert.h next to this directory.
+# To compare with an older version, extract it first:
+#
+#   git show <commit>:myassert.h > /tmp/before.h
+#   bench/size.sh /tmp/before.h
+#   bench/size.sh
+
+set -e
+
+CC=${CC:-cc}
+CHECKS=${CHECKS:-2000}
+BENCH=$(cd "$(dirname "$0")" && pwd)
+HEADER=${1:-$BENCH/../myassert.h}
+HEADER=$(cd "$(dirname "$HEADER")" && pwd)/$(basename "$HEADER")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+awk -v checks="$CHECKS" 'BEGIN {
+    print "#include MYASSERT_HEADER"
+    print "int check(const int32_t *v, const uint64_t *u, const double *d, const char *const *s);"
+    print "int check(const int32_t *v, const uint64_t *u, const double *d, const char *const *s)"
+    print "{"
+    for (i = 0; i < checks; i++) {
+        kind = i % 5
+        if (kind == 0)
+            printf "    ASSERT_GE_INT32(v[%d], (int32_t)%d);\n", i, i
+        else if (kind == 1)
+            printf "    ASSERT_LT_UINT64(u[%d], (uint64_t)%d);\n", i, i * 7
+        else if (kind == 2)
+            printf "    ASSERT_EQ_DOUBLE(d[%d], %d.0, 1.0);\n", i, i
+        else if (kind == 3)
+            printf "    ASSERT_NE_INT32(v[%d], (int32_t)-%d);\n", i, i
+        else
+            printf "    ASSERT_EQ_STR(s[%d], \"s%d\");\n", i % 64, i
+    }
+    print "    return 0;"
+    print "}"
+}' > "$WORK/checks.c"
+
+echo "$HEADER, $CHECKS checks"
+for opt in -O2 -Os; do
+    "$CC" -std=c11 -D_GNU_SOURCE "-DMYASSERT_HEADER=\"$HEADER\"" $opt -c "$WORK/checks.c" \
+        -o "$WORK/checks.o"
+    size -A "$WORK/checks.o" | awk -v opt="$opt" '
+        $1 == ".text" { text += $2 }
+        $1 ~ /^\.rodata/ { rodata += $2 }
+        $1 ~ /^\.data\.rel\.ro/ { relro += $2 }
+        END { printf "%-4s text %8d  rodata %8d  data.rel.ro %8d\n", opt, text, rodata, relro }'
+done
+
+"$CC" -std=c11 -D_GNU_SOURCE "-DMYASSERT_HEADER=\"$HEADER\"" -O2 "$BENCH/hot_loop.c" \
+    -o "$WORK/hot_loop" -pthread -lm
+"$WORK/hot_loop"
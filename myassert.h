@@ -23,819 +23,10087 @@
 #ifndef MYASSERT_H
 #define MYASSERT_H
 
+#ifndef MYASSERT_HAVE_POSIX
+#if defined(__unix__) || defined(__APPLE__)
+#define MYASSERT_HAVE_POSIX 1
+#else
+#define MYASSERT_HAVE_POSIX 0
+#endif
+#endif
+
+// The runner needs POSIX and GNU extensions (fork, mmap, ...) even when the
+// including file is compiled with a strict -std=c11. This only takes effect
+// when myassert.h is included before any system header.
+#if MYASSERT_HAVE_POSIX && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stddef.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <math.h>
+#include <float.h>
+#include <time.h>
+#include <setjmp.h>
 
-#define FATAL(msg)                                    \
-    do                                                \
-    {                                                 \
-        fprintf(stderr,                               \
-                "Fatal error in %s on line %d: %s\n", \
-                __FILE__,                             \
-                __LINE__,                             \
-                msg);                                 \
-        fflush(stderr);                               \
-        abort();                                      \
-    } while (0)
-
-#define ASSERT(expr)                                           \
-    do                                                         \
-    {                                                          \
-        if (!(expr))                                           \
-        {                                                      \
-            fprintf(stderr,                                    \
-                    "Assertion failed in %s on line %d: %s\n", \
-                    __FILE__,                                  \
-                    __LINE__,                                  \
-                    #expr);                                    \
-            abort();                                           \
-        }                                                      \
-    } while (0)
+#if MYASSERT_HAVE_POSIX
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __ELF__
+#include <link.h>
+#endif
+#ifdef __linux__
+#include <stdio_ext.h>
+#endif
+#endif
 
-#define ASSERT_BASE(a, operator, b, type, conv)                      \
-    do                                                               \
-    {                                                                \
-        type const eval_a = (a);                                     \
-        type const eval_b = (b);                                     \
-        if (!(eval_a operator eval_b))                               \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s %s %s` " \
-                    "(%" conv " %s %" conv ")\n",                    \
-                    __FILE__,                                        \
-                    __LINE__,                                        \
-                    #a,                                              \
-                    #operator,                                       \
-                    #b,                                              \
-                    eval_a,                                          \
-                    #operator,                                       \
-                    eval_b);                                         \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+// SSE2 is part of x86-64. The AVX2 kernels need <immintrin.h>, which is
+// slow to parse, so they are only compiled when the target has AVX2 or
+// MYASSERT_AVX2 is defined to 1. They are built with a target attribute
+// and only called when the CPU reports AVX2 at run time.
+#ifndef MYASSERT_HAVE_X86_SIMD
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MYASSERT_HAVE_X86_SIMD 1
+#else
+#define MYASSERT_HAVE_X86_SIMD 0
+#endif
+#endif
 
-#define ASSERT_OK(a)                                                \
-    do                                                              \
-    {                                                               \
-        int64_t const eval_a = (a);                                 \
-        if (eval_a)                                                 \
-        {                                                           \
-            fprintf(stderr,                                         \
-                    "Assertion failed in %s on line %d: `%s` okay " \
-                    "(error: %" PRId64 ")\n",                       \
-                    __FILE__,                                       \
-                    __LINE__,                                       \
-                    #a,                                             \
-                    eval_a);                                        \
-            abort();                                                \
-        }                                                           \
-    } while (0)
+#ifndef MYASSERT_AVX2
+#if MYASSERT_HAVE_X86_SIMD && defined(__AVX2__)
+#define MYASSERT_AVX2 1
+#else
+#define MYASSERT_AVX2 0
+#endif
+#endif
 
-#define ASSERT_BASE_STR(expr, a, operator, b, type, conv)            \
-    do                                                               \
-    {                                                                \
-        if (!(expr))                                                 \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s %s %s` " \
-                    "(%" conv " %s %" conv ")\n",                    \
-                    __FILE__,                                        \
-                    __LINE__,                                        \
-                    #a,                                              \
-                    #operator,                                       \
-                    #b,                                              \
-                    (type)a,                                         \
-                    #operator,(type) b);                             \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+#if MYASSERT_HAVE_X86_SIMD
+#include <emmintrin.h>
+#endif
+#if MYASSERT_HAVE_X86_SIMD && MYASSERT_AVX2
+#include <immintrin.h>
+#endif
 
-#define ASSERT_BASE_LEN(expr, a, operator, b, conv, len)             \
-    do                                                               \
-    {                                                                \
-        if (!(expr))                                                 \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s %s %s` " \
-                    "(%.*" #conv " %s %.*" #conv ")\n",              \
-                    __FILE__,                                        \
-                    __LINE__,                                        \
-                    #a,                                              \
-                    #operator,                                       \
-                    #b,                                              \
-                    (int)len,                                        \
-                    a,                                               \
-                    #operator,(int) len,                             \
-                    b);                                              \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+// Hardware and software event counters through perf_event_open(2).
+#ifndef MYASSERT_HAVE_PERF
+#if MYASSERT_HAVE_POSIX && defined(__linux__)
+#define MYASSERT_HAVE_PERF 1
+#else
+#define MYASSERT_HAVE_PERF 0
+#endif
+#endif
 
-enum TestStatus
-{
-    TEST_OK = 0,
-    TEST_SKIP = 1
-};
+#if MYASSERT_HAVE_PERF
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
-#define RETURN_OK()     \
-    do                  \
-    {                   \
-        return TEST_OK; \
-    } while (0)
+#if defined(__GNUC__) || defined(__clang__)
+#define MYASSERT_ATTR(x) __attribute__(x)
+#else
+#define MYASSERT_ATTR(x)
+#endif
 
-#define RETURN_SKIP(explanation)              \
-    do                                        \
-    {                                         \
-        fprintf(stderr, "%s\n", explanation); \
-        fflush(stderr);                       \
-        return TEST_SKIP;                     \
-    } while (0)
+#if defined(__GNUC__) || defined(__clang__)
+#define MYASSERT_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define MYASSERT_THREAD_LOCAL __declspec(thread)
+#else
+#define MYASSERT_THREAD_LOCAL _Thread_local
+#endif
 
-#define RUN_TEST(test_func)                   \
-    do                                        \
-    {                                         \
-        printf("Running %s... ", #test_func); \
-        fflush(stdout);                       \
-        int result = test_func();             \
-        if (result == TEST_OK)                \
-        {                                     \
-            printf("PASSED\n");               \
-        }                                     \
-        else if (result == TEST_SKIP)         \
-        {                                     \
-            printf("SKIPPED\n");              \
-        }                                     \
-        else                                  \
-        {                                     \
-            printf("FAILED\n");               \
-        }                                     \
-    } while (0)
+// State that must be shared by every translation unit including this
+// header is defined weak, so the linker folds the copies into one.
+#define MYASSERT_SHARED MYASSERT_ATTR((weak))
 
-// =============================================================
-// BOOLEAN ASSERTIONS
-// =============================================================
+#define MYASSERT_COLD MYASSERT_ATTR((noinline, cold, unused))
 
-#define ASSERT_TRUE(a) \
-    ASSERT_BASE(a, ==, true, bool, "d")
+#if defined(__GNUC__) || defined(__clang__)
+#define MYASSERT_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define MYASSERT_UNLIKELY(x) (x)
+#endif
 
-#define ASSERT_FALSE(a) \
-    ASSERT_BASE(a, ==, false, bool, "d")
+#ifndef STDERR_FILENO
+#define STDERR_FILENO 2
+#endif
 
 // =============================================================
-// NULL ASSERTIONS
+// ASSERTION LEVELS
 // =============================================================
 
-#define ASSERT_NULL(a) \
-    ASSERT_BASE(a, ==, NULL, const void *, "p")
+#define MYASSERT_LEVEL_OFF 0
+#define MYASSERT_LEVEL_FATAL 1
+#define MYASSERT_LEVEL_NORMAL 2
+#define MYASSERT_LEVEL_PARANOID 3
 
-#define ASSERT_NOT_NULL(a) \
-    ASSERT_BASE(a, !=, NULL, const void *, "p")
+#ifndef MYASSERT_LEVEL
+#define MYASSERT_LEVEL MYASSERT_LEVEL_NORMAL
+#endif
 
-// =============================================================
-// MEMORY ASSERTIONS
-// =============================================================
+// ASSERT_* are checked from MYASSERT_LEVEL_FATAL up, EXPECT_* from
+// MYASSERT_LEVEL_NORMAL and DEBUG_ASSERT_* only at MYASSERT_LEVEL_PARANOID.
+// A disabled check is still type-checked, but its operands are not
+// evaluated. With MYASSERT_ASSUME defined, a disabled ASSERT_* becomes an
+// optimizer hint instead, so its operands must be free of side effects.
+#define MYASSERT_ENABLED(level) (MYASSERT_LEVEL >= (level))
 
-#define ASSERT_EQ_MEM(a, b, len) \
-    ASSERT_BASE_LEN(memcmp(a, b, len) == 0, a, ==, b, "p", len)
+// A disabled DEBUG_ASSERT_* is only type-checked, inside sizeof, so its
+// site is not emitted even though the ASSERT_* it wraps is enabled.
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_PARANOID)
+#define MYASSERT_DEBUG(check) check
+#elif defined(__GNUC__)
+#define MYASSERT_DEBUG(check)        \
+    do                               \
+    {                                \
+        (void)sizeof(__extension__({ \
+            check;                   \
+            0;                       \
+        }));                         \
+    } while (0)
+#else
+#define MYASSERT_DEBUG(check) \
+    do                        \
+    {                         \
+        if (0)                \
+        {                     \
+            check;            \
+        }                     \
+    } while (0)
+#endif
 
-#define ASSERT_NE_MEM(a, b, len) \
-    ASSERT_BASE_LEN(memcmp(a, b, len) != 0, a, !=, b, "p", len)
+#if !defined(MYASSERT_ASSUME)
+#define MYASSERT_HINT(cond) ((void)0)
+#elif defined(__clang__)
+#define MYASSERT_HINT(cond) __builtin_assume(cond)
+#elif defined(__GNUC__)
+#define MYASSERT_HINT(cond)          \
+    do                               \
+    {                                \
+        if (!(cond))                 \
+            __builtin_unreachable(); \
+    } while (0)
+#elif defined(_MSC_VER)
+#define MYASSERT_HINT(cond) __assume(cond)
+#else
+#define MYASSERT_HINT(cond) ((void)0)
+#endif
 
 // =============================================================
-// STRING ASSERTIONS
+// FAILURE REPORTING
 // =============================================================
 
-#define ASSERT_EQ_STR(a, b) \
-    ASSERT_BASE_STR(strcmp(a, b) == 0, a, ==, b, char *, "s")
-
-#define ASSERT_NE_STR(a, b) \
-    ASSERT_BASE_STR(strcmp(a, b) != 0, a, !=, b, char *, "s")
+#ifndef MYASSERT_EXPECT_CAPACITY
+#define MYASSERT_EXPECT_CAPACITY 32
+#endif
 
-#define ASSERT_EQ_STR_LEN(a, b, len) \
-    ASSERT_BASE_LEN(strncmp(a, b, len) == 0, a, ==, b, "s", len)
+#ifndef MYASSERT_EXPECT_CAPTURE
+#define MYASSERT_EXPECT_CAPTURE 48
+#endif
 
-#define ASSERT_NE_STR_LEN(a, b, len) \
-    ASSERT_BASE_LEN(strncmp(a, b, len) != 0, a, !=, b, "s", len)
+#ifndef MYASSERT_MESSAGE_SIZE
+#define MYASSERT_MESSAGE_SIZE 1024
+#endif
 
-// ==============================================
-// BASIC INTEGER ASSERTIONS
-// ==============================================
+#ifndef MYASSERT_FAILURE_RING
+#define MYASSERT_FAILURE_RING 0
+#endif
 
-#define ASSERT_EQ(a, b) ASSERT_BASE(a, ==, b, int64_t, PRId64)
-#define ASSERT_GE(a, b) ASSERT_BASE(a, >=, b, int64_t, PRId64)
-#define ASSERT_GT(a, b) ASSERT_BASE(a, >, b, int64_t, PRId64)
-#define ASSERT_LE(a, b) ASSERT_BASE(a, <=, b, int64_t, PRId64)
-#define ASSERT_LT(a, b) ASSERT_BASE(a, <, b, int64_t, PRId64)
-#define ASSERT_NE(a, b) ASSERT_BASE(a, !=, b, int64_t, PRId64)
+enum myassert_site_kind
+{
+    MYASSERT_SITE_EXPR,
+    MYASSERT_SITE_OK,
+    MYASSERT_SITE_VALUE,
+    MYASSERT_SITE_TEXT,
+    MYASSERT_SITE_EPSILON,
+    MYASSERT_SITE_ARRAY,
+    MYASSERT_SITE_MEMORY,
+    MYASSERT_SITE_FILE,
+    MYASSERT_SITE_SNAPSHOT,
+    MYASSERT_SITE_TOLERANCE,
+    MYASSERT_SITE_LATENCY
+};
 
-// ==============================================
-// TYPE-SAFE INTEGER ASSERTIONS
-// ==============================================
+// Everything about a check that is known at compile time. Each expansion
+// owns one static instance, so a failure record only stores a pointer.
+struct myassert_site
+{
+    const char *file;
+    int line;
+    int kind;
+    const char *macro;
+    const char *a;
+    const char *op;
+    const char *b;
+    const char *conv;
+    uint64_t hits;
+};
 
-#define TYPE_CHECK(expr, expected_type)                                     \
-    do                                                                      \
-    {                                                                       \
-        expected_type _type_check_var = expr;                               \
-        (void)_type_check_var;                                              \
-        (void)sizeof(char[sizeof(expr) == sizeof(expected_type) ? 1 : -1]); \
-    } while (0)
+// With MYASSERT_COUNT_SITES, every pass through a check bumps the hit
+// counter of its site: 1 counts exactly with a relaxed atomic add, 2
+// counts per thread and adds to the site on the first hit and then every
+// MYASSERT_SITE_BATCH hits. That avoids contended atomics. The partial
+// batches of a thread are added when it exits, and those of the calling
+// thread by myassert_dump_sites.
+#ifndef MYASSERT_COUNT_SITES
+#define MYASSERT_COUNT_SITES 0
+#endif
 
-// ==============================================
-// INT8_T ASSERTIONS
-// ==============================================
+#ifndef MYASSERT_SITE_BATCH
+#define MYASSERT_SITE_BATCH 1024
+#endif
 
-#define ASSERT_EQ_INT8(a, b)                  \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, int8_t);                \
-        TYPE_CHECK(b, int8_t);                \
-        ASSERT_BASE(a, ==, b, int8_t, PRId8); \
-    } while (0)
+#if MYASSERT_COUNT_SITES
+#define MYASSERT_SITE_CONST
+#else
+#define MYASSERT_SITE_CONST const
+#endif
 
-#define ASSERT_GE_INT8(a, b)                  \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, int8_t);                \
-        TYPE_CHECK(b, int8_t);                \
-        ASSERT_BASE(a, >=, b, int8_t, PRId8); \
-    } while (0)
+#if MYASSERT_COUNT_SITES == 2
+// The hits of one site a thread has not added yet. Each thread links the
+// counters of the sites it ran, so they can be flushed later.
+struct myassert_site_pending
+{
+    struct myassert_site *site;
+    uint32_t count;
+    bool linked;
+    struct myassert_site_pending *next;
+};
 
-#define ASSERT_GT_INT8(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, int8_t);               \
-        TYPE_CHECK(b, int8_t);               \
-        ASSERT_BASE(a, >, b, int8_t, PRId8); \
-    } while (0)
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_site_pending *myassert_site_pending_list;
 
-#define ASSERT_LE_INT8(a, b)                  \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, int8_t);                \
-        TYPE_CHECK(b, int8_t);                \
-        ASSERT_BASE(a, <=, b, int8_t, PRId8); \
-    } while (0)
+static inline void myassert_site_flush(void *list)
+{
+    for (struct myassert_site_pending *pending = (struct myassert_site_pending *)list;
+         pending != NULL; pending = pending->next)
+    {
+        __atomic_fetch_add(&pending->site->hits, pending->count, __ATOMIC_RELAXED);
+        pending->count = 0;
+    }
+}
 
-#define ASSERT_LT_INT8(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, int8_t);               \
-        TYPE_CHECK(b, int8_t);               \
-        ASSERT_BASE(a, <, b, int8_t, PRId8); \
-    } while (0)
+#if MYASSERT_HAVE_POSIX
+// Its destructor flushes the list of a thread that exits.
+MYASSERT_SHARED pthread_key_t myassert_site_key;
+MYASSERT_SHARED pthread_once_t myassert_site_once = PTHREAD_ONCE_INIT;
 
-#define ASSERT_NE_INT8(a, b)                  \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, int8_t);                \
-        TYPE_CHECK(b, int8_t);                \
-        ASSERT_BASE(a, !=, b, int8_t, PRId8); \
-    } while (0)
+static inline void myassert_site_key_create(void)
+{
+    pthread_key_create(&myassert_site_key, myassert_site_flush);
+}
+#endif
 
-// ==============================================
-// UINT8_T ASSERTIONS
-// ==============================================
+MYASSERT_COLD
+static void myassert_site_add(struct myassert_site_pending *pending, struct myassert_site *site)
+{
+    if (!pending->linked)
+    {
+        pending->site = site;
+        pending->linked = true;
+        pending->next = myassert_site_pending_list;
+        myassert_site_pending_list = pending;
+#if MYASSERT_HAVE_POSIX
+        pthread_once(&myassert_site_once, myassert_site_key_create);
+        pthread_setspecific(myassert_site_key, pending);
+#endif
+    }
+    __atomic_fetch_add(&pending->site->hits, pending->count, __ATOMIC_RELAXED);
+    pending->count = 0;
+}
+#endif
 
-#define ASSERT_EQ_UINT8(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, uint8_t);                \
-        TYPE_CHECK(b, uint8_t);                \
-        ASSERT_BASE(a, ==, b, uint8_t, PRIu8); \
+#if MYASSERT_COUNT_SITES == 1
+#define MYASSERT_HIT(site) ((void)__atomic_fetch_add(&(site).hits, 1, __ATOMIC_RELAXED))
+#elif MYASSERT_COUNT_SITES == 2
+#define MYASSERT_HIT(site)                                                        \
+    do                                                                            \
+    {                                                                             \
+        static MYASSERT_THREAD_LOCAL struct myassert_site_pending myassert_pending = \
+            {NULL, 0, false, NULL};                                               \
+        if (MYASSERT_UNLIKELY(++myassert_pending.count == MYASSERT_SITE_BATCH ||  \
+                              !myassert_pending.linked))                          \
+        {                                                                         \
+            myassert_site_add(&myassert_pending, &(site));                        \
+        }                                                                         \
     } while (0)
+#else
+#define MYASSERT_HIT(site) ((void)0)
+#endif
 
-#define ASSERT_GE_UINT8(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, uint8_t);                \
-        TYPE_CHECK(b, uint8_t);                \
-        ASSERT_BASE(a, >=, b, uint8_t, PRIu8); \
-    } while (0)
+// Every site also stores a pointer to itself in the myassert_sites
+// section, which the linker brackets with __start_/__stop_ symbols. The
+// registry holds pointers rather than the sites, since the compiler may
+// pad large static objects and break a stride walk over the section.
+//
+// GCC refuses to share a named section between statics of inline C++
+// functions and of ordinary ones, so C++ code has to opt in with
+// MYASSERT_SITE_REGISTRY=1 when it has no checks in inline functions.
+#ifndef MYASSERT_SITE_REGISTRY
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__cplusplus)
+#define MYASSERT_SITE_REGISTRY 1
+#else
+#define MYASSERT_SITE_REGISTRY 0
+#endif
+#endif
 
-#define ASSERT_GT_UINT8(a, b)                 \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, uint8_t);               \
-        TYPE_CHECK(b, uint8_t);               \
-        ASSERT_BASE(a, >, b, uint8_t, PRIu8); \
-    } while (0)
+#if MYASSERT_SITE_REGISTRY
+#define MYASSERT_REGISTER_SITE(name)                      \
+    ;                                                     \
+    static const struct myassert_site *const name##_entry \
+        MYASSERT_ATTR((used, section("myassert_sites"))) = &name
+#else
+#define MYASSERT_REGISTER_SITE(name)
+#endif
 
-#define ASSERT_LE_UINT8(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, uint8_t);                \
-        TYPE_CHECK(b, uint8_t);                \
-        ASSERT_BASE(a, <=, b, uint8_t, PRIu8); \
-    } while (0)
+// The site of a check of the given level. A check that MYASSERT_LEVEL
+// compiles out gets an automatic site instead, which is not registered
+// and, like the rest of the dead check, is not emitted when optimizing.
+#define MYASSERT_SITE(level, ...) MYASSERT_SITE_AT(level, __VA_ARGS__)
+#define MYASSERT_SITE_AT(level, ...) MYASSERT_SITE_##level(__VA_ARGS__)
 
-#define ASSERT_LT_UINT8(a, b)                 \
-    do                                        \
-    {                                         \
-        TYPE_CHECK(a, uint8_t);               \
-        TYPE_CHECK(b, uint8_t);               \
-        ASSERT_BASE(a, <, b, uint8_t, PRIu8); \
-    } while (0)
+#define MYASSERT_SITE_STATIC(name, macro, kind, a, operator, b, conv) \
+    static MYASSERT_SITE_CONST struct myassert_site name =            \
+        {__FILE__, __LINE__, kind, macro, a, operator, b, conv, 0}    \
+    MYASSERT_REGISTER_SITE(name)
+#define MYASSERT_SITE_DEAD(name, macro, kind, a, operator, b, conv) \
+    MYASSERT_SITE_CONST struct myassert_site name =                 \
+        {__FILE__, __LINE__, kind, macro, a, operator, b, conv, 0}
 
-#define ASSERT_NE_UINT8(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, uint8_t);                \
-        TYPE_CHECK(b, uint8_t);                \
-        ASSERT_BASE(a, !=, b, uint8_t, PRIu8); \
-    } while (0)
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL)
+#define MYASSERT_SITE_1 MYASSERT_SITE_STATIC
+#else
+#define MYASSERT_SITE_1 MYASSERT_SITE_DEAD
+#endif
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL)
+#define MYASSERT_SITE_2 MYASSERT_SITE_STATIC
+#else
+#define MYASSERT_SITE_2 MYASSERT_SITE_DEAD
+#endif
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_PARANOID)
+#define MYASSERT_SITE_3 MYASSERT_SITE_STATIC
+#else
+#define MYASSERT_SITE_3 MYASSERT_SITE_DEAD
+#endif
 
-// ==============================================
-// INT16_T ASSERTIONS
-// ==============================================
+// A failed check. Operands are kept as raw bytes and only formatted when
+// the failure is reported. Strings are referenced through text_a/text_b,
+// which a deferred report points at its own captured copies. A failed
+// array or memory check stores the first mismatching index in a, the
+// number of mismatches in b and the data around the first one in the
+// captures. A failed file check stores the offset in a, the line in b
+// and the sizes in count and count_b. A failed tolerance check stores
+// the first index and the mismatch count like an array check, its
+// worst pair in the captures and its errors in tolerance. Its count is
+// 0 for a scalar check. A failed latency check stores the measured and
+// allowed nanoseconds as doubles in a and b, the number of samples in
+// count and min, p50, p90, p99, p99.9 and max in latency.
+struct myassert_tolerance
+{
+    double abs;
+    double rel;
+    uint64_t ulps;
+    double max_error;
+    uint64_t max_ulps;
+    uint64_t worst;
+};
 
-#define ASSERT_EQ_INT16(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int16_t);                 \
-        TYPE_CHECK(b, int16_t);                 \
-        ASSERT_BASE(a, ==, b, int16_t, PRId16); \
-    } while (0)
+struct myassert_failure
+{
+    const struct myassert_site *site;
+    size_t size;
+    size_t count;
+    size_t count_b;
+    int error;
+    unsigned char a[8];
+    unsigned char b[8];
+    double epsilon;
+    struct myassert_tolerance tolerance;
+    double latency[6];
+    const char *text_a;
+    const char *text_b;
+    char capture_a[MYASSERT_EXPECT_CAPTURE];
+    char capture_b[MYASSERT_EXPECT_CAPTURE];
+};
 
-#define ASSERT_GE_INT16(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int16_t);                 \
-        TYPE_CHECK(b, int16_t);                 \
-        ASSERT_BASE(a, >=, b, int16_t, PRId16); \
-    } while (0)
+// Failure messages are formatted into a stack buffer and emitted with a
+// single write(2). Nothing below takes a lock or allocates, so a check may
+// fail inside a signal handler, an allocator or on many threads at once.
+struct myassert_buf
+{
+    char *data;
+    size_t len;
+    size_t cap;
+};
 
-#define ASSERT_GT_INT16(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int16_t);                \
-        TYPE_CHECK(b, int16_t);                \
-        ASSERT_BASE(a, >, b, int16_t, PRId16); \
-    } while (0)
+static inline void myassert_put(struct myassert_buf *buf, const char *s, size_t n)
+{
+    if (n > buf->cap - buf->len)
+    {
+        n = buf->cap - buf->len;
+    }
+    memcpy(buf->data + buf->len, s, n);
+    buf->len += n;
+}
 
-#define ASSERT_LE_INT16(a, b)                   \
+static inline void myassert_put_str(struct myassert_buf *buf, const char *s)
+{
+    if (s == NULL)
+    {
+        s = "(null)";
+    }
+    myassert_put(buf, s, strlen(s));
+}
+
+static inline void myassert_put_strn(struct myassert_buf *buf, const char *s, size_t len)
+{
+    if (s == NULL)
+    {
+        myassert_put_str(buf, s);
+        return;
+    }
+    size_t n = 0;
+    while (n < len && s[n] != '\0' && buf->len + n < buf->cap)
+    {
+        n++;
+    }
+    myassert_put(buf, s, n);
+}
+
+static inline void myassert_put_uint(struct myassert_buf *buf, uint64_t v, unsigned base)
+{
+    char digits[24];
+    size_t n = sizeof(digits);
+    do
+    {
+        digits[--n] = "0123456789abcdef"[v % base];
+        v /= base;
+    } while (v != 0);
+    myassert_put(buf, digits + n, sizeof(digits) - n);
+}
+
+static inline void myassert_put_hex(struct myassert_buf *buf, uint64_t v, size_t width)
+{
+    char digits[16];
+    for (size_t i = width; i-- > 0;)
+    {
+        digits[i] = "0123456789abcdef"[v & 0xf];
+        v >>= 4;
+    }
+    myassert_put(buf, digits, width);
+}
+
+static inline void myassert_put_int(struct myassert_buf *buf, int64_t v)
+{
+    if (v < 0)
+    {
+        myassert_put(buf, "-", 1);
+        myassert_put_uint(buf, -(uint64_t)v, 10);
+    }
+    else
+    {
+        myassert_put_uint(buf, (uint64_t)v, 10);
+    }
+}
+
+static inline void myassert_put_ptr(struct myassert_buf *buf, const void *p)
+{
+    if (p == NULL)
+    {
+        myassert_put_str(buf, "(nil)");
+        return;
+    }
+    myassert_put(buf, "0x", 2);
+    myassert_put_uint(buf, (uint64_t)(uintptr_t)p, 16);
+}
+
+// Same output as "%.*f" with at most 9 digits for magnitudes below 2^64.
+// Larger values are printed in exponent form.
+static inline void myassert_put_fixed(struct myassert_buf *buf, double d, int digits)
+{
+    if (d != d)
+    {
+        myassert_put_str(buf, "nan");
+        return;
+    }
+    if (signbit(d))
+    {
+        myassert_put(buf, "-", 1);
+        d = -d;
+    }
+    if (isinf(d))
+    {
+        myassert_put_str(buf, "inf");
+        return;
+    }
+
+    int exponent = 0;
+    bool scientific = d >= 18446744073709549568.0;
+    while (d >= 10.0 && scientific)
+    {
+        d /= 10.0;
+        exponent++;
+    }
+
+    uint64_t unit = 1;
+    for (int i = 0; i < digits; i++)
+    {
+        unit *= 10;
+    }
+    uint64_t whole = (uint64_t)d;
+    double scaled = (d - (double)whole) * (double)unit;
+    uint64_t part = (uint64_t)scaled;
+    double rest = scaled - (double)part;
+    if (rest > 0.5 || (rest == 0.5 && (part & 1) != 0))
+    {
+        part++;
+    }
+    if (part >= unit)
+    {
+        whole++;
+        part -= unit;
+    }
+    char fraction[10];
+    for (int i = digits - 1; i >= 0; i--)
+    {
+        fraction[i + 1] = (char)('0' + part % 10);
+        part /= 10;
+    }
+    fraction[0] = '.';
+    myassert_put_uint(buf, whole, 10);
+    myassert_put(buf, fraction, digits > 0 ? (size_t)digits + 1 : 0);
+    if (scientific)
+    {
+        myassert_put(buf, "e+", 2);
+        myassert_put_uint(buf, (uint64_t)exponent, 10);
+    }
+}
+
+// Same output as "%f" for magnitudes below 2^64.
+static inline void myassert_put_double(struct myassert_buf *buf, double d)
+{
+    myassert_put_fixed(buf, d, 6);
+}
+
+// 10 to the power n >= 0, by squaring, so formatting needs no libm.
+static inline long double myassert_pow10l(int n)
+{
+    long double result = 1.0L;
+    long double base = 10.0L;
+    while (n > 0)
+    {
+        if (n & 1)
+        {
+            result *= base;
+        }
+        base *= base;
+        n >>= 1;
+    }
+    return result;
+}
+
+// The decimal exponent of d > 0, or one less. It is derived from the
+// binary exponent: log10(2) is close to 78913 / 2^18.
+static inline int myassert_exponent10(double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    int binary = (int)((bits >> 52) & 0x7ff);
+    if (binary == 0)
+    {
+        // Subnormal: scale by 2^64 into the normal range first.
+        d *= 18446744073709551616.0;
+        memcpy(&bits, &d, sizeof(bits));
+        binary = (int)((bits >> 52) & 0x7ff) - 64;
+    }
+    long scaled = (long)(binary - 1023) * 78913;
+    return (int)(scaled >= 0 ? scaled / 262144 : -((-scaled + 262143) / 262144));
+}
+
+// Like "%.*e" with digits after the point, for errors and tolerances
+// that "%f" would round to zero. The last digit may be off by one.
+static inline void myassert_put_exp(struct myassert_buf *buf, double d, int digits)
+{
+    if (d != d)
+    {
+        myassert_put_str(buf, "nan");
+        return;
+    }
+    if (signbit(d))
+    {
+        myassert_put(buf, "-", 1);
+        d = -d;
+    }
+    if (isinf(d))
+    {
+        myassert_put_str(buf, "inf");
+        return;
+    }
+
+    uint64_t scale = 1;
+    for (int i = 0; i < digits; i++)
+    {
+        scale *= 10;
+    }
+    int exponent = 0;
+    uint64_t mantissa = 0;
+    if (d != 0.0)
+    {
+        // 17 significant digits need more precision than a double has.
+        exponent = myassert_exponent10(d);
+        long double m = exponent < -300 ? (long double)d * 1e300L * myassert_pow10l(-exponent - 300)
+                        : exponent < 0  ? (long double)d * myassert_pow10l(-exponent)
+                                        : (long double)d / myassert_pow10l(exponent);
+        if (m >= 10.0L)
+        {
+            m /= 10.0L;
+            exponent++;
+        }
+        mantissa = (uint64_t)(m * (long double)scale + 0.5L);
+        if (mantissa >= 10 * scale)
+        {
+            mantissa = (mantissa + 5) / 10;
+            exponent++;
+        }
+        else if (mantissa < scale)
+        {
+            mantissa = (uint64_t)(m * 10.0L * (long double)scale + 0.5L);
+            exponent--;
+        }
+    }
+
+    myassert_put_uint(buf, mantissa / scale, 10);
+    if (digits > 0)
+    {
+        char fraction[20];
+        uint64_t rest = mantissa % scale;
+        for (int i = digits; i > 0; i--)
+        {
+            fraction[i] = (char)('0' + rest % 10);
+            rest /= 10;
+        }
+        fraction[0] = '.';
+        myassert_put(buf, fraction, (size_t)digits + 1);
+    }
+    myassert_put(buf, exponent < 0 ? "e-" : "e+", 2);
+    if (exponent > -10 && exponent < 10)
+    {
+        myassert_put(buf, "0", 1);
+    }
+    myassert_put_uint(buf, (uint64_t)(exponent < 0 ? -exponent : exponent), 10);
+}
+
+// Text written to a file descriptor from a buffer of its own, for output
+// that a failed assertion may still have to complete: it takes no locks
+// and never allocates. Without a buffer each piece is written at once.
+// The first error is kept.
+struct myassert_out
+{
+    int fd;
+    char *data;
+    size_t len;
+    size_t cap;
+    int error;
+};
+
+// errno is preserved so a report from a signal handler does not disturb
+// the interrupted code.
+static inline void myassert_out_write(struct myassert_out *out, const char *data, size_t len)
+{
+#if MYASSERT_HAVE_POSIX
+    int saved = errno;
+    while (len > 0 && out->error == 0)
+    {
+        ssize_t n = write(out->fd, data, len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            out->error = n < 0 ? errno : EIO;
+            break;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    errno = saved;
+#else
+    FILE *stream = out->fd == 1 ? stdout : stderr;
+    fwrite(data, 1, len, stream);
+    fflush(stream);
+#endif
+}
+
+static inline void myassert_out_flush(struct myassert_out *out)
+{
+    myassert_out_write(out, out->data, out->len);
+    out->len = 0;
+}
+
+static inline void myassert_out_put(struct myassert_out *out, const char *s, size_t n)
+{
+    if (n > out->cap - out->len)
+    {
+        myassert_out_flush(out);
+        if (n > out->cap)
+        {
+            myassert_out_write(out, s, n);
+            return;
+        }
+    }
+    if (n > 0)
+    {
+        memcpy(out->data + out->len, s, n);
+        out->len += n;
+    }
+}
+
+static inline void myassert_out_str(struct myassert_out *out, const char *s)
+{
+    myassert_out_put(out, s, strlen(s));
+}
+
+static inline void myassert_out_buf(struct myassert_out *out, const struct myassert_buf *buf)
+{
+    myassert_out_put(out, buf->data, buf->len);
+}
+
+static inline void myassert_out_char(struct myassert_out *out, char c)
+{
+    myassert_out_put(out, &c, 1);
+}
+
+static inline void myassert_out_uint(struct myassert_out *out, uint64_t v)
+{
+    char data[24];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+    myassert_put_uint(&buf, v, 10);
+    myassert_out_buf(out, &buf);
+}
+
+static inline void myassert_out_int(struct myassert_out *out, int64_t v)
+{
+    char data[24];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+    myassert_put_int(&buf, v);
+    myassert_out_buf(out, &buf);
+}
+
+static inline void myassert_out_fixed(struct myassert_out *out, double d, int digits)
+{
+    char data[48];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+    myassert_put_fixed(&buf, d, digits);
+    myassert_out_buf(out, &buf);
+}
+
+// Emits a formatted message, marking it when it did not fit.
+static inline void myassert_write(int fd, struct myassert_buf *buf)
+{
+    if (buf->len == buf->cap)
+    {
+        memcpy(buf->data + buf->cap - 4, "...", 3);
+        buf->len = buf->cap - 1;
+    }
+    buf->data[buf->len++] = '\n';
+
+    struct myassert_out out = {fd, NULL, 0, 0, 0};
+    myassert_out_write(&out, buf->data, buf->len);
+}
+
+// Appends a captured operand according to the printf conversion of its
+// site, widening it from its original size.
+static inline void myassert_put_value(struct myassert_buf *buf, const char *conv,
+                                      const unsigned char *raw, size_t size)
+{
+    char spec = conv[strlen(conv) - 1];
+    if (spec == 'p')
+    {
+        const void *p;
+        memcpy(&p, raw, sizeof(p));
+        myassert_put_ptr(buf, p);
+    }
+    else if (spec == 'f' || spec == 'g' || spec == 'e')
+    {
+        double d;
+        if (size == sizeof(float))
+        {
+            float f;
+            memcpy(&f, raw, sizeof(f));
+            d = f;
+        }
+        else
+        {
+            memcpy(&d, raw, sizeof(d));
+        }
+        myassert_put_double(buf, d);
+    }
+    else if (spec == 'd' || spec == 'i' || spec == 'c')
+    {
+        int64_t v;
+        if (size == 1)
+        {
+            int8_t x;
+            memcpy(&x, raw, 1);
+            v = x;
+        }
+        else if (size == 2)
+        {
+            int16_t x;
+            memcpy(&x, raw, 2);
+            v = x;
+        }
+        else if (size == 4)
+        {
+            int32_t x;
+            memcpy(&x, raw, 4);
+            v = x;
+        }
+        else
+        {
+            memcpy(&v, raw, sizeof(v));
+        }
+        if (spec == 'c')
+        {
+            char c = (char)v;
+            myassert_put(buf, &c, 1);
+        }
+        else
+        {
+            myassert_put_int(buf, v);
+        }
+    }
+    else
+    {
+        uint64_t v = 0;
+        if (size == 1)
+        {
+            uint8_t x;
+            memcpy(&x, raw, 1);
+            v = x;
+        }
+        else if (size == 2)
+        {
+            uint16_t x;
+            memcpy(&x, raw, 2);
+            v = x;
+        }
+        else if (size == 4)
+        {
+            uint32_t x;
+            memcpy(&x, raw, 4);
+            v = x;
+        }
+        else
+        {
+            memcpy(&v, raw, sizeof(v));
+        }
+        myassert_put_uint(buf, v, spec == 'x' ? 16 : 10);
+    }
+}
+
+#define MYASSERT_ARRAY_WINDOW 5
+
+// Number of elements captured around the first mismatch of an array
+// check, starting at *start.
+static inline size_t myassert_array_window(size_t first, size_t count, size_t size,
+                                           size_t *start)
+{
+    *start = first >= MYASSERT_ARRAY_WINDOW / 2 ? first - MYASSERT_ARRAY_WINDOW / 2 : 0;
+    size_t window = count - *start;
+    if (window > MYASSERT_ARRAY_WINDOW)
+    {
+        window = MYASSERT_ARRAY_WINDOW;
+    }
+    if (window > MYASSERT_EXPECT_CAPTURE / size)
+    {
+        window = MYASSERT_EXPECT_CAPTURE / size;
+    }
+    return window;
+}
+
+static inline void myassert_put_array(struct myassert_buf *buf,
+                                      const struct myassert_failure *failure)
+{
+    const struct myassert_site *site = failure->site;
+    uint64_t first;
+    uint64_t mismatches;
+    memcpy(&first, failure->a, sizeof(first));
+    memcpy(&mismatches, failure->b, sizeof(mismatches));
+
+    size_t start;
+    size_t window = myassert_array_window(first, failure->count, failure->size, &start);
+    myassert_put_uint(buf, mismatches, 10);
+    myassert_put_str(buf, " of ");
+    myassert_put_uint(buf, failure->count, 10);
+    myassert_put_str(buf, " elements differ, first at [");
+    myassert_put_uint(buf, first, 10);
+    myassert_put_str(buf, "]; [");
+    myassert_put_uint(buf, start, 10);
+    myassert_put_str(buf, "..");
+    myassert_put_uint(buf, start + window - 1, 10);
+    myassert_put_str(buf, "]:");
+    for (size_t i = 0; i < window; i++)
+    {
+        myassert_put_str(buf, " ");
+        myassert_put_value(buf, site->conv,
+                           (const unsigned char *)failure->capture_a + i * failure->size,
+                           failure->size);
+    }
+    myassert_put_str(buf, " vs");
+    for (size_t i = 0; i < window; i++)
+    {
+        myassert_put_str(buf, " ");
+        myassert_put_value(buf, site->conv,
+                           (const unsigned char *)failure->capture_b + i * failure->size,
+                           failure->size);
+    }
+}
+
+static inline void myassert_put_tolerance(struct myassert_buf *buf,
+                                          const struct myassert_failure *failure)
+{
+    const struct myassert_tolerance *tolerance = &failure->tolerance;
+    int digits = failure->size == sizeof(float) ? 8 : 16;
+    double a;
+    double b;
+    if (failure->size == sizeof(float))
+    {
+        float fa;
+        float fb;
+        memcpy(&fa, failure->capture_a, sizeof(fa));
+        memcpy(&fb, failure->capture_b, sizeof(fb));
+        a = fa;
+        b = fb;
+    }
+    else
+    {
+        memcpy(&a, failure->capture_a, sizeof(a));
+        memcpy(&b, failure->capture_b, sizeof(b));
+    }
+
+    if (failure->count != 0)
+    {
+        uint64_t first;
+        uint64_t mismatches;
+        memcpy(&first, failure->a, sizeof(first));
+        memcpy(&mismatches, failure->b, sizeof(mismatches));
+        myassert_put_uint(buf, mismatches, 10);
+        myassert_put_str(buf, " of ");
+        myassert_put_uint(buf, failure->count, 10);
+        myassert_put_str(buf, " elements out of tolerance, first at [");
+        myassert_put_uint(buf, first, 10);
+        myassert_put_str(buf, "], worst at [");
+        myassert_put_uint(buf, tolerance->worst, 10);
+        myassert_put_str(buf, "]: ");
+    }
+    myassert_put_exp(buf, a, digits);
+    myassert_put_str(buf, " vs ");
+    myassert_put_exp(buf, b, digits);
+    myassert_put_str(buf, failure->count != 0 ? "; max error: " : ", error: ");
+    myassert_put_exp(buf, tolerance->max_error, 6);
+    myassert_put_str(buf, " (");
+    if (tolerance->max_ulps == UINT64_MAX)
+    {
+        myassert_put_str(buf, "inf");
+    }
+    else
+    {
+        myassert_put_uint(buf, tolerance->max_ulps, 10);
+    }
+    myassert_put_str(buf, " ulps), tolerance:");
+    const char *separator = " ";
+    if (tolerance->abs != 0.0)
+    {
+        myassert_put_str(buf, separator);
+        myassert_put_str(buf, "abs ");
+        myassert_put_exp(buf, tolerance->abs, 6);
+        separator = ", ";
+    }
+    if (tolerance->rel != 0.0)
+    {
+        myassert_put_str(buf, separator);
+        myassert_put_str(buf, "rel ");
+        myassert_put_exp(buf, tolerance->rel, 6);
+        separator = ", ";
+    }
+    if (tolerance->ulps != 0)
+    {
+        myassert_put_str(buf, separator);
+        myassert_put_uint(buf, tolerance->ulps, 10);
+        myassert_put_str(buf, " ulps");
+        separator = ", ";
+    }
+    if (separator[0] == ' ')
+    {
+        myassert_put_str(buf, " 0");
+    }
+}
+
+// Nanoseconds, with one decimal below 10.
+static inline void myassert_put_ns(struct myassert_buf *buf, double ns)
+{
+    uint64_t tenths = (uint64_t)(ns * 10.0 + 0.5);
+    myassert_put_uint(buf, tenths < 100 ? tenths / 10 : (tenths + 5) / 10, 10);
+    if (tenths < 100)
+    {
+        myassert_put_str(buf, ".");
+        myassert_put_uint(buf, tenths % 10, 10);
+    }
+}
+
+static inline void myassert_put_latency(struct myassert_buf *buf,
+                                        const struct myassert_failure *failure)
+{
+    static const char *const names[] = {"min", "p50", "p90", "p99", "p99.9", "max"};
+    double a;
+    memcpy(&a, failure->a, sizeof(a));
+    myassert_put_ns(buf, a);
+    myassert_put_str(buf, " ns over ");
+    myassert_put_uint(buf, failure->count, 10);
+    myassert_put_str(buf, failure->count == 1 ? " run;" : " runs;");
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        myassert_put_str(buf, i == 0 ? " " : ", ");
+        myassert_put_str(buf, names[i]);
+        myassert_put_str(buf, " ");
+        myassert_put_ns(buf, failure->latency[i]);
+    }
+    myassert_put_str(buf, " ns");
+}
+
+#define MYASSERT_HEXDUMP_ROW 16
+
+// Number of bytes captured around the first difference of a memory check,
+// starting at *start: the row holding it and the rows next to it.
+static inline size_t myassert_memory_window(size_t first, size_t len, size_t *start)
+{
+    size_t rows = MYASSERT_EXPECT_CAPTURE / MYASSERT_HEXDUMP_ROW;
+    size_t before = rows > 0 ? (rows - 1) / 2 * MYASSERT_HEXDUMP_ROW : 0;
+    *start = first / MYASSERT_HEXDUMP_ROW * MYASSERT_HEXDUMP_ROW;
+    *start -= *start < before ? *start : before;
+    size_t window = len - *start;
+    if (window > rows * MYASSERT_HEXDUMP_ROW)
+    {
+        window = rows * MYASSERT_HEXDUMP_ROW;
+    }
+    return window;
+}
+
+static inline void myassert_trim_line(struct myassert_buf *buf)
+{
+    while (buf->len > 0 && buf->data[buf->len - 1] == ' ')
+    {
+        buf->len--;
+    }
+}
+
+static inline void myassert_put_hexrow(struct myassert_buf *buf, const unsigned char *row,
+                                       const unsigned char *other, size_t n, bool marks)
+{
+    for (size_t i = 0; i < MYASSERT_HEXDUMP_ROW; i++)
+    {
+        myassert_put_str(buf, i == 0 ? "" : " ");
+        if (i >= n)
+        {
+            myassert_put_str(buf, "  ");
+        }
+        else if (marks)
+        {
+            myassert_put_str(buf, row[i] != other[i] ? "^^" : "  ");
+        }
+        else
+        {
+            myassert_put_hex(buf, row[i], 2);
+        }
+    }
+}
+
+// Prints the captured bytes of both buffers side by side and marks the
+// ones that differ on the line below their row.
+static inline void myassert_put_hexdump(struct myassert_buf *buf,
+                                        const struct myassert_failure *failure)
+{
+    uint64_t first;
+    memcpy(&first, failure->a, sizeof(first));
+    size_t len = failure->count < failure->count_b ? failure->count : failure->count_b;
+    size_t start;
+    size_t window = myassert_memory_window(first, len, &start);
+    const unsigned char *a = (const unsigned char *)failure->capture_a;
+    const unsigned char *b = (const unsigned char *)failure->capture_b;
+
+    for (size_t row = 0; row < window; row += MYASSERT_HEXDUMP_ROW)
+    {
+        size_t n = window - row < MYASSERT_HEXDUMP_ROW ? window - row : MYASSERT_HEXDUMP_ROW;
+        myassert_trim_line(buf);
+        myassert_put_str(buf, "\n  ");
+        myassert_put_hex(buf, start + row, 8);
+        myassert_put_str(buf, "  ");
+        myassert_put_hexrow(buf, a + row, b + row, n, false);
+        myassert_put_str(buf, "   ");
+        myassert_put_hexrow(buf, b + row, a + row, n, false);
+        if (memcmp(a + row, b + row, n) != 0)
+        {
+            myassert_trim_line(buf);
+            myassert_put_str(buf, "\n            ");
+            myassert_put_hexrow(buf, a + row, b + row, n, true);
+            myassert_put_str(buf, "   ");
+            myassert_put_hexrow(buf, b + row, a + row, n, true);
+        }
+    }
+    myassert_trim_line(buf);
+}
+
+static inline void myassert_put_file(struct myassert_buf *buf,
+                                     const struct myassert_failure *failure)
+{
+    bool snapshot = failure->site->kind == MYASSERT_SITE_SNAPSHOT;
+    if (failure->error != 0)
+    {
+        myassert_put_str(buf, snapshot ? "no snapshot " : "cannot read ");
+        myassert_put_str(buf, failure->capture_a);
+        myassert_put_str(buf, snapshot ? " in " : ": ");
+        myassert_put_str(buf, failure->capture_b);
+        return;
+    }
+
+    uint64_t first;
+    uint64_t line;
+    memcpy(&first, failure->a, sizeof(first));
+    memcpy(&line, failure->b, sizeof(line));
+    myassert_put_str(buf, snapshot ? "differs from the snapshot at offset "
+                                   : "files differ at offset ");
+    myassert_put_uint(buf, first, 10);
+    if (line > 0)
+    {
+        myassert_put_str(buf, ", line ");
+        myassert_put_uint(buf, line, 10);
+        myassert_put_str(buf, ": \"");
+        myassert_put_str(buf, failure->capture_a);
+        myassert_put_str(buf, "\" vs \"");
+        myassert_put_str(buf, failure->capture_b);
+        myassert_put_str(buf, "\"");
+    }
+    if (failure->count != failure->count_b)
+    {
+        myassert_put_str(buf, "; sizes ");
+        myassert_put_uint(buf, failure->count, 10);
+        myassert_put_str(buf, " vs ");
+        myassert_put_uint(buf, failure->count_b, 10);
+    }
+}
+
+// The checked expression as written, without the macro around it.
+static inline void myassert_put_expression(struct myassert_buf *buf,
+                                           const struct myassert_site *site)
+{
+    myassert_put_str(buf, site->a);
+    if (site->kind != MYASSERT_SITE_EXPR && site->kind != MYASSERT_SITE_OK)
+    {
+        myassert_put_str(buf, " ");
+        myassert_put_str(buf, site->op);
+        myassert_put_str(buf, " ");
+        myassert_put_str(buf, site->b);
+    }
+}
+
+// The evaluated operands of a failed check. Nothing for a plain
+// expression.
+static inline void myassert_put_operands(struct myassert_buf *buf,
+                                         const struct myassert_failure *failure)
+{
+    const struct myassert_site *site = failure->site;
+    switch (site->kind)
+    {
+    case MYASSERT_SITE_EXPR:
+        break;
+    case MYASSERT_SITE_OK:
+        myassert_put_str(buf, "error: ");
+        myassert_put_value(buf, PRId64, failure->a, failure->size);
+        break;
+    case MYASSERT_SITE_TEXT:
+        if (site->conv[0] == 'p')
+        {
+            myassert_put_ptr(buf, failure->text_a);
+            myassert_put_str(buf, " ");
+            myassert_put_str(buf, site->op);
+            myassert_put_str(buf, " ");
+            myassert_put_ptr(buf, failure->text_b);
+        }
+        else
+        {
+            myassert_put_strn(buf, failure->text_a, failure->size);
+            myassert_put_str(buf, " ");
+            myassert_put_str(buf, site->op);
+            myassert_put_str(buf, " ");
+            myassert_put_strn(buf, failure->text_b, failure->size);
+        }
+        break;
+    case MYASSERT_SITE_EPSILON:
+    {
+        double da;
+        double db;
+        memcpy(&da, failure->a, sizeof(da));
+        memcpy(&db, failure->b, sizeof(db));
+        myassert_put_double(buf, da);
+        myassert_put_str(buf, " ");
+        myassert_put_str(buf, site->op);
+        myassert_put_str(buf, " ");
+        myassert_put_double(buf, db);
+        myassert_put_str(buf, ", diff: ");
+        myassert_put_double(buf, fabs(da - db));
+        myassert_put_str(buf, site->op[0] == '=' ? " > " : " <= ");
+        myassert_put_double(buf, failure->epsilon);
+        break;
+    }
+    case MYASSERT_SITE_ARRAY:
+        myassert_put_array(buf, failure);
+        break;
+    case MYASSERT_SITE_TOLERANCE:
+        myassert_put_tolerance(buf, failure);
+        break;
+    case MYASSERT_SITE_LATENCY:
+        myassert_put_latency(buf, failure);
+        break;
+    case MYASSERT_SITE_FILE:
+    case MYASSERT_SITE_SNAPSHOT:
+        myassert_put_file(buf, failure);
+        break;
+    case MYASSERT_SITE_MEMORY:
+    {
+        uint64_t first;
+        uint64_t mismatches;
+        memcpy(&first, failure->a, sizeof(first));
+        memcpy(&mismatches, failure->b, sizeof(mismatches));
+        myassert_put_uint(buf, mismatches, 10);
+        myassert_put_str(buf, " of ");
+        myassert_put_uint(buf, failure->count, 10);
+        myassert_put_str(buf, " bytes differ, first at offset ");
+        myassert_put_uint(buf, first, 10);
+        break;
+    }
+    default:
+        myassert_put_value(buf, site->conv, failure->a, failure->size);
+        myassert_put_str(buf, " ");
+        myassert_put_str(buf, site->op);
+        myassert_put_str(buf, " ");
+        myassert_put_value(buf, site->conv, failure->b, failure->size);
+        break;
+    }
+}
+
+static inline void myassert_format_failure(struct myassert_buf *buf, const char *what,
+                                           const struct myassert_failure *failure)
+{
+    const struct myassert_site *site = failure->site;
+
+    myassert_put_str(buf, what);
+    myassert_put_str(buf, " failed in ");
+    myassert_put_str(buf, site->file);
+    myassert_put_str(buf, " on line ");
+    myassert_put_int(buf, site->line);
+    myassert_put_str(buf, ": ");
+    if (site->kind == MYASSERT_SITE_EXPR)
+    {
+        myassert_put_str(buf, site->a);
+        return;
+    }
+    if (site->kind == MYASSERT_SITE_OK)
+    {
+        myassert_put_str(buf, "`");
+        myassert_put_str(buf, site->a);
+        myassert_put_str(buf, "` okay (");
+        myassert_put_operands(buf, failure);
+        myassert_put_str(buf, ")");
+        return;
+    }
+
+    myassert_put_str(buf, "`");
+    myassert_put_expression(buf, site);
+    myassert_put_str(buf, "` (");
+    myassert_put_operands(buf, failure);
+    myassert_put_str(buf, ")");
+    uint64_t line;
+    memcpy(&line, failure->b, sizeof(line));
+    if (site->kind == MYASSERT_SITE_MEMORY ||
+        ((site->kind == MYASSERT_SITE_FILE || site->kind == MYASSERT_SITE_SNAPSHOT) &&
+         failure->error == 0 && line == 0))
+    {
+        myassert_put_hexdump(buf, failure);
+    }
+}
+
+static inline void myassert_report_failure(int fd, const char *what,
+                                           const struct myassert_failure *failure)
+{
+    char data[MYASSERT_MESSAGE_SIZE];
+    struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+    myassert_format_failure(&buf, what, failure);
+    myassert_write(fd, &buf);
+}
+
+static inline void myassert_capture_text(char *dst, const char *src, size_t len)
+{
+    size_t n = 0;
+    while (n < len && n < MYASSERT_EXPECT_CAPTURE - 1 && src[n] != '\0')
+    {
+        dst[n] = src[n];
+        n++;
+    }
+    dst[n] = '\0';
+}
+
+// =============================================================
+// FAILURE RING
+// =============================================================
+
+// With MYASSERT_FAILURE_RING set to a slot count, every failed assertion
+// and expectation from any thread is also copied into a shared ring. A
+// slot is claimed with an atomic increment and published through its
+// sequence number, so recording never blocks. The ring is flushed before
+// a failed assertion aborts, which shows what other threads hit just
+// before the crash.
+#if MYASSERT_FAILURE_RING > 0
+
+struct myassert_ring_slot
+{
+    uint64_t seq;
+    const char *what;
+    struct myassert_failure failure;
+};
+
+MYASSERT_SHARED struct myassert_ring_slot myassert_ring[MYASSERT_FAILURE_RING];
+MYASSERT_SHARED uint64_t myassert_ring_head;
+
+// Points the text operands of a copied record at the copy's own storage.
+static inline void myassert_ring_rebase(struct myassert_failure *failure)
+{
+    const struct myassert_site *site = failure->site;
+    if (site->kind == MYASSERT_SITE_TEXT && site->conv[0] != 'p')
+    {
+        failure->text_a = failure->capture_a;
+        failure->text_b = failure->capture_b;
+    }
+}
+
+static inline void myassert_ring_push(const char *what, const struct myassert_failure *failure)
+{
+    uint64_t index = __atomic_fetch_add(&myassert_ring_head, 1, __ATOMIC_RELAXED);
+    struct myassert_ring_slot *slot = &myassert_ring[index % MYASSERT_FAILURE_RING];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->what = what;
+    slot->failure = *failure;
+    const struct myassert_site *site = failure->site;
+    if (site->kind == MYASSERT_SITE_TEXT && site->conv[0] != 'p')
+    {
+        myassert_capture_text(slot->failure.capture_a, failure->text_a, failure->size);
+        myassert_capture_text(slot->failure.capture_b, failure->text_b, failure->size);
+    }
+    __atomic_store_n(&slot->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+// Writes the records still held by the ring, oldest first. This is
+// async-signal-safe, so it may also be called from a signal handler.
+static inline void myassert_flush_failures(int fd)
+{
+    uint64_t head = __atomic_load_n(&myassert_ring_head, __ATOMIC_ACQUIRE);
+    uint64_t first = head > MYASSERT_FAILURE_RING ? head - MYASSERT_FAILURE_RING : 0;
+    char data[64];
+    struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+
+    myassert_put_str(&buf, "Recent failures (");
+    myassert_put_uint(&buf, head - first, 10);
+    myassert_put_str(&buf, " of ");
+    myassert_put_uint(&buf, head, 10);
+    myassert_put_str(&buf, "):");
+    myassert_write(fd, &buf);
+
+    for (uint64_t i = first; i < head; i++)
+    {
+        struct myassert_ring_slot *slot = &myassert_ring[i % MYASSERT_FAILURE_RING];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq != i + 1)
+        {
+            continue;
+        }
+        struct myassert_ring_slot copy;
+        memcpy(&copy, slot, sizeof(copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+        {
+            continue;
+        }
+        myassert_ring_rebase(&copy.failure);
+        myassert_report_failure(fd, copy.what, &copy.failure);
+    }
+}
+
+#else
+
+#define myassert_ring_push(what, failure) ((void)0)
+
+#endif
+
+// =============================================================
+// TEST DETAILS
+// =============================================================
+
+#ifndef MYASSERT_DETAIL_SIZE
+#define MYASSERT_DETAIL_SIZE 256
+#endif
+
+// What a reporter shows about a test beyond its status: the first check
+// that failed in it, or otherwise a message such as the reason given to
+// RETURN_SKIP. Text operands are copied into the failure's captures.
+struct myassert_detail
+{
+    const char *what;
+    struct myassert_failure failure;
+    char message[MYASSERT_DETAIL_SIZE];
+};
+
+// Where the test running on this thread records its detail, or NULL when
+// no reporter asked for one.
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_detail *myassert_current_detail;
+
+static inline bool myassert_detail_empty(const struct myassert_detail *detail)
+{
+    return detail->what == NULL && detail->message[0] == '\0';
+}
+
+static inline void myassert_failure_copy(struct myassert_failure *dst,
+                                         const struct myassert_failure *src)
+{
+    *dst = *src;
+    if (src->site->kind == MYASSERT_SITE_TEXT && src->site->conv[0] != 'p')
+    {
+        if (src->text_a != NULL)
+        {
+            myassert_capture_text(dst->capture_a, src->text_a, src->size);
+            dst->text_a = dst->capture_a;
+        }
+        if (src->text_b != NULL)
+        {
+            myassert_capture_text(dst->capture_b, src->text_b, src->size);
+            dst->text_b = dst->capture_b;
+        }
+    }
+}
+
+static inline void myassert_detail_record(const char *what, const struct myassert_failure *failure)
+{
+    struct myassert_detail *detail = myassert_current_detail;
+    if (detail != NULL && myassert_detail_empty(detail))
+    {
+        myassert_failure_copy(&detail->failure, failure);
+        detail->what = what;
+    }
+}
+
+static inline void myassert_detail_note(struct myassert_detail *detail, const char *text,
+                                        size_t len)
+{
+    if (detail != NULL && myassert_detail_empty(detail))
+    {
+        if (len >= sizeof(detail->message))
+        {
+            len = sizeof(detail->message) - 1;
+        }
+        memcpy(detail->message, text, len);
+        detail->message[len] = '\0';
+    }
+}
+
+static inline void myassert_skip(const char *explanation)
+{
+    fprintf(stderr, "%s\n", explanation);
+    fflush(stderr);
+    myassert_detail_note(myassert_current_detail, explanation, strlen(explanation));
+}
+
+// =============================================================
+// SITE REGISTRY
+// =============================================================
+
+#if MYASSERT_SITE_REGISTRY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+extern const struct myassert_site *const __start_myassert_sites[] MYASSERT_ATTR((weak));
+extern const struct myassert_site *const __stop_myassert_sites[] MYASSERT_ATTR((weak));
+#ifdef __cplusplus
+}
+#endif
+
+struct myassert_site_total
+{
+    const struct myassert_site *site;
+    uint64_t hits;
+};
+
+static inline int myassert_compare_site_location(const void *lhs, const void *rhs)
+{
+    const struct myassert_site *a = *(const struct myassert_site *const *)lhs;
+    const struct myassert_site *b = *(const struct myassert_site *const *)rhs;
+    int order = strcmp(a->file, b->file);
+    if (order == 0)
+    {
+        order = (a->line > b->line) - (a->line < b->line);
+    }
+    if (order == 0)
+    {
+        order = strcmp(a->macro, b->macro);
+    }
+    if (order == 0)
+    {
+        order = strcmp(a->a, b->a);
+    }
+    if (order == 0)
+    {
+        order = strcmp(a->b, b->b);
+    }
+    return order;
+}
+
+static inline int myassert_compare_site_hits(const void *lhs, const void *rhs)
+{
+    const struct myassert_site_total *a = (const struct myassert_site_total *)lhs;
+    const struct myassert_site_total *b = (const struct myassert_site_total *)rhs;
+    return (a->hits < b->hits) - (a->hits > b->hits);
+}
+
+static inline void myassert_print_site(const struct myassert_site_total *total)
+{
+    const struct myassert_site *site = total->site;
+    if (MYASSERT_COUNT_SITES)
+    {
+        printf("  %12" PRIu64 "  ", total->hits);
+    }
+    else
+    {
+        printf("  ");
+    }
+    printf("%s:%d  %s  ", site->file, site->line, site->macro);
+    if (site->kind == MYASSERT_SITE_EXPR || site->kind == MYASSERT_SITE_OK)
+    {
+        printf("%s\n", site->a);
+    }
+    else
+    {
+        printf("%s %s %s\n", site->a, site->op, site->b);
+    }
+}
+
+// Prints every registered check, the most frequently executed first,
+// followed by the sites that never ran. A header included by several
+// translation units registers its checks once per unit; those copies are
+// merged by file, line and expression.
+static inline void myassert_dump_sites(void)
+{
+#if MYASSERT_COUNT_SITES == 2
+    myassert_site_flush(myassert_site_pending_list);
+#endif
+    size_t count = (size_t)(__stop_myassert_sites - __start_myassert_sites);
+    const struct myassert_site **sites =
+        (const struct myassert_site **)malloc((count + 1) * sizeof(*sites));
+    struct myassert_site_total *totals =
+        (struct myassert_site_total *)malloc((count + 1) * sizeof(*totals));
+    if (sites == NULL || totals == NULL)
+    {
+        free(sites);
+        free(totals);
+        return;
+    }
+
+    memcpy(sites, __start_myassert_sites, count * sizeof(*sites));
+    qsort(sites, count, sizeof(*sites), myassert_compare_site_location);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (unique == 0 || myassert_compare_site_location(&sites[i], &totals[unique - 1].site) != 0)
+        {
+            totals[unique].site = sites[i];
+            totals[unique].hits = 0;
+            unique++;
+        }
+        totals[unique - 1].hits += __atomic_load_n(&sites[i]->hits, __ATOMIC_RELAXED);
+    }
+
+    if (!MYASSERT_COUNT_SITES)
+    {
+        printf("%zu assertion sites (define MYASSERT_COUNT_SITES to count hits):\n", unique);
+        for (size_t i = 0; i < unique; i++)
+        {
+            myassert_print_site(&totals[i]);
+        }
+    }
+    else
+    {
+        qsort(totals, unique, sizeof(*totals), myassert_compare_site_hits);
+        size_t ran = 0;
+        while (ran < unique && totals[ran].hits > 0)
+        {
+            ran++;
+        }
+        printf("%zu assertion sites, %zu ran:\n", unique, ran);
+        for (size_t i = 0; i < ran; i++)
+        {
+            myassert_print_site(&totals[i]);
+        }
+        if (ran < unique)
+        {
+            qsort(totals + ran, unique - ran, sizeof(*totals), myassert_compare_site_location);
+            printf("%zu assertion sites never ran:\n", unique - ran);
+            for (size_t i = ran; i < unique; i++)
+            {
+                myassert_print_site(&totals[i]);
+            }
+        }
+    }
+    fflush(stdout);
+    free(sites);
+    free(totals);
+}
+
+#else
+
+static inline void myassert_dump_sites(void)
+{
+    printf("The assertion site registry is not enabled for this target\n");
+}
+
+#endif
+
+// =============================================================
+// BYTE COMPARISON
+// =============================================================
+
+enum myassert_simd
+{
+    MYASSERT_SIMD_SCALAR,
+    MYASSERT_SIMD_SSE2,
+    MYASSERT_SIMD_AVX2
+};
+
+// The kernels in use, chosen on first use. Storing a lower value forces
+// narrower kernels, which tests/simd.c does to compare them.
+MYASSERT_SHARED int myassert_simd_level = -1;
+
+// The widest kernels that were compiled in and that the CPU can run.
+// MYASSERT_SIMD=scalar or MYASSERT_SIMD=sse2 caps them.
+static inline int myassert_simd(void)
+{
+    int simd = __atomic_load_n(&myassert_simd_level, __ATOMIC_RELAXED);
+    if (MYASSERT_UNLIKELY(simd < 0))
+    {
+        simd = MYASSERT_HAVE_X86_SIMD ? MYASSERT_SIMD_SSE2 : MYASSERT_SIMD_SCALAR;
+#if MYASSERT_HAVE_X86_SIMD && MYASSERT_AVX2
+        if (__builtin_cpu_supports("avx2"))
+        {
+            simd = MYASSERT_SIMD_AVX2;
+        }
+#endif
+        const char *env = getenv("MYASSERT_SIMD");
+        if (env != NULL && strcmp(env, "scalar") == 0)
+        {
+            simd = MYASSERT_SIMD_SCALAR;
+        }
+        else if (env != NULL && strcmp(env, "sse2") == 0 && simd > MYASSERT_SIMD_SSE2)
+        {
+            simd = MYASSERT_SIMD_SSE2;
+        }
+        __atomic_store_n(&myassert_simd_level, simd, __ATOMIC_RELAXED);
+    }
+    return simd;
+}
+
+// Equality is bytewise, so the same kernels serve memory and array checks
+// of every element size: the ones myassert_simd() picks on x86-64, and
+// eight bytes at a time elsewhere. The kernels walk b with a
+// stride of 0 or 1, so ASSERT_ALL_* compare against a block filled with
+// the expected value without a branch in the loop.
+
+#define MYASSERT_ARRAY_PATTERN 128
+
+// Offsets into b are i * stride, or i % 32 for a pattern. Every offset
+// is a multiple of the element size, which the pattern repeats with.
+static inline size_t myassert_mismatch_scalar(const unsigned char *a, const unsigned char *b,
+                                              size_t from, size_t len, size_t stride)
+{
+    size_t i = from;
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t x;
+        uint64_t y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + (stride ? i : i % 32), sizeof(y));
+        if (x != y)
+        {
+            break;
+        }
+    }
+    for (; i < len; i++)
+    {
+        if (a[i] != b[stride ? i : i % 32])
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+#if MYASSERT_HAVE_X86_SIMD && MYASSERT_AVX2
+
+MYASSERT_ATTR((target("avx2")))
+static inline size_t myassert_mismatch_avx2(const unsigned char *a, const unsigned char *b,
+                                            size_t from, size_t len, size_t stride)
+{
+    size_t i = from;
+    for (; i + 128 <= len; i += 128)
+    {
+        const __m256i *pa = (const __m256i *)(a + i);
+        const __m256i *pb = (const __m256i *)(b + i * stride);
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pa), _mm256_loadu_si256(pb));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1));
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pa + 2), _mm256_loadu_si256(pb + 2));
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pa + 3), _mm256_loadu_si256(pb + 3));
+        __m256i equal = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+        if (MYASSERT_UNLIKELY((uint32_t)_mm256_movemask_epi8(equal) != UINT32_MAX))
+        {
+            break;
+        }
+    }
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i * stride));
+        uint32_t equal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (equal != UINT32_MAX)
+        {
+            return i + (size_t)__builtin_ctz(~equal);
+        }
+    }
+    return myassert_mismatch_scalar(a, b, i, len, stride);
+}
+
+#endif
+
+#if MYASSERT_HAVE_X86_SIMD
+
+static inline size_t myassert_mismatch_sse2(const unsigned char *a, const unsigned char *b,
+                                            size_t from, size_t len, size_t stride)
+{
+    size_t i = from;
+    for (; i + 64 <= len; i += 64)
+    {
+        const __m128i *pa = (const __m128i *)(a + i);
+        const __m128i *pb = (const __m128i *)(b + i * stride);
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128(pa), _mm_loadu_si128(pb));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3));
+        __m128i equal = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (MYASSERT_UNLIKELY(_mm_movemask_epi8(equal) != 0xffff))
+        {
+            break;
+        }
+    }
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i * stride));
+        unsigned equal = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+        if (equal != 0xffff)
+        {
+            return i + (size_t)__builtin_ctz(~equal);
+        }
+    }
+    return myassert_mismatch_scalar(a, b, i, len, stride);
+}
+
+#endif
+
+// Returns the index of the first element at or after from where a
+// differs from b (or from *b for every element with all), or count.
+static inline size_t myassert_array_mismatch(const void *a, const void *b, size_t count,
+                                             size_t size, bool all, size_t from)
+{
+    unsigned char pattern[MYASSERT_ARRAY_PATTERN];
+    const unsigned char *other = (const unsigned char *)b;
+    size_t stride = 1;
+    if (all)
+    {
+        for (size_t i = 0; i < sizeof(pattern); i += size)
+        {
+            memcpy(pattern + i, b, size);
+        }
+        other = pattern;
+        stride = 0;
+    }
+
+    const unsigned char *bytes = (const unsigned char *)a;
+#if defined(__GNUC__) || defined(__clang__)
+    // Hides the object sizes, which GCC would otherwise check against the
+    // wide loads of loops that never run for short buffers.
+    __asm__("" : "+r"(bytes), "+r"(other));
+#endif
+    size_t at;
+    switch (myassert_simd())
+    {
+#if MYASSERT_HAVE_X86_SIMD && MYASSERT_AVX2
+    case MYASSERT_SIMD_AVX2:
+        at = myassert_mismatch_avx2(bytes, other, from * size, count * size, stride);
+        break;
+#endif
+#if MYASSERT_HAVE_X86_SIMD
+    case MYASSERT_SIMD_SSE2:
+        at = myassert_mismatch_sse2(bytes, other, from * size, count * size, stride);
+        break;
+#endif
+    default:
+        at = myassert_mismatch_scalar(bytes, other, from * size, count * size, stride);
+        break;
+    }
+    return at / size;
+}
+
+MYASSERT_COLD
+static uint64_t myassert_count_mismatches(const void *a, const void *b, size_t count,
+                                          size_t size, bool all, size_t first)
+{
+    uint64_t mismatches = 0;
+    for (size_t i = first; i < count; i++)
+    {
+        i = myassert_array_mismatch(a, b, count, size, all, i);
+        mismatches += i < count;
+    }
+    return mismatches;
+}
+
+// The failing branch of every ASSERT_* macro is a single call to one of
+// these handlers, so the passing path compiles to a compare and a branch
+// that is predicted not taken.
+#if MYASSERT_HAVE_POSIX
+// Defined with the property tests below. Returns when no property case is
+// running on this thread, and otherwise ends the case as failed.
+static inline void myassert_property_catch(const struct myassert_failure *failure);
+// Defined with the reporters below. Writes what the run has to show
+// before a failed assertion ends it.
+static inline void myassert_report_abort(void);
+#endif
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_abort(const struct myassert_failure *failure)
+{
+#if MYASSERT_HAVE_POSIX
+    myassert_property_catch(failure);
+#endif
+    myassert_detail_record("Assertion", failure);
+#if MYASSERT_FAILURE_RING > 0
+    myassert_ring_push("Assertion", failure);
+    myassert_flush_failures(STDERR_FILENO);
+#else
+    myassert_report_failure(STDERR_FILENO, "Assertion", failure);
+#endif
+#if MYASSERT_HAVE_POSIX
+    myassert_report_abort();
+#endif
+    abort();
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fatal(const char *file, int line, const char *msg)
+{
+    char data[MYASSERT_MESSAGE_SIZE];
+    struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+    myassert_put_str(&buf, "Fatal error in ");
+    myassert_put_str(&buf, file);
+    myassert_put_str(&buf, " on line ");
+    myassert_put_int(&buf, line);
+    myassert_put_str(&buf, ": ");
+    myassert_put_str(&buf, msg);
+    myassert_write(STDERR_FILENO, &buf);
+    abort();
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_value(const struct myassert_site *site,
+                                const void *a, const void *b, size_t size)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    failure.size = size;
+    if (size > 0)
+    {
+        memcpy(failure.a, a, size);
+        memcpy(failure.b, b, size);
+    }
+    myassert_abort(&failure);
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_text(const struct myassert_site *site,
+                               const void *a, const void *b, size_t len)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    failure.size = len;
+    failure.text_a = (const char *)a;
+    failure.text_b = (const char *)b;
+    myassert_abort(&failure);
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_epsilon(const struct myassert_site *site,
+                                  double a, double b, double epsilon)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    failure.size = sizeof(double);
+    memcpy(failure.a, &a, sizeof(a));
+    memcpy(failure.b, &b, sizeof(b));
+    failure.epsilon = epsilon;
+    myassert_abort(&failure);
+}
+
+// Describes a failed memory check: the offset of the first difference
+// goes to a, the number of differing bytes to b, and the rows around the
+// first difference are copied into the captures.
+MYASSERT_COLD
+static void myassert_memory_failure(struct myassert_failure *failure, const void *a,
+                                    const void *b, size_t len, size_t first)
+{
+    uint64_t mismatches = myassert_count_mismatches(a, b, len, 1, false, first);
+    size_t start;
+    size_t window = myassert_memory_window(first, len, &start);
+
+    uint64_t offset = first;
+    failure->size = 1;
+    failure->count = len;
+    failure->count_b = len;
+    memcpy(failure->a, &offset, sizeof(offset));
+    memcpy(failure->b, &mismatches, sizeof(mismatches));
+    memcpy(failure->capture_a, (const unsigned char *)a + start, window);
+    memcpy(failure->capture_b, (const unsigned char *)b + start, window);
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_memory(const struct myassert_site *site,
+                                 const void *a, const void *b, size_t len)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    myassert_memory_failure(&failure, a, b, len, myassert_array_mismatch(a, b, len, 1, false, 0));
+    myassert_abort(&failure);
+}
+
+#define FATAL(msg)                                \
+    do                                            \
+    {                                             \
+        myassert_fatal(__FILE__, __LINE__, msg);  \
+    } while (0)
+
+#define ASSERT(expr)                                                 \
+    do                                                               \
+    {                                                                \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                 \
+        {                                                            \
+            MYASSERT_HINT(expr);                                     \
+            break;                                                   \
+        }                                                            \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT", \
+                      MYASSERT_SITE_EXPR, #expr, "", "", "");        \
+        MYASSERT_HIT(myassert_site);                                 \
+        if (MYASSERT_UNLIKELY(!(expr)))                              \
+        {                                                            \
+            myassert_fail_value(&myassert_site, NULL, NULL, 0);      \
+        }                                                            \
+    } while (0)
+
+#define ASSERT_BASE(a, operator, b, type, conv)                      \
+    do                                                               \
+    {                                                                \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                 \
+        {                                                            \
+            MYASSERT_HINT((type)(a) operator (type)(b));             \
+            break;                                                   \
+        }                                                            \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT", \
+                      MYASSERT_SITE_VALUE, #a, #operator, #b, conv); \
+        MYASSERT_HIT(myassert_site);                                 \
+        type const eval_a = (a);                                     \
+        type const eval_b = (b);                                     \
+        if (MYASSERT_UNLIKELY(!(eval_a operator eval_b)))            \
+        {                                                            \
+            type const fail_a = eval_a;                              \
+            type const fail_b = eval_b;                              \
+            myassert_fail_value(&myassert_site, &fail_a, &fail_b,    \
+                                sizeof(type));                       \
+        }                                                            \
+    } while (0)
+
+#define ASSERT_OK(a)                                                 \
+    do                                                               \
+    {                                                                \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                 \
+        {                                                            \
+            MYASSERT_HINT((a) == 0);                                 \
+            break;                                                   \
+        }                                                            \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT", \
+                      MYASSERT_SITE_OK, #a, "", "", PRId64);         \
+        MYASSERT_HIT(myassert_site);                                 \
+        int64_t const eval_a = (a);                                  \
+        if (MYASSERT_UNLIKELY(eval_a))                               \
+        {                                                            \
+            int64_t const fail_a = eval_a;                           \
+            myassert_fail_value(&myassert_site, &fail_a, &fail_a,    \
+                                sizeof(fail_a));                     \
+        }                                                            \
+    } while (0)
+
+#define ASSERT_BASE_STR(expr, a, operator, b, type, conv)            \
+    do                                                               \
+    {                                                                \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                 \
+        {                                                            \
+            MYASSERT_HINT(expr);                                     \
+            break;                                                   \
+        }                                                            \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT", \
+                      MYASSERT_SITE_TEXT, #a, #operator, #b, conv);  \
+        MYASSERT_HIT(myassert_site);                                 \
+        if (MYASSERT_UNLIKELY(!(expr)))                              \
+        {                                                            \
+            myassert_fail_text(&myassert_site, (type)a, (type)b,     \
+                               SIZE_MAX);                            \
+        }                                                            \
+    } while (0)
+
+#define ASSERT_BASE_LEN(expr, a, operator, b, conv, len)             \
+    do                                                               \
+    {                                                                \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                 \
+        {                                                            \
+            MYASSERT_HINT(expr);                                     \
+            break;                                                   \
+        }                                                            \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT", \
+                      MYASSERT_SITE_TEXT, #a, #operator, #b, conv);  \
+        MYASSERT_HIT(myassert_site);                                 \
+        if (MYASSERT_UNLIKELY(!(expr)))                              \
+        {                                                            \
+            myassert_fail_text(&myassert_site, a, b, len);           \
+        }                                                            \
+    } while (0)
+
+#define ASSERT_BASE_MEM_EQ(a, b, len)                                       \
+    do                                                                      \
+    {                                                                       \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                        \
+        {                                                                   \
+            MYASSERT_HINT(memcmp(a, b, len) == 0);                          \
+            break;                                                          \
+        }                                                                   \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",        \
+                      MYASSERT_SITE_MEMORY, #a, "==", #b, "x");             \
+        MYASSERT_HIT(myassert_site);                                        \
+        const void *const eval_a = (a);                                     \
+        const void *const eval_b = (b);                                     \
+        size_t const eval_len = (len);                                      \
+        if (MYASSERT_UNLIKELY(memcmp(eval_a, eval_b, eval_len) != 0))       \
+        {                                                                   \
+            myassert_fail_memory(&myassert_site, eval_a, eval_b, eval_len); \
+        }                                                                   \
+    } while (0)
+
+enum TestStatus
+{
+    TEST_OK = 0,
+    TEST_SKIP = 1,
+    TEST_FAIL = 2,
+    TEST_TIMEOUT = 3,
+    TEST_CACHED = 4
+};
+
+#define RETURN_OK()     \
+    do                  \
+    {                   \
+        return TEST_OK; \
+    } while (0)
+
+#define RETURN_SKIP(explanation)    \
+    do                              \
+    {                               \
+        myassert_skip(explanation); \
+        return TEST_SKIP;           \
+    } while (0)
+
+#define RUN_TEST(test_func) RUN_TEST_TIMEOUT(test_func, 0)
+
+// RUN_TEST takes any test function returning int or enum TestStatus, and
+// in C++ any callable. Each call builds the test record on the stack, so
+// the function and timeout may be runtime values.
+#ifdef __cplusplus
+#define MYASSERT_RUN_TEST_FUNC(test_func) myassert_run_test_func
+#elif defined(__GNUC__) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L)
+#ifdef __GNUC__
+#define MYASSERT_GENERIC __extension__ _Generic
+#else
+#define MYASSERT_GENERIC _Generic
+#endif
+#define MYASSERT_RUN_TEST_FUNC(test_func)                                 \
+    MYASSERT_GENERIC((test_func),                                         \
+                     enum TestStatus (*)(void): myassert_run_test_status, \
+                     default: myassert_run_test_int)
+#else
+#define MYASSERT_RUN_TEST_FUNC(test_func) myassert_run_test_int
+#endif
+
+#define RUN_TEST_TIMEOUT(test_func, ms)                                          \
+    MYASSERT_RUN_TEST_FUNC(test_func)(#test_func, test_func, __FILE__, __LINE__, \
+                                      ms)
+
+// =============================================================
+// EXPECTATION RECORDS
+// =============================================================
+
+// Failed expectations are buffered per thread while a test runs on it.
+struct myassert_expect_state
+{
+    bool active;
+    size_t count;
+    size_t logged;
+    struct myassert_failure records[MYASSERT_EXPECT_CAPACITY];
+};
+
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_expect_state myassert_expect;
+
+// An expectation that fails on a thread without a test, such as a thread
+// the test started or main() itself, is reported at once. It fails every
+// test running at the time. When none was, it fails the whole process if
+// the process runs tests, that is once RUN_TEST or myassert_run_all() was
+// called.
+MYASSERT_SHARED uint64_t myassert_stray_failures;
+MYASSERT_SHARED int myassert_tests_running;
+MYASSERT_SHARED bool myassert_runner_active;
+MYASSERT_SHARED bool myassert_process_failed;
+MYASSERT_SHARED bool myassert_process_watched;
+
+static inline void myassert_process_exit(void)
+{
+    if (__atomic_load_n(&myassert_process_failed, __ATOMIC_RELAXED))
+    {
+        fflush(NULL);
+        _Exit(EXIT_FAILURE);
+    }
+}
+
+// Registered before the program can register anything, so it runs after
+// every other exit handler.
+MYASSERT_ATTR((constructor))
+static void myassert_process_watch(void)
+{
+    if (!myassert_process_watched)
+    {
+        myassert_process_watched = true;
+        atexit(myassert_process_exit);
+    }
+}
+
+static inline void myassert_expect_stray(void)
+{
+    __atomic_fetch_add(&myassert_stray_failures, 1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&myassert_tests_running, __ATOMIC_RELAXED) == 0 &&
+        __atomic_load_n(&myassert_runner_active, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&myassert_process_failed, true, __ATOMIC_RELAXED);
+    }
+}
+
+static inline uint64_t myassert_stray_count(void)
+{
+    return __atomic_load_n(&myassert_stray_failures, __ATOMIC_RELAXED);
+}
+
+static inline void myassert_expect_reset(void)
+{
+    myassert_expect.active = true;
+    myassert_expect.count = 0;
+    myassert_expect.logged = 0;
+}
+
+MYASSERT_COLD
+static struct myassert_failure *myassert_expect_next(const struct myassert_site *site)
+{
+    size_t index = myassert_expect.count++;
+    if (index >= MYASSERT_EXPECT_CAPACITY)
+    {
+        return NULL;
+    }
+    struct myassert_failure *failure = &myassert_expect.records[index];
+    failure->site = site;
+    return failure;
+}
+
+// Completes a record from myassert_expect_next().
+MYASSERT_COLD
+static void myassert_expect_done(const struct myassert_failure *failure)
+{
+    myassert_ring_push("Expectation", failure);
+    if (!myassert_expect.active)
+    {
+        myassert_report_failure(STDERR_FILENO, "Expectation", failure);
+        myassert_expect.count = 0;
+        myassert_expect_stray();
+    }
+}
+
+MYASSERT_COLD
+static void myassert_expect_value(const struct myassert_site *site,
+                                         const void *a, const void *b, size_t size)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        failure->size = size;
+        if (size > 0)
+        {
+            memcpy(failure->a, a, size);
+            memcpy(failure->b, b, size);
+        }
+        myassert_expect_done(failure);
+    }
+}
+
+MYASSERT_COLD
+static void myassert_expect_text(const struct myassert_site *site,
+                                        const char *a, const char *b, size_t len)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        failure->size = len;
+        failure->text_a = failure->capture_a;
+        failure->text_b = failure->capture_b;
+        myassert_capture_text(failure->capture_a, a, len);
+        myassert_capture_text(failure->capture_b, b, len);
+        myassert_expect_done(failure);
+    }
+}
+
+MYASSERT_COLD
+static void myassert_expect_epsilon(const struct myassert_site *site,
+                                           double a, double b, double epsilon)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        failure->size = sizeof(double);
+        memcpy(failure->a, &a, sizeof(a));
+        memcpy(failure->b, &b, sizeof(b));
+        failure->epsilon = epsilon;
+        myassert_expect_done(failure);
+    }
+}
+
+MYASSERT_COLD
+static void myassert_expect_memory(const struct myassert_site *site,
+                                   const void *a, const void *b, size_t len)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        myassert_memory_failure(failure, a, b, len, myassert_array_mismatch(a, b, len, 1, false, 0));
+        myassert_expect_done(failure);
+    }
+}
+
+// Prints the failed expectations of the current test and clears them.
+// Sampled expectations were already logged when they failed and are only
+// counted. Returns true when at least one expectation failed.
+static inline bool myassert_expect_finish(void)
+{
+    size_t count = myassert_expect.count;
+    size_t logged = myassert_expect.logged;
+    if (count == 0 && logged == 0)
+    {
+        return false;
+    }
+
+    size_t shown = count < MYASSERT_EXPECT_CAPACITY ? count : MYASSERT_EXPECT_CAPACITY;
+    if (shown > 0)
+    {
+        myassert_detail_record("Expectation", &myassert_expect.records[0]);
+    }
+    for (size_t i = 0; i < shown; i++)
+    {
+        myassert_report_failure(STDERR_FILENO, "Expectation", &myassert_expect.records[i]);
+    }
+    if (count > shown)
+    {
+        char data[64];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_put_str(&buf, "... and ");
+        myassert_put_uint(&buf, count - shown, 10);
+        myassert_put_str(&buf, " more failed expectations");
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    myassert_expect.count = 0;
+    myassert_expect.logged = 0;
+    return true;
+}
+
+// =============================================================
+// ALLOCATION TRACKING
+// =============================================================
+
+// With MYASSERT_WRAP_ALLOCS defined and the program linked with
+//
+//     -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+//
+// calls to those functions from the linked objects are counted for the
+// calling thread. Live blocks are counted for the whole process, since a
+// block may be freed by another thread than the one that allocated it.
+// Calls made inside libc or other shared libraries, which includes
+// operator new, are not seen.
+#ifndef MYASSERT_WRAP_ALLOCS
+#define MYASSERT_WRAP_ALLOCS 0
+#endif
+
+struct myassert_alloc_stats
+{
+    uint64_t allocs;
+    uint64_t bytes;
+};
+
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_alloc_stats myassert_allocs;
+MYASSERT_SHARED int64_t myassert_allocs_live;
+
+// Tests started, shifted left by 32, plus tests running. A test that
+// finds it unchanged at its end ran alone, and owns the change in live
+// blocks.
+MYASSERT_SHARED uint64_t myassert_allocs_epoch;
+
+#if MYASSERT_WRAP_ALLOCS
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+#ifdef __cplusplus
+}
+#endif
+
+static inline void myassert_count_alloc(size_t size)
+{
+    myassert_allocs.allocs++;
+    myassert_allocs.bytes += size;
+    __atomic_fetch_add(&myassert_allocs_live, 1, __ATOMIC_RELAXED);
+}
+
+static inline void myassert_count_free(void)
+{
+    __atomic_fetch_sub(&myassert_allocs_live, 1, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+MYASSERT_SHARED void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    if (ptr != NULL)
+    {
+        myassert_count_alloc(size);
+    }
+    return ptr;
+}
+
+MYASSERT_SHARED void *__wrap_calloc(size_t count, size_t size)
+{
+    void *ptr = __real_calloc(count, size);
+    if (ptr != NULL)
+    {
+        myassert_count_alloc(count * size);
+    }
+    return ptr;
+}
+
+// Every successful call counts as an allocation of size bytes, whether
+// the block moved, grew or shrank.
+MYASSERT_SHARED void *__wrap_realloc(void *ptr, size_t size)
+{
+    void *moved = __real_realloc(ptr, size);
+    if (moved != NULL)
+    {
+        myassert_count_alloc(size);
+        if (ptr != NULL)
+        {
+            myassert_count_free();
+        }
+    }
+    else if (ptr != NULL && size == 0)
+    {
+        // glibc frees the block and returns NULL.
+        myassert_count_free();
+    }
+    return moved;
+}
+
+MYASSERT_SHARED void __wrap_free(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        myassert_count_free();
+    }
+    __real_free(ptr);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+// The compiler knows malloc() and may move loads of the counters across
+// it, so they are read between compiler barriers.
+static inline uint64_t myassert_allocs_count(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    uint64_t allocs = __atomic_load_n(&myassert_allocs.allocs, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    return allocs;
+}
+
+#if MYASSERT_WRAP_ALLOCS
+
+// The block runs whatever the assertion level, since it is the code under
+// test. It must not break out of or continue an enclosing loop.
+#define MYASSERT_ALLOCS_BASE(macro, level, handler, n, ...)                            \
+    do                                                                                 \
+    {                                                                                  \
+        if (!MYASSERT_ENABLED(level))                                                  \
+        {                                                                              \
+            __VA_ARGS__                                                                \
+            break;                                                                     \
+        }                                                                              \
+        MYASSERT_SITE(level, myassert_site, macro, MYASSERT_SITE_VALUE, "allocations", \
+                      "<=", #n, PRIu64);                                               \
+        MYASSERT_HIT(myassert_site);                                                   \
+        uint64_t eval_before = myassert_allocs_count();                                \
+        __VA_ARGS__                                                                    \
+        uint64_t eval_a = myassert_allocs_count() - eval_before;                       \
+        uint64_t eval_b = (n);                                                         \
+        if (MYASSERT_UNLIKELY(eval_a > eval_b))                                        \
+        {                                                                              \
+            handler(&myassert_site, &eval_a, &eval_b, sizeof(uint64_t));               \
+        }                                                                              \
+    } while (0)
+
+#else
+
+// Without the wrappers nothing counts allocations, so an enabled check
+// fails to compile rather than pass. A disabled one still runs the block.
+#ifdef __cplusplus
+#define MYASSERT_ALLOCS_MISSING(...) \
+    static_assert(false, "allocation checks need MYASSERT_WRAP_ALLOCS and -Wl,--wrap=malloc,...")
+#else
+#define MYASSERT_ALLOCS_MISSING(...) \
+    _Static_assert(0, "allocation checks need MYASSERT_WRAP_ALLOCS and -Wl,--wrap=malloc,...")
+#endif
+#define MYASSERT_ALLOCS_SKIPPED(...) \
+    do                               \
+    {                                \
+        __VA_ARGS__                  \
+    } while (0)
+
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL)
+#define MYASSERT_ALLOCS_1 MYASSERT_ALLOCS_MISSING
+#else
+#define MYASSERT_ALLOCS_1 MYASSERT_ALLOCS_SKIPPED
+#endif
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL)
+#define MYASSERT_ALLOCS_2 MYASSERT_ALLOCS_MISSING
+#else
+#define MYASSERT_ALLOCS_2 MYASSERT_ALLOCS_SKIPPED
+#endif
+
+#define MYASSERT_ALLOCS_BASE(macro, level, handler, n, ...) MYASSERT_ALLOCS_AT(level, __VA_ARGS__)
+#define MYASSERT_ALLOCS_AT(level, ...) MYASSERT_ALLOCS_##level(__VA_ARGS__)
+
+#endif
+
+#define ASSERT_MAX_ALLOCS(n, ...) \
+    MYASSERT_ALLOCS_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_value, n, __VA_ARGS__)
+#define ASSERT_NO_ALLOCS(...) ASSERT_MAX_ALLOCS(0, __VA_ARGS__)
+#define EXPECT_MAX_ALLOCS(n, ...) \
+    MYASSERT_ALLOCS_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_value, n, __VA_ARGS__)
+#define EXPECT_NO_ALLOCS(...) EXPECT_MAX_ALLOCS(0, __VA_ARGS__)
+
+// =============================================================
+// PERFORMANCE COUNTERS
+// =============================================================
+
+enum myassert_perf_event
+{
+    MYASSERT_INSTRUCTIONS,
+    MYASSERT_CYCLES,
+    MYASSERT_CACHE_MISSES,
+    MYASSERT_BRANCH_MISSES,
+    MYASSERT_PAGE_FAULTS,
+    MYASSERT_TASK_CLOCK,
+    MYASSERT_PERF_EVENTS
+};
+
+// Value of a counter that could not be opened.
+#define MYASSERT_PERF_NONE UINT64_MAX
+
+static const char *const myassert_perf_names[MYASSERT_PERF_EVENTS] = {
+    "instructions", "cycles", "cache misses", "branch misses", "page faults", "ns task clock"};
+
+MYASSERT_SHARED int myassert_perf_warned[MYASSERT_PERF_EVENTS];
+
+// The first event a check in the test running on this thread could not
+// count, plus one, and the error. The test is then reported as skipped
+// unless it failed.
+struct myassert_perf_missing
+{
+    int event;
+    int error;
+};
+
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_perf_missing myassert_perf_missing;
+
+// Counts user space only, which is all an unprivileged process may count
+// with the default perf_event_paranoid, including threads the code under
+// test starts. Returns -1 when the event cannot be counted, as hardware
+// events often cannot in containers and virtual machines.
+static inline int myassert_perf_open(int event)
+{
+#if MYASSERT_HAVE_PERF
+    static const struct
+    {
+        uint32_t type;
+        uint64_t config;
+    } events[MYASSERT_PERF_EVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}};
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[event].type;
+    attr.config = events[event].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (fd >= 0)
+    {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return fd;
+#else
+    (void)event;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+// Stops and closes a counter. When the kernel had to share the hardware
+// counters between events, the count is scaled up to the time the event
+// was enabled.
+static inline uint64_t myassert_perf_close(int fd)
+{
+    if (fd < 0)
+    {
+        return MYASSERT_PERF_NONE;
+    }
+    uint64_t value = MYASSERT_PERF_NONE;
+#if MYASSERT_HAVE_PERF
+    uint64_t data[3];
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, data, sizeof(data)) == (ssize_t)sizeof(data))
+    {
+        value = data[0];
+        if (data[2] != 0 && data[2] < data[1])
+        {
+            value = (uint64_t)((double)value * (double)data[1] / (double)data[2]);
+        }
+    }
+    close(fd);
+#endif
+    return value;
+}
+
+static inline void myassert_perf_explain(struct myassert_buf *buf, int event, int error)
+{
+    myassert_put_str(buf, "Cannot count ");
+    myassert_put_str(buf, myassert_perf_names[event]);
+    myassert_put_str(buf, " (");
+    myassert_put_str(buf, strerror(error));
+    myassert_put_str(buf, "), skipping the test");
+}
+
+// A check on an event that cannot be counted skips its test. Only the
+// first such check prints why.
+static inline int myassert_perf_begin(int event)
+{
+    int fd = myassert_perf_open(event);
+    if (fd < 0)
+    {
+        int error = errno;
+        if (myassert_perf_missing.event == 0)
+        {
+            myassert_perf_missing.event = event + 1;
+            myassert_perf_missing.error = error;
+        }
+        if (__atomic_exchange_n(&myassert_perf_warned[event], 1, __ATOMIC_RELAXED) == 0)
+        {
+            char data[256];
+            struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+            myassert_perf_explain(&buf, event, error);
+            myassert_write(STDERR_FILENO, &buf);
+        }
+    }
+    return fd;
+}
+
+// The block runs as in MYASSERT_ALLOCS_BASE.
+#define MYASSERT_PERF_BASE(macro, level, handler, event, limit, ...)                         \
+    do                                                                                       \
+    {                                                                                        \
+        if (!MYASSERT_ENABLED(level))                                                        \
+        {                                                                                    \
+            __VA_ARGS__                                                                      \
+            break;                                                                           \
+        }                                                                                    \
+        MYASSERT_SITE(level, myassert_site, macro, MYASSERT_SITE_VALUE, #event, "<", #limit, \
+                      PRIu64);                                                               \
+        MYASSERT_HIT(myassert_site);                                                         \
+        int const eval_fd = myassert_perf_begin(event);                                      \
+        __VA_ARGS__                                                                          \
+        uint64_t eval_a = myassert_perf_close(eval_fd);                                      \
+        uint64_t eval_b = (limit);                                                           \
+        if (MYASSERT_UNLIKELY(eval_a != MYASSERT_PERF_NONE && eval_a >= eval_b))             \
+        {                                                                                    \
+            handler(&myassert_site, &eval_a, &eval_b, sizeof(uint64_t));                     \
+        }                                                                                    \
+    } while (0)
+
+#define ASSERT_PERF_LT(event, limit, ...) \
+    MYASSERT_PERF_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_value, event, limit, __VA_ARGS__)
+#define EXPECT_PERF_LT(event, limit, ...) \
+    MYASSERT_PERF_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_value, event, limit, __VA_ARGS__)
+
+// =============================================================
+// TEST EXECUTION
+// =============================================================
+
+struct myassert_fixture;
+
+struct myassert_test
+{
+    const char *name;
+    int (*func)(void);
+    // Used instead of func when set, with context as its argument.
+    int (*call)(const void *context);
+    const void *context;
+    const char *file;
+    int line;
+    uint64_t timeout_ms;
+    const char *const *inputs;
+    struct myassert_fixture *fixture;
+    struct myassert_test *next;
+};
+
+static inline int myassert_call_test(const struct myassert_test *test)
+{
+    return test->call != NULL ? test->call(test->context) : test->func();
+}
+
+// Resources used by one test. CPU time and context switches are counted
+// for the calling thread where the platform allows it. Peak RSS is process
+// wide, so concurrent tests share their growth.
+struct myassert_metrics
+{
+    double wall_ms;
+    double user_ms;
+    double sys_ms;
+    long rss_kb;
+    long context_switches;
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+    int64_t leaked;
+    uint64_t perf[MYASSERT_PERF_EVENTS];
+};
+
+struct myassert_result
+{
+    const struct myassert_test *test;
+    int status;
+    int signal;
+    bool done;
+    struct myassert_metrics metrics;
+    struct myassert_detail *detail;
+};
+
+static inline bool myassert_env_flag(const char *name)
+{
+    const char *env = getenv(name);
+    return env != NULL && env[0] != '\0' && strcmp(env, "0") != 0;
+}
+
+static inline unsigned long myassert_env_ulong(const char *name, unsigned long fallback)
+{
+    const char *env = getenv(name);
+    return env != NULL && env[0] != '\0' ? strtoul(env, NULL, 10) : fallback;
+}
+
+// Once a test that timed out was abandoned in this process, the locks it
+// held may never be released. Later tests without a limit then get this
+// one, so they cannot wait for such a lock forever.
+#ifndef MYASSERT_ABANDONED_TIMEOUT_MS
+#define MYASSERT_ABANDONED_TIMEOUT_MS 60000
+#endif
+
+MYASSERT_SHARED bool myassert_abandoned;
+
+// A test's own timeout, or MYASSERT_TIMEOUT_MS when it has none. 0 means
+// no limit.
+static inline uint64_t myassert_timeout(const struct myassert_test *test)
+{
+    uint64_t fallback = __atomic_load_n(&myassert_abandoned, __ATOMIC_RELAXED)
+                            ? MYASSERT_ABANDONED_TIMEOUT_MS
+                            : 0;
+    return test->timeout_ms != 0 ? test->timeout_ms
+                                 : myassert_env_ulong("MYASSERT_TIMEOUT_MS", fallback);
+}
+
+static inline void myassert_report_timeout(struct myassert_result *result, uint64_t timeout_ms)
+{
+    char data[256];
+    struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+    myassert_put_str(&buf, "Timeout in ");
+    myassert_put_str(&buf, result->test->name);
+    myassert_put_str(&buf, " after ");
+    myassert_put_uint(&buf, timeout_ms, 10);
+    myassert_put_str(&buf, " ms");
+    myassert_detail_note(result->detail, buf.data, buf.len);
+    myassert_write(STDERR_FILENO, &buf);
+}
+
+static inline const char *myassert_status_name(int status)
+{
+    switch (status)
+    {
+    case TEST_OK:
+        return "PASSED";
+    case TEST_SKIP:
+        return "SKIPPED";
+    case TEST_TIMEOUT:
+        return "TIMEOUT";
+    case TEST_CACHED:
+        return "CACHED";
+    case TEST_FAIL:
+    default:
+        return "FAILED";
+    }
+}
+
+// Tests record their detail only when a reporter is configured.
+static inline bool myassert_reporting(void)
+{
+    const char *env = getenv("MYASSERT_REPORT");
+    return MYASSERT_HAVE_POSIX && env != NULL && env[0] != '\0';
+}
+
+#if MYASSERT_HAVE_POSIX
+// Defined with the reporters below.
+static inline bool myassert_report_quiet(void);
+static inline void myassert_report_results(const struct myassert_result *results, size_t count);
+#else
+#define myassert_report_quiet() false
+#define myassert_report_results(results, count) ((void)0)
+#endif
+
+// The results of the run in progress and the test running on this
+// thread, for the reports written when an assertion ends the run.
+MYASSERT_SHARED struct myassert_result *myassert_active_results;
+MYASSERT_SHARED size_t myassert_active_count;
+
+// Memory a failed assertion needs to write the reports without
+// allocating: room for the finished results and an output buffer. It is
+// reserved with the results of a run when there are reports to write.
+MYASSERT_SHARED struct myassert_result *myassert_abort_results;
+MYASSERT_SHARED size_t myassert_abort_capacity;
+MYASSERT_SHARED char *myassert_abort_buffer;
+MYASSERT_SHARED const char *myassert_abort_spec;
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_result *myassert_current_result;
+
+#ifndef MYASSERT_REPORT_BUFFER
+#define MYASSERT_REPORT_BUFFER (256 * 1024)
+#endif
+
+// Progress lines go to stdout, but not through stdio, so a failed
+// assertion can still write them out. On a terminal each piece is written
+// as it is printed. Otherwise they get a buffer of MYASSERT_REPORT_BUFFER
+// bytes the first time the runner prints, and are written in batches.
+MYASSERT_SHARED struct myassert_out myassert_progress = {1, NULL, 0, 0, 0};
+MYASSERT_SHARED bool myassert_progress_checked;
+
+static inline void myassert_progress_start(void)
+{
+#if MYASSERT_HAVE_POSIX
+    if (myassert_progress_checked)
+    {
+        return;
+    }
+    myassert_progress_checked = true;
+    if (isatty(STDOUT_FILENO))
+    {
+        return;
+    }
+    myassert_progress.data = (char *)malloc(MYASSERT_REPORT_BUFFER);
+    myassert_progress.cap = myassert_progress.data != NULL ? MYASSERT_REPORT_BUFFER : 0;
+#endif
+}
+
+// Output the program left in stdout's stdio buffer goes out before the
+// progress that follows it. Without a way to tell, both are always
+// flushed.
+static inline void myassert_progress_put(const char *s)
+{
+#if MYASSERT_HAVE_POSIX && defined(__linux__)
+    bool pending = __fpending(stdout) != 0;
+#else
+    bool pending = true;
+#endif
+    if (pending)
+    {
+        myassert_out_flush(&myassert_progress);
+        fflush(stdout);
+    }
+    myassert_out_str(&myassert_progress, s);
+}
+
+static inline void myassert_abort_reserve(size_t count)
+{
+    if (!myassert_reporting())
+    {
+        return;
+    }
+    myassert_abort_spec = getenv("MYASSERT_REPORT");
+    if (count > myassert_abort_capacity)
+    {
+        struct myassert_result *results = (struct myassert_result *)realloc(
+            myassert_abort_results, count * sizeof(*results));
+        if (results == NULL)
+        {
+            FATAL("out of memory");
+        }
+        myassert_abort_results = results;
+        myassert_abort_capacity = count;
+    }
+    if (myassert_abort_buffer == NULL)
+    {
+        // Without it the reports are written unbuffered.
+        myassert_abort_buffer = (char *)malloc(MYASSERT_REPORT_BUFFER);
+    }
+}
+
+static inline void myassert_abort_release(void)
+{
+    free(myassert_abort_results);
+    free(myassert_abort_buffer);
+    myassert_abort_results = NULL;
+    myassert_abort_capacity = 0;
+    myassert_abort_buffer = NULL;
+}
+
+#if MYASSERT_HAVE_POSIX
+
+#ifdef RUSAGE_THREAD
+#define MYASSERT_RUSAGE RUSAGE_THREAD
+#else
+#define MYASSERT_RUSAGE RUSAGE_SELF
+#endif
+
+struct myassert_sample
+{
+    struct timespec wall;
+    struct rusage usage;
+    long maxrss;
+};
+
+static inline double myassert_timeval_ms(struct timeval tv)
+{
+    return (double)tv.tv_sec * 1e3 + (double)tv.tv_usec / 1e3;
+}
+
+static inline void myassert_sample(struct myassert_sample *sample)
+{
+    struct rusage self;
+    clock_gettime(CLOCK_MONOTONIC, &sample->wall);
+    getrusage(MYASSERT_RUSAGE, &sample->usage);
+    getrusage(RUSAGE_SELF, &self);
+    sample->maxrss = self.ru_maxrss;
+}
+
+static inline void myassert_measure(struct myassert_metrics *metrics,
+                                    const struct myassert_sample *before,
+                                    const struct myassert_sample *after)
+{
+    metrics->wall_ms = (double)(after->wall.tv_sec - before->wall.tv_sec) * 1e3 +
+                       (double)(after->wall.tv_nsec - before->wall.tv_nsec) / 1e6;
+    metrics->user_ms = myassert_timeval_ms(after->usage.ru_utime) -
+                       myassert_timeval_ms(before->usage.ru_utime);
+    metrics->sys_ms = myassert_timeval_ms(after->usage.ru_stime) -
+                      myassert_timeval_ms(before->usage.ru_stime);
+    metrics->rss_kb = after->maxrss - before->maxrss;
+    metrics->context_switches =
+        (after->usage.ru_nvcsw + after->usage.ru_nivcsw) -
+        (before->usage.ru_nvcsw + before->usage.ru_nivcsw);
+}
+
+static inline uint64_t myassert_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// A watchdog thread sends MYASSERT_TIMEOUT_SIGNAL to the thread of a test
+// that runs past its timeout, and the handler jumps back out of the test.
+// Whatever the test held, locks included, is abandoned. In a forked test
+// process the zygote kills the process instead.
+#ifndef MYASSERT_TIMEOUT_SIGNAL
+#define MYASSERT_TIMEOUT_SIGNAL SIGALRM
+#endif
+
+struct myassert_watch
+{
+    pthread_t thread;
+    uint64_t deadline;
+    bool fired;
+    struct myassert_watch *next;
+};
+
+struct myassert_watchdog
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    struct myassert_watch *watches;
+};
+
+MYASSERT_SHARED struct myassert_watchdog myassert_watchdog = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL};
+MYASSERT_SHARED pthread_once_t myassert_watchdog_once = PTHREAD_ONCE_INIT;
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL sigjmp_buf *volatile myassert_timeout_exit;
+
+// Set in forked test processes.
+MYASSERT_SHARED bool myassert_isolated;
+
+// A process the current test is waiting for, killed when the test times
+// out.
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL pid_t myassert_test_child;
+
+static void myassert_timeout_handler(int signo)
+{
+    (void)signo;
+    sigjmp_buf *jump = myassert_timeout_exit;
+    if (jump != NULL)
+    {
+        myassert_timeout_exit = NULL;
+        siglongjmp(*jump, 1);
+    }
+}
+
+static inline void *myassert_watchdog_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&myassert_watchdog.lock);
+    for (;;)
+    {
+        uint64_t now = myassert_now_ns();
+        uint64_t next = UINT64_MAX;
+        for (struct myassert_watch *w = myassert_watchdog.watches; w != NULL; w = w->next)
+        {
+            if (w->fired)
+            {
+                continue;
+            }
+            if (w->deadline <= now)
+            {
+                w->fired = true;
+                pthread_kill(w->thread, MYASSERT_TIMEOUT_SIGNAL);
+            }
+            else if (w->deadline < next)
+            {
+                next = w->deadline;
+            }
+        }
+        if (next == UINT64_MAX)
+        {
+            pthread_cond_wait(&myassert_watchdog.wake, &myassert_watchdog.lock);
+            continue;
+        }
+        // Condition variables wait on CLOCK_REALTIME unless configured
+        // otherwise, which not every platform supports.
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        uint64_t ns = (uint64_t)until.tv_nsec + (next - now);
+        until.tv_sec += (time_t)(ns / 1000000000u);
+        until.tv_nsec = (long)(ns % 1000000000u);
+        pthread_cond_timedwait(&myassert_watchdog.wake, &myassert_watchdog.lock, &until);
+    }
+    return NULL;
+}
+
+// The watchdog blocks every signal, so the timeout signal always lands on
+// the thread it is meant for.
+static inline void myassert_watchdog_start(void)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = myassert_timeout_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(MYASSERT_TIMEOUT_SIGNAL, &action, NULL);
+
+    sigset_t all;
+    sigset_t old;
+    pthread_t thread;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    if (pthread_create(&thread, NULL, myassert_watchdog_main, NULL) != 0)
+    {
+        FATAL("pthread_create failed");
+    }
+    pthread_detach(thread);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+static inline void myassert_watch_start(struct myassert_watch *watch, sigjmp_buf *jump,
+                                        uint64_t timeout_ms)
+{
+    pthread_once(&myassert_watchdog_once, myassert_watchdog_start);
+    watch->thread = pthread_self();
+    watch->deadline = myassert_now_ns() + timeout_ms * 1000000u;
+    watch->fired = false;
+    myassert_timeout_exit = jump;
+    pthread_mutex_lock(&myassert_watchdog.lock);
+    watch->next = myassert_watchdog.watches;
+    myassert_watchdog.watches = watch;
+    pthread_cond_signal(&myassert_watchdog.wake);
+    pthread_mutex_unlock(&myassert_watchdog.lock);
+}
+
+// A signal that arrives after the exit is cleared does nothing.
+static inline void myassert_watch_stop(struct myassert_watch *watch)
+{
+    myassert_timeout_exit = NULL;
+    pthread_mutex_lock(&myassert_watchdog.lock);
+    struct myassert_watch **link = &myassert_watchdog.watches;
+    while (*link != watch)
+    {
+        link = &(*link)->next;
+    }
+    *link = watch->next;
+    pthread_mutex_unlock(&myassert_watchdog.lock);
+}
+
+// Runs a test under the watchdog. Returns TEST_TIMEOUT when it had to be
+// interrupted.
+static inline int myassert_call_watched(const struct myassert_test *test, uint64_t timeout_ms)
+{
+    struct myassert_watch watch;
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1) != 0)
+    {
+        myassert_watch_stop(&watch);
+        __atomic_store_n(&myassert_abandoned, true, __ATOMIC_RELAXED);
+        if (myassert_test_child > 0)
+        {
+            kill(myassert_test_child, SIGKILL);
+            waitpid(myassert_test_child, NULL, 0);
+            myassert_test_child = 0;
+        }
+        return TEST_TIMEOUT;
+    }
+    myassert_watch_start(&watch, &jump, timeout_ms);
+    int status = myassert_call_test(test);
+    myassert_watch_stop(&watch);
+    return status;
+}
+
+#else
+
+struct myassert_sample
+{
+    clock_t cpu;
+};
+
+static inline void myassert_sample(struct myassert_sample *sample)
+{
+    sample->cpu = clock();
+}
+
+static inline void myassert_measure(struct myassert_metrics *metrics,
+                                    const struct myassert_sample *before,
+                                    const struct myassert_sample *after)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->user_ms = (double)(after->cpu - before->cpu) * 1e3 / CLOCKS_PER_SEC;
+    metrics->wall_ms = metrics->user_ms;
+}
+
+#endif
+
+// A test that ends with more blocks allocated on its thread than it
+// started with fails, unless MYASSERT_LEAK_CHECK=0.
+// With MYASSERT_PERF=1 every test also counts the events of
+// myassert_perf_event, which are then listed with the slowest tests.
+static inline void myassert_perf_start(int *fds)
+{
+    for (int i = 0; i < MYASSERT_PERF_EVENTS; i++)
+    {
+        fds[i] = myassert_perf_open(i);
+    }
+}
+
+static inline void myassert_perf_stop(const int *fds, uint64_t *counts)
+{
+    for (int i = MYASSERT_PERF_EVENTS - 1; i >= 0; i--)
+    {
+        counts[i] = myassert_perf_close(fds[i]);
+    }
+}
+
+static inline bool myassert_leak_check(void)
+{
+    const char *env = getenv("MYASSERT_LEAK_CHECK");
+    return env == NULL || env[0] == '\0' || strcmp(env, "0") != 0;
+}
+
+static inline void myassert_execute(const struct myassert_test *test,
+                                    struct myassert_result *result)
+{
+    struct myassert_sample before;
+    struct myassert_sample after;
+
+    result->test = test;
+    myassert_current_result = result;
+    myassert_current_detail = result->detail;
+    myassert_expect_reset();
+    myassert_perf_missing.event = 0;
+    struct myassert_alloc_stats allocs = myassert_allocs;
+    uint64_t epoch =
+        __atomic_add_fetch(&myassert_allocs_epoch, ((uint64_t)1 << 32) + 1, __ATOMIC_SEQ_CST);
+    int64_t live = __atomic_load_n(&myassert_allocs_live, __ATOMIC_SEQ_CST);
+    bool perf = myassert_env_flag("MYASSERT_PERF");
+    int perf_fds[MYASSERT_PERF_EVENTS];
+    if (perf)
+    {
+        myassert_perf_start(perf_fds);
+    }
+    uint64_t timeout_ms = myassert_timeout(test);
+    __atomic_fetch_add(&myassert_tests_running, 1, __ATOMIC_RELAXED);
+    uint64_t strays = myassert_stray_count();
+    myassert_sample(&before);
+#if MYASSERT_HAVE_POSIX
+    if (timeout_ms != 0 && !myassert_isolated)
+    {
+        result->status = myassert_call_watched(test, timeout_ms);
+    }
+    else
+#endif
+    {
+        result->status = myassert_call_test(test);
+    }
+    myassert_sample(&after);
+    strays = myassert_stray_count() - strays;
+    __atomic_fetch_sub(&myassert_tests_running, 1, __ATOMIC_RELAXED);
+    if (perf)
+    {
+        myassert_perf_stop(perf_fds, result->metrics.perf);
+    }
+    myassert_measure(&result->metrics, &before, &after);
+    result->metrics.allocs = myassert_allocs.allocs - allocs.allocs;
+    result->metrics.alloc_bytes = myassert_allocs.bytes - allocs.bytes;
+    // Concurrent tests in one process share the live block count, so their
+    // leaks are not checked.
+    result->metrics.leaked = 0;
+    if ((uint32_t)epoch == 1 && __atomic_load_n(&myassert_allocs_epoch, __ATOMIC_SEQ_CST) == epoch)
+    {
+        result->metrics.leaked = __atomic_load_n(&myassert_allocs_live, __ATOMIC_SEQ_CST) - live;
+    }
+    __atomic_sub_fetch(&myassert_allocs_epoch, 1, __ATOMIC_SEQ_CST);
+    if (result->status == TEST_TIMEOUT)
+    {
+        myassert_report_timeout(result, timeout_ms);
+    }
+    if (myassert_perf_missing.event != 0 && result->status == TEST_OK &&
+        myassert_expect.count == 0)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_perf_explain(&buf, myassert_perf_missing.event - 1, myassert_perf_missing.error);
+        myassert_detail_note(result->detail, buf.data, buf.len);
+        result->status = TEST_SKIP;
+    }
+    if (myassert_expect_finish() && result->status != TEST_TIMEOUT)
+    {
+        result->status = TEST_FAIL;
+    }
+    myassert_expect.active = false;
+    if (strays != 0 && result->status != TEST_TIMEOUT)
+    {
+        static const char note[] = "Expectation failed on a thread without a test";
+        myassert_detail_note(result->detail, note, sizeof(note) - 1);
+        result->status = TEST_FAIL;
+    }
+    if (MYASSERT_WRAP_ALLOCS && result->metrics.leaked > 0 && myassert_leak_check() &&
+        result->status != TEST_TIMEOUT)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_put_str(&buf, "Leak in ");
+        myassert_put_str(&buf, test->name);
+        myassert_put_str(&buf, ": ");
+        myassert_put_int(&buf, result->metrics.leaked);
+        myassert_put_str(&buf, result->metrics.leaked == 1 ? " block" : " blocks");
+        myassert_put_str(&buf, " not freed");
+        myassert_detail_note(result->detail, buf.data, buf.len);
+        myassert_write(STDERR_FILENO, &buf);
+        result->status = TEST_FAIL;
+    }
+    result->done = true;
+    myassert_current_detail = NULL;
+    myassert_current_result = NULL;
+}
+
+// Lists the counters that could be opened, under the test's line.
+static inline void myassert_print_perf(const struct myassert_metrics *m)
+{
+    const char *separator = "      ";
+    for (int i = 0; i < MYASSERT_PERF_EVENTS; i++)
+    {
+        if (m->perf[i] != MYASSERT_PERF_NONE)
+        {
+            printf("%s%" PRIu64 " %s", separator, m->perf[i], myassert_perf_names[i]);
+            separator = ", ";
+        }
+    }
+    if (separator[0] == ',')
+    {
+        printf("\n");
+    }
+}
+
+static inline int myassert_compare_wall(const void *lhs, const void *rhs)
+{
+    double a = (*(const struct myassert_result *const *)lhs)->metrics.wall_ms;
+    double b = (*(const struct myassert_result *const *)rhs)->metrics.wall_ms;
+    return (a < b) - (a > b);
+}
+
+// Prints the MYASSERT_SLOWEST (default 10, 0 disables) tests with the
+// longest wall time.
+static inline void myassert_report_slowest(const struct myassert_result *results,
+                                           size_t count)
+{
+    const char *env = getenv("MYASSERT_SLOWEST");
+    size_t limit = env != NULL ? (size_t)strtoul(env, NULL, 10) : 10;
+    if (limit == 0 || count == 0 || myassert_report_quiet())
+    {
+        return;
+    }
+
+    const struct myassert_result **order =
+        (const struct myassert_result **)malloc(count * sizeof(*order));
+    if (order == NULL)
+    {
+        return;
+    }
+    size_t ran = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (results[i].status != TEST_CACHED)
+        {
+            order[ran++] = &results[i];
+        }
+    }
+    qsort(order, ran, sizeof(*order), myassert_compare_wall);
+
+    limit = limit < ran ? limit : ran;
+    if (limit == 0)
+    {
+        free(order);
+        return;
+    }
+    bool perf = myassert_env_flag("MYASSERT_PERF");
+    printf("Slowest %zu tests:\n", limit);
+    for (size_t i = 0; i < limit; i++)
+    {
+        const struct myassert_metrics *m = &order[i]->metrics;
+#if MYASSERT_WRAP_ALLOCS
+        printf("  %10.3f ms wall %10.3f ms user %10.3f ms sys %8ld KiB rss %6ld csw "
+               "%8" PRIu64 " allocs  %s\n",
+               m->wall_ms, m->user_ms, m->sys_ms, m->rss_kb, m->context_switches,
+               m->allocs, order[i]->test->name);
+#else
+        printf("  %10.3f ms wall %10.3f ms user %10.3f ms sys %8ld KiB rss %6ld csw  %s\n",
+               m->wall_ms, m->user_ms, m->sys_ms, m->rss_kb, m->context_switches,
+               order[i]->test->name);
+#endif
+        if (perf)
+        {
+            myassert_print_perf(m);
+        }
+    }
+    fflush(stdout);
+    free(order);
+}
+
+// Results of every RUN_TEST, reported when the program exits.
+MYASSERT_SHARED struct myassert_result *myassert_run_results;
+MYASSERT_SHARED size_t myassert_run_count;
+MYASSERT_SHARED size_t myassert_run_capacity;
+
+// Defined with the snapshot store below.
+static inline void myassert_snapshot_merge(void);
+
+static inline void myassert_run_exit(void)
+{
+    myassert_out_flush(&myassert_progress);
+    myassert_report_slowest(myassert_run_results, myassert_run_count);
+    myassert_report_results(myassert_run_results, myassert_run_count);
+    myassert_snapshot_merge();
+    if (myassert_env_flag("MYASSERT_SITES"))
+    {
+        myassert_dump_sites();
+    }
+    for (size_t i = 0; i < myassert_run_count; i++)
+    {
+        free(myassert_run_results[i].detail);
+        free((void *)myassert_run_results[i].test);
+    }
+    myassert_active_results = NULL;
+    myassert_active_count = 0;
+    myassert_abort_release();
+    free(myassert_run_results);
+    myassert_run_results = NULL;
+    myassert_run_count = 0;
+}
+
+static inline void myassert_run_test(const struct myassert_test *test)
+{
+    __atomic_store_n(&myassert_runner_active, true, __ATOMIC_RELAXED);
+    if (myassert_run_count == myassert_run_capacity)
+    {
+        size_t capacity = myassert_run_capacity != 0 ? myassert_run_capacity * 2 : 64;
+        struct myassert_result *results = (struct myassert_result *)realloc(
+            myassert_run_results, capacity * sizeof(*results));
+        if (results == NULL)
+        {
+            FATAL("out of memory");
+        }
+        if (myassert_run_results == NULL)
+        {
+            atexit(myassert_run_exit);
+        }
+        myassert_run_results = results;
+        myassert_run_capacity = capacity;
+    }
+
+    // The record is reported at exit, after the caller's copy is gone.
+    struct myassert_test *copy = (struct myassert_test *)malloc(sizeof(*copy));
+    if (copy == NULL)
+    {
+        FATAL("out of memory");
+    }
+    *copy = *test;
+    struct myassert_result *result = &myassert_run_results[myassert_run_count++];
+    memset(result, 0, sizeof(*result));
+    if (myassert_reporting())
+    {
+        result->detail = (struct myassert_detail *)calloc(1, sizeof(*result->detail));
+        if (result->detail == NULL)
+        {
+            FATAL("out of memory");
+        }
+    }
+    myassert_abort_reserve(myassert_run_capacity);
+    myassert_active_results = myassert_run_results;
+    myassert_active_count = myassert_run_count;
+    bool quiet = myassert_report_quiet();
+    if (!quiet)
+    {
+        myassert_progress_start();
+        myassert_progress_put("Running ");
+        myassert_progress_put(test->name);
+        myassert_progress_put("... ");
+    }
+    myassert_execute(copy, result);
+    if (!quiet)
+    {
+        myassert_progress_put(myassert_status_name(result->status));
+        myassert_progress_put("\n");
+    }
+}
+
+static inline void myassert_run_test_int(const char *name, int (*func)(void), const char *file,
+                                         int line, uint64_t timeout_ms)
+{
+    struct myassert_test test = {name, func, NULL, NULL, file, line, timeout_ms, NULL, NULL, NULL};
+    myassert_run_test(&test);
+}
+
+static inline int myassert_call_status(const void *context)
+{
+    enum TestStatus (*const *func)(void) = (enum TestStatus (*const *)(void))context;
+    return (*func)();
+}
+
+static inline void myassert_run_test_status(const char *name, enum TestStatus (*func)(void),
+                                            const char *file, int line, uint64_t timeout_ms)
+{
+    struct myassert_test test = {name, NULL, myassert_call_status, &func, file, line,
+                                 timeout_ms, NULL, NULL, NULL};
+    myassert_run_test(&test);
+}
+
+#ifdef __cplusplus
+template <typename Func>
+static inline int myassert_call_callable(const void *context)
+{
+    return (int)(*(Func *)context)();
+}
+
+template <typename Func>
+static inline void myassert_run_test_func(const char *name, Func func, const char *file, int line,
+                                          uint64_t timeout_ms)
+{
+    struct myassert_test test = {name, NULL, myassert_call_callable<Func>, &func, file, line,
+                                 timeout_ms, NULL, NULL, NULL};
+    myassert_run_test(&test);
+}
+#endif
+
+// =============================================================
+// FIXTURES
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+// A fixture is built once per process, when a test first asks for it,
+// and its memory is then made read-only. FIXTURE_GET hands out that
+// shared copy. Each TEST_F runs in a forked child instead, which gets a
+// private, writable copy through copy-on-write. Memory the setup
+// allocates itself is inherited the same way, but is not protected.
+struct myassert_fixture
+{
+    const char *name;
+    size_t size;
+    void (*setup)(void *fixture);
+    pthread_mutex_t lock;
+    void *data;
+};
+
+#define FIXTURE(name, type)                                                     \
+    typedef type myassert_fixture_type_##name;                                  \
+    static void myassert_fixture_build_##name(type *fixture);                   \
+    static void myassert_fixture_setup_##name(void *fixture)                    \
+    {                                                                           \
+        myassert_fixture_build_##name((type *)fixture);                         \
+    }                                                                           \
+    static struct myassert_fixture myassert_fixture_##name =                    \
+        {#name, sizeof(type), myassert_fixture_setup_##name,                    \
+         PTHREAD_MUTEX_INITIALIZER, NULL};                                      \
+    static void myassert_fixture_build_##name(type *fixture)
+
+static inline size_t myassert_fixture_length(const struct myassert_fixture *fixture)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (fixture->size + page - 1) / page * page;
+}
+
+static inline void *myassert_fixture_get(struct myassert_fixture *fixture)
+{
+    void *data = __atomic_load_n(&fixture->data, __ATOMIC_ACQUIRE);
+    if (data != NULL)
+    {
+        return data;
+    }
+    pthread_mutex_lock(&fixture->lock);
+    data = fixture->data;
+    if (data == NULL)
+    {
+        size_t length = myassert_fixture_length(fixture);
+        data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+        {
+            FATAL("out of memory");
+        }
+        fixture->setup(data);
+        mprotect(data, length, PROT_READ);
+        __atomic_store_n(&fixture->data, data, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&fixture->lock);
+    return data;
+}
+
+#define FIXTURE_GET(name) \
+    ((const myassert_fixture_type_##name *)myassert_fixture_get(&myassert_fixture_##name))
+
+// Runs a TEST_F body on a writable copy of its fixture. A test that
+// already has a process of its own runs there; any other forks a child
+// once the fixture is built and waits for its exit status. The child
+// records its detail in a shared page, which is copied back afterwards.
+// The parallel runner never gets here from a worker thread: it sends
+// TEST_F tests to a zygote instead.
+static inline int myassert_fixture_run(struct myassert_fixture *fixture, int (*body)(void *))
+{
+    void *data = myassert_fixture_get(fixture);
+    if (myassert_isolated)
+    {
+        mprotect(data, myassert_fixture_length(fixture), PROT_READ | PROT_WRITE);
+        return body(data);
+    }
+
+    struct myassert_detail *detail = myassert_current_detail;
+    struct myassert_detail *shared = NULL;
+    if (detail != NULL)
+    {
+        void *page = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        shared = page != MAP_FAILED ? (struct myassert_detail *)page : NULL;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    if (child < 0)
+    {
+        FATAL("fork failed");
+    }
+    if (child == 0)
+    {
+        myassert_isolated = true;
+        myassert_current_detail = shared;
+        mprotect(data, myassert_fixture_length(fixture), PROT_READ | PROT_WRITE);
+        uint64_t strays = myassert_stray_count();
+        int status = body(data);
+        if (myassert_expect_finish() || myassert_stray_count() != strays)
+        {
+            status = TEST_FAIL;
+        }
+        fflush(stdout);
+        fflush(stderr);
+        _exit(status & 0xff);
+    }
+
+    int wstatus = 0;
+    myassert_test_child = child;
+    while (waitpid(child, &wstatus, 0) < 0 && errno == EINTR)
+    {
+    }
+    myassert_test_child = 0;
+    if (shared != NULL)
+    {
+        if (shared->what != NULL)
+        {
+            myassert_detail_record(shared->what, &shared->failure);
+        }
+        else
+        {
+            myassert_detail_note(detail, shared->message, strlen(shared->message));
+        }
+        munmap(shared, sizeof(*shared));
+    }
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : TEST_FAIL;
+}
+
+// A TEST() whose body receives a writable copy of the fixture as
+// fixture. Other tests do not see its changes.
+#define TEST_F(name, fixture_name)                                          \
+    static int name(myassert_fixture_type_##fixture_name *fixture);         \
+    static int myassert_fixture_body_##name(void *fixture)                  \
+    {                                                                       \
+        return name((myassert_fixture_type_##fixture_name *)fixture);       \
+    }                                                                       \
+    static int myassert_fixture_test_##name(void)                           \
+    {                                                                       \
+        return myassert_fixture_run(&myassert_fixture_##fixture_name,       \
+                                    myassert_fixture_body_##name);          \
+    }                                                                       \
+    static struct myassert_test myassert_test_##name =                      \
+        {#name, myassert_fixture_test_##name, NULL, NULL, __FILE__,         \
+         __LINE__, 0, NULL, &myassert_fixture_##fixture_name, NULL};        \
+    MYASSERT_ATTR((constructor))                                            \
+    static void myassert_register_##name(void)                              \
+    {                                                                       \
+        myassert_register(&myassert_test_##name);                           \
+    }                                                                       \
+    static int name(myassert_fixture_type_##fixture_name *fixture)
+
+#endif
+
+// =============================================================
+// TEST REGISTRY AND PARALLEL RUNNER
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+// Tests registered by TEST(), linked in constructor order.
+MYASSERT_SHARED struct myassert_test *myassert_tests;
+
+static inline void myassert_register(struct myassert_test *test)
+{
+    test->next = myassert_tests;
+    myassert_tests = test;
+}
+
+#define TEST(name) TEST_TIMEOUT(name, 0)
+
+// A TEST() that times out after ms milliseconds instead of
+// MYASSERT_TIMEOUT_MS.
+#define TEST_TIMEOUT(name, ms)                                               \
+    static int name(void);                                                   \
+    static struct myassert_test myassert_test_##name =                       \
+        {#name, name, NULL, NULL, __FILE__, __LINE__, ms, NULL, NULL, NULL}; \
+    MYASSERT_ATTR((constructor))                                             \
+    static void myassert_register_##name(void)                               \
+    {                                                                        \
+        myassert_register(&myassert_test_##name);                            \
+    }                                                                        \
+    static int name(void)
+
+// Declares the files a test reads, and with a leading '$' the environment
+// variables it depends on, for the result cache. Goes after the test.
+#define TEST_INPUTS(name, ...)                                        \
+    static const char *const myassert_inputs_##name[] =               \
+        {__VA_ARGS__, NULL};                                          \
+    MYASSERT_ATTR((constructor))                                      \
+    static void myassert_register_inputs_##name(void)                 \
+    {                                                                 \
+        myassert_test_##name.inputs = myassert_inputs_##name;         \
+    }
+
+// Each worker owns a contiguous range [head, tail) of the test order and
+// pops from the front. When it runs dry it steals the back half of another
+// worker's range, so neighbouring tests tend to stay on the same core.
+struct myassert_worker
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+    size_t id;
+    struct myassert_pool *pool;
+    pid_t zygote;
+    int request_fd;
+    int reply_fd;
+};
+
+struct myassert_pool
+{
+    struct myassert_test **tests;
+    struct myassert_result *results;
+    struct myassert_detail *details;
+    struct myassert_worker *workers;
+    size_t count;
+    size_t nworkers;
+    bool isolate;
+    // Zygotes are also started when several workers run TEST_F tests, so
+    // their copy-on-write children are not forked from a threaded process.
+    bool zygotes;
+    uint64_t *keys;
+};
+
+static inline bool myassert_worker_pop(struct myassert_worker *worker,
+                                       size_t *index)
+{
+    bool found = false;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->head < worker->tail)
+    {
+        *index = worker->head++;
+        found = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+static inline bool myassert_worker_steal(struct myassert_worker *worker,
+                                         size_t *index)
+{
+    struct myassert_pool *pool = worker->pool;
+    for (size_t i = 1; i < pool->nworkers; i++)
+    {
+        struct myassert_worker *victim =
+            &pool->workers[(worker->id + i) % pool->nworkers];
+        size_t begin = 0;
+        size_t end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->head < victim->tail)
+        {
+            size_t take = (victim->tail - victim->head + 1) / 2;
+            end = victim->tail;
+            begin = end - take;
+            victim->tail = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (begin < end)
+        {
+            pthread_mutex_lock(&worker->lock);
+            worker->head = begin + 1;
+            worker->tail = end;
+            pthread_mutex_unlock(&worker->lock);
+            *index = begin;
+            return true;
+        }
+    }
+    return false;
+}
+
+// =============================================================
+// RESULT CACHE
+// =============================================================
+
+// With MYASSERT_CACHE=path, myassert_run_all() skips every test that
+// passed in an earlier run with the same key and reports it as CACHED.
+// The key hashes the build ID of the program, or the whole executable
+// when it has none, the test's file and name, and the contents of the
+// inputs declared with TEST_INPUTS. The cache file holds the sorted keys
+// of the tests that passed, is mapped with a single mmap(2) and searched
+// by bisection. Like the snapshot store, it uses the byte order of the
+// machine that wrote it.
+
+#define MYASSERT_CACHE_MAGIC "MYCACH1\n"
+#define MYASSERT_CACHE_HEADER 16
+
+static inline uint64_t myassert_fnv(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ p[i]) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+// Hashes the contents of a file, or returns false when it cannot be read.
+static inline bool myassert_fnv_file(uint64_t *hash, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    char data[65536];
+    ssize_t n;
+    while ((n = read(fd, data, sizeof(data))) != 0)
+    {
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            close(fd);
+            return false;
+        }
+        *hash = myassert_fnv(*hash, data, (size_t)n);
+    }
+    close(fd);
+    return true;
+}
+
+#ifdef __ELF__
+struct myassert_build_id
+{
+    const unsigned char *data;
+    size_t len;
+};
+
+// The first object reported is the program itself.
+static int myassert_find_build_id(struct dl_phdr_info *info, size_t size, void *arg)
+{
+    struct myassert_build_id *id = (struct myassert_build_id *)arg;
+    (void)size;
+    for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type != PT_NOTE)
+        {
+            continue;
+        }
+        size_t align = phdr->p_align == 8 ? 8 : 4;
+        const unsigned char *notes = (const unsigned char *)(info->dlpi_addr + phdr->p_vaddr);
+        size_t at = 0;
+        while (phdr->p_memsz - at >= sizeof(ElfW(Nhdr)))
+        {
+            const ElfW(Nhdr) *note = (const ElfW(Nhdr) *)(notes + at);
+            size_t name = at + sizeof(*note);
+            size_t desc = name + ((note->n_namesz + align - 1) & ~(align - 1));
+            size_t next = desc + ((note->n_descsz + align - 1) & ~(align - 1));
+            if (next > phdr->p_memsz)
+            {
+                break;
+            }
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+                memcmp(notes + name, "GNU", 4) == 0)
+            {
+                id->data = notes + desc;
+                id->len = note->n_descsz;
+                return 1;
+            }
+            at = next;
+        }
+    }
+    return 1;
+}
+#endif
+
+static inline bool myassert_program_hash(uint64_t *hash)
+{
+#ifdef __ELF__
+    struct myassert_build_id id = {NULL, 0};
+    dl_iterate_phdr(myassert_find_build_id, &id);
+    if (id.len > 0)
+    {
+        *hash = myassert_fnv(*hash, id.data, id.len);
+        return true;
+    }
+#endif
+    return myassert_fnv_file(hash, "/proc/self/exe");
+}
+
+static inline uint64_t myassert_cache_key(uint64_t program, const struct myassert_test *test)
+{
+    uint64_t hash = myassert_fnv(program, test->file, strlen(test->file) + 1);
+    hash = myassert_fnv(hash, test->name, strlen(test->name) + 1);
+    for (const char *const *input = test->inputs; input != NULL && *input != NULL; input++)
+    {
+        hash = myassert_fnv(hash, *input, strlen(*input) + 1);
+        const char *value = (*input)[0] == '$' ? getenv(*input + 1) : NULL;
+        bool found = value != NULL;
+        if (found)
+        {
+            hash = myassert_fnv(hash, value, strlen(value));
+        }
+        else if ((*input)[0] != '$')
+        {
+            found = myassert_fnv_file(&hash, *input);
+        }
+        hash = myassert_fnv(hash, &found, sizeof(found));
+    }
+    return hash;
+}
+
+static inline bool myassert_cache_find(const uint64_t *keys, uint64_t count, uint64_t key)
+{
+    uint64_t low = 0;
+    uint64_t high = count;
+    while (low < high)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        if (keys[mid] < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low < count && keys[low] == key;
+}
+
+// Computes the key of every test and marks the ones found in the cache.
+// A missing cache is empty; a damaged one is reported and ignored.
+static inline void myassert_cache_load(struct myassert_pool *pool, const char *path)
+{
+    uint64_t program = 0xcbf29ce484222325u;
+    if (!myassert_program_hash(&program))
+    {
+        fprintf(stderr, "myassert: cannot identify the program, result cache disabled\n");
+        return;
+    }
+    pool->keys = (uint64_t *)calloc(pool->count + 1, sizeof(*pool->keys));
+    if (pool->keys == NULL)
+    {
+        FATAL("out of memory");
+    }
+    for (size_t i = 0; i < pool->count; i++)
+    {
+        pool->keys[i] = myassert_cache_key(program, pool->tests[i]);
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= MYASSERT_CACHE_HEADER)
+    {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return;
+    }
+
+    const unsigned char *data = (const unsigned char *)map;
+    uint64_t count;
+    memcpy(&count, data + 8, sizeof(count));
+    if (memcmp(data, MYASSERT_CACHE_MAGIC, 8) != 0 ||
+        count != ((size_t)st.st_size - MYASSERT_CACHE_HEADER) / sizeof(uint64_t))
+    {
+        fprintf(stderr, "myassert: ignoring damaged result cache %s\n", path);
+        count = 0;
+    }
+    const uint64_t *keys = (const uint64_t *)(data + MYASSERT_CACHE_HEADER);
+    for (size_t i = 0; i < pool->count; i++)
+    {
+        if (myassert_cache_find(keys, count, pool->keys[i]))
+        {
+            pool->results[i].test = pool->tests[i];
+            pool->results[i].status = TEST_CACHED;
+        }
+    }
+    munmap(map, (size_t)st.st_size);
+}
+
+static inline int myassert_compare_keys(const void *lhs, const void *rhs)
+{
+    uint64_t a = *(const uint64_t *)lhs;
+    uint64_t b = *(const uint64_t *)rhs;
+    return (a > b) - (a < b);
+}
+
+// Replaces the cache with the keys of the tests that passed or were
+// cached in this run, so keys of changed tests drop out.
+static inline void myassert_cache_save(const struct myassert_pool *pool, const char *path)
+{
+    if (pool->keys == NULL)
+    {
+        return;
+    }
+    uint64_t *keys = (uint64_t *)malloc(pool->count * sizeof(*keys) + MYASSERT_CACHE_HEADER);
+    if (keys == NULL)
+    {
+        FATAL("out of memory");
+    }
+    uint64_t count = 0;
+    for (size_t i = 0; i < pool->count; i++)
+    {
+        int status = pool->results[i].status;
+        if (status == TEST_OK || status == TEST_CACHED)
+        {
+            keys[2 + count++] = pool->keys[i];
+        }
+    }
+    qsort(keys + 2, count, sizeof(*keys), myassert_compare_keys);
+    uint64_t unique = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (unique == 0 || keys[2 + i] != keys[2 + unique - 1])
+        {
+            keys[2 + unique++] = keys[2 + i];
+        }
+    }
+    memcpy(keys, MYASSERT_CACHE_MAGIC, 8);
+    keys[1] = unique;
+
+    // Written next to the cache and renamed over it, so a reader never
+    // sees a partial file.
+    char temp[4096];
+    snprintf(temp, sizeof(temp), "%s.%ld", path, (long)getpid());
+    FILE *file = fopen(temp, "wb");
+    bool written = file != NULL && fwrite(keys, sizeof(*keys), 2 + unique, file) == 2 + unique;
+    if (file != NULL)
+    {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written || rename(temp, path) != 0)
+    {
+        fprintf(stderr, "myassert: cannot write result cache %s: %s\n", path, strerror(errno));
+        unlink(temp);
+    }
+    free(keys);
+}
+
+// =============================================================
+// FORK ISOLATION
+// =============================================================
+
+static inline bool myassert_read_full(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0)
+    {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static inline bool myassert_write_full(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Waits for a test process and kills it once it runs past its timeout.
+// SIGCHLD is blocked in the zygote, so it stays pending until waited for.
+static inline int myassert_wait_test(pid_t child, uint64_t timeout_ms, bool *timed_out)
+{
+    int wstatus = 0;
+    uint64_t deadline = myassert_now_ns() + timeout_ms * 1000000u;
+    while (timeout_ms != 0)
+    {
+        pid_t done = waitpid(child, &wstatus, WNOHANG);
+        if (done != 0)
+        {
+            return done < 0 ? -1 : wstatus;
+        }
+        uint64_t now = myassert_now_ns();
+        if (now >= deadline)
+        {
+            kill(child, SIGKILL);
+            *timed_out = true;
+            break;
+        }
+        uint64_t wait_ns = deadline - now;
+#if defined(_POSIX_REALTIME_SIGNALS) && _POSIX_REALTIME_SIGNALS > 0
+        sigset_t chld;
+        sigemptyset(&chld);
+        sigaddset(&chld, SIGCHLD);
+        struct timespec ts = {(time_t)(wait_ns / 1000000000u), (long)(wait_ns % 1000000000u)};
+        sigtimedwait(&chld, NULL, &ts);
+#else
+        struct timespec ts = {0, (long)(wait_ns < 1000000u ? wait_ns : 1000000u)};
+        nanosleep(&ts, NULL);
+#endif
+    }
+    return waitpid(child, &wstatus, 0) < 0 ? -1 : wstatus;
+}
+
+// The zygote is forked once per worker after the suite is initialized and
+// before any worker thread exists. For each requested test it forks a
+// single-threaded copy of itself, which is far cheaper than spawning a
+// fresh process, runs the test there and replies with the wait status and
+// whether the test timed out.
+MYASSERT_ATTR((noreturn))
+static inline void myassert_zygote_main(struct myassert_pool *pool,
+                                        int request_fd, int reply_fd)
+{
+    struct rlimit no_core = {0, 0};
+    size_t index;
+    sigset_t chld;
+    sigset_t mask;
+
+    setrlimit(RLIMIT_CORE, &no_core);
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, &mask);
+    while (myassert_read_full(request_fd, &index, sizeof(index)))
+    {
+        int reply[2] = {-1, 0};
+        bool timed_out = false;
+        pid_t child = fork();
+        if (child == 0)
+        {
+            close(request_fd);
+            close(reply_fd);
+            sigprocmask(SIG_SETMASK, &mask, NULL);
+            myassert_isolated = true;
+            myassert_execute(pool->tests[index], &pool->results[index]);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(pool->results[index].status & 0xff);
+        }
+        if (child > 0)
+        {
+            reply[0] = myassert_wait_test(child, myassert_timeout(pool->tests[index]), &timed_out);
+            reply[1] = timed_out;
+        }
+        if (!myassert_write_full(reply_fd, reply, sizeof(reply)))
+        {
+            break;
+        }
+    }
+    _exit(0);
+}
+
+static inline void myassert_zygote_start(struct myassert_worker *worker)
+{
+    int request[2];
+    int reply[2];
+
+    if (pipe(request) != 0 || pipe(reply) != 0)
+    {
+        FATAL("pipe failed");
+    }
+    fflush(stdout);
+    fflush(stderr);
+
+    worker->zygote = fork();
+    if (worker->zygote < 0)
+    {
+        FATAL("fork failed");
+    }
+    if (worker->zygote == 0)
+    {
+        // Drop the pipes of zygotes started earlier, or they would never
+        // see EOF when the runner shuts them down.
+        for (size_t i = 0; i < worker->id; i++)
+        {
+            close(worker->pool->workers[i].request_fd);
+            close(worker->pool->workers[i].reply_fd);
+        }
+        close(request[1]);
+        close(reply[0]);
+        myassert_zygote_main(worker->pool, request[0], reply[1]);
+    }
+    close(request[0]);
+    close(reply[1]);
+    worker->request_fd = request[1];
+    worker->reply_fd = reply[0];
+}
+
+static inline void myassert_zygote_stop(struct myassert_worker *worker)
+{
+    close(worker->request_fd);
+    close(worker->reply_fd);
+    waitpid(worker->zygote, NULL, 0);
+}
+
+static inline void myassert_execute_isolated(struct myassert_worker *worker,
+                                             size_t index)
+{
+    struct myassert_result *result = &worker->pool->results[index];
+    struct myassert_sample before;
+    struct myassert_sample after;
+    int reply[2];
+
+    result->test = worker->pool->tests[index];
+    myassert_sample(&before);
+    if (!myassert_write_full(worker->request_fd, &index, sizeof(index)) ||
+        !myassert_read_full(worker->reply_fd, reply, sizeof(reply)))
+    {
+        FATAL("test zygote exited unexpectedly");
+    }
+
+    int wstatus = reply[0];
+    result->done = true;
+    if (wstatus != -1 && WIFEXITED(wstatus) && !reply[1])
+    {
+        result->status = WEXITSTATUS(wstatus);
+    }
+    else
+    {
+        // The child died before recording its metrics; keep at least the
+        // wall time seen from here.
+        myassert_sample(&after);
+        result->metrics.wall_ms =
+            (double)(after.wall.tv_sec - before.wall.tv_sec) * 1e3 +
+            (double)(after.wall.tv_nsec - before.wall.tv_nsec) / 1e6;
+        result->status = reply[1] ? TEST_TIMEOUT : TEST_FAIL;
+        result->signal = wstatus != -1 && WIFSIGNALED(wstatus) && !reply[1] ? WTERMSIG(wstatus) : 0;
+        if (reply[1])
+        {
+            myassert_report_timeout(result, myassert_timeout(result->test));
+        }
+    }
+}
+
+static inline void *myassert_worker_main(void *arg)
+{
+    struct myassert_worker *worker = (struct myassert_worker *)arg;
+    struct myassert_pool *pool = worker->pool;
+    size_t index;
+
+    while (myassert_worker_pop(worker, &index) ||
+           myassert_worker_steal(worker, &index))
+    {
+        if (pool->results[index].status == TEST_CACHED)
+        {
+            continue;
+        }
+        if (pool->isolate || (pool->zygotes && pool->tests[index]->fixture != NULL))
+        {
+            myassert_execute_isolated(worker, index);
+        }
+        else
+        {
+            myassert_execute(pool->tests[index], &pool->results[index]);
+        }
+    }
+    return NULL;
+}
+
+static inline int myassert_compare_tests(const void *lhs, const void *rhs)
+{
+    const struct myassert_test *a = *(struct myassert_test *const *)lhs;
+    const struct myassert_test *b = *(struct myassert_test *const *)rhs;
+    int cmp = strcmp(a->file, b->file);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (a->line > b->line) - (a->line < b->line);
+}
+
+static inline size_t myassert_jobs(size_t count)
+{
+    const char *env = getenv("MYASSERT_JOBS");
+    long jobs = env != NULL ? strtol(env, NULL, 10) : 0;
+    if (jobs <= 0)
+    {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs <= 0)
+    {
+        jobs = 1;
+    }
+    return (size_t)jobs < count ? (size_t)jobs : count;
+}
+
+static inline void myassert_pool_init(struct myassert_pool *pool)
+{
+    memset(pool, 0, sizeof(*pool));
+    for (struct myassert_test *t = myassert_tests; t != NULL; t = t->next)
+    {
+        pool->count++;
+    }
+
+    pool->tests = (struct myassert_test **)calloc(pool->count + 1, sizeof(*pool->tests));
+    if (pool->tests == NULL)
+    {
+        FATAL("out of memory");
+    }
+
+    size_t n = 0;
+    for (struct myassert_test *t = myassert_tests; t != NULL; t = t->next)
+    {
+        pool->tests[n++] = t;
+    }
+    qsort(pool->tests, pool->count, sizeof(*pool->tests), myassert_compare_tests);
+
+    // Isolated tests write their results from the forked child, so the
+    // table has to live in memory shared with it.
+    pool->isolate = myassert_env_flag("MYASSERT_ISOLATE");
+    pool->nworkers = myassert_jobs(pool->count);
+    pool->zygotes = pool->isolate;
+    for (size_t i = 0; i < pool->count && pool->nworkers > 1; i++)
+    {
+        pool->zygotes = pool->zygotes || pool->tests[i]->fixture != NULL;
+    }
+    if (pool->zygotes)
+    {
+        void *shared = mmap(NULL, (pool->count + 1) * sizeof(*pool->results),
+                            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        pool->results = shared != MAP_FAILED ? (struct myassert_result *)shared : NULL;
+    }
+    else
+    {
+        pool->results = (struct myassert_result *)calloc(pool->count + 1, sizeof(*pool->results));
+    }
+    if (pool->results == NULL)
+    {
+        FATAL("out of memory");
+    }
+    if (myassert_reporting())
+    {
+        size_t size = (pool->count + 1) * sizeof(*pool->details);
+        if (pool->zygotes)
+        {
+            void *shared = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            pool->details = shared != MAP_FAILED ? (struct myassert_detail *)shared : NULL;
+        }
+        else
+        {
+            pool->details =
+                (struct myassert_detail *)calloc(pool->count + 1, sizeof(*pool->details));
+        }
+        if (pool->details == NULL)
+        {
+            FATAL("out of memory");
+        }
+        for (size_t i = 0; i < pool->count; i++)
+        {
+            pool->results[i].detail = &pool->details[i];
+        }
+    }
+
+    pool->workers = (struct myassert_worker *)calloc(pool->nworkers + 1, sizeof(*pool->workers));
+    if (pool->workers == NULL)
+    {
+        FATAL("out of memory");
+    }
+    for (size_t i = 0; i < pool->nworkers; i++)
+    {
+        struct myassert_worker *worker = &pool->workers[i];
+        worker->id = i;
+        worker->pool = pool;
+        worker->head = pool->count * i / pool->nworkers;
+        worker->tail = pool->count * (i + 1) / pool->nworkers;
+        pthread_mutex_init(&worker->lock, NULL);
+    }
+
+    const char *cache = getenv("MYASSERT_CACHE");
+    if (cache != NULL && cache[0] != '\0')
+    {
+        myassert_cache_load(pool, cache);
+    }
+}
+
+static inline void myassert_pool_run(struct myassert_pool *pool)
+{
+    myassert_abort_reserve(pool->count);
+    myassert_active_results = pool->results;
+    myassert_active_count = pool->count;
+
+    // Zygotes must be forked while this process is still single-threaded.
+    // Fixtures of the tests to run are built first, so every test process
+    // inherits them.
+    if (pool->zygotes)
+    {
+        for (size_t i = 0; i < pool->count; i++)
+        {
+            if (pool->tests[i]->fixture != NULL && pool->results[i].status != TEST_CACHED)
+            {
+                myassert_fixture_get(pool->tests[i]->fixture);
+            }
+        }
+        for (size_t i = 0; i < pool->nworkers; i++)
+        {
+            myassert_zygote_start(&pool->workers[i]);
+        }
+    }
+
+    if (pool->nworkers == 1)
+    {
+        myassert_worker_main(&pool->workers[0]);
+    }
+    else
+    {
+        for (size_t i = 0; i < pool->nworkers; i++)
+        {
+            if (pthread_create(&pool->workers[i].thread, NULL,
+                               myassert_worker_main, &pool->workers[i]) != 0)
+            {
+                FATAL("pthread_create failed");
+            }
+        }
+        for (size_t i = 0; i < pool->nworkers; i++)
+        {
+            pthread_join(pool->workers[i].thread, NULL);
+        }
+    }
+
+    if (pool->zygotes)
+    {
+        for (size_t i = 0; i < pool->nworkers; i++)
+        {
+            myassert_zygote_stop(&pool->workers[i]);
+        }
+    }
+}
+
+static inline size_t myassert_pool_report(const struct myassert_pool *pool)
+{
+    size_t passed = 0;
+    size_t cached = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+    bool quiet = myassert_report_quiet();
+    if (!quiet)
+    {
+        myassert_progress_start();
+    }
+
+    for (size_t i = 0; i < pool->count; i++)
+    {
+        const struct myassert_result *result = &pool->results[i];
+        if (!quiet)
+        {
+            myassert_progress_put("Running ");
+            myassert_progress_put(pool->tests[i]->name);
+            myassert_progress_put("... ");
+            myassert_progress_put(myassert_status_name(result->status));
+            if (result->signal != 0)
+            {
+                myassert_progress_put(" (");
+                myassert_progress_put(strsignal(result->signal));
+                myassert_progress_put(")");
+            }
+            myassert_progress_put("\n");
+        }
+
+        if (result->status == TEST_OK)
+        {
+            passed++;
+        }
+        else if (result->status == TEST_CACHED)
+        {
+            cached++;
+        }
+        else if (result->status == TEST_SKIP)
+        {
+            skipped++;
+        }
+        else
+        {
+            failed++;
+        }
+    }
+    myassert_out_flush(&myassert_progress);
+    if (!quiet && pool->keys != NULL)
+    {
+        printf("%zu tests: %zu passed, %zu cached, %zu skipped, %zu failed\n",
+               pool->count, passed, cached, skipped, failed);
+    }
+    else if (!quiet)
+    {
+        printf("%zu tests: %zu passed, %zu skipped, %zu failed\n",
+               pool->count, passed, skipped, failed);
+    }
+    fflush(stdout);
+    myassert_report_slowest(pool->results, pool->count);
+    myassert_report_results(pool->results, pool->count);
+    return failed;
+}
+
+static inline void myassert_pool_free(struct myassert_pool *pool)
+{
+    myassert_active_results = NULL;
+    myassert_active_count = 0;
+    myassert_abort_release();
+    for (size_t i = 0; i < pool->nworkers; i++)
+    {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    }
+    if (pool->zygotes)
+    {
+        munmap(pool->results, (pool->count + 1) * sizeof(*pool->results));
+        if (pool->details != NULL)
+        {
+            munmap(pool->details, (pool->count + 1) * sizeof(*pool->details));
+        }
+    }
+    else
+    {
+        free(pool->results);
+        free(pool->details);
+    }
+    free(pool->workers);
+    free(pool->tests);
+    free(pool->keys);
+}
+
+// Runs every TEST() on a pool of MYASSERT_JOBS workers (default: one per
+// online CPU) and prints the results in file/line order. With
+// MYASSERT_ISOLATE=1 each test runs in its own forked process, so a failed
+// assertion is reported as FAILED instead of ending the run. Returns
+// EXIT_SUCCESS when no test failed, so it can be returned from main().
+static inline int myassert_run_all(void)
+{
+    struct myassert_pool pool;
+
+    __atomic_store_n(&myassert_runner_active, true, __ATOMIC_RELAXED);
+    myassert_pool_init(&pool);
+    myassert_pool_run(&pool);
+    size_t failed = myassert_pool_report(&pool);
+    const char *cache = getenv("MYASSERT_CACHE");
+    if (cache != NULL && cache[0] != '\0')
+    {
+        myassert_cache_save(&pool, cache);
+    }
+    myassert_pool_free(&pool);
+    myassert_snapshot_merge();
+    if (myassert_env_flag("MYASSERT_SITES"))
+    {
+        myassert_dump_sites();
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
+
+// =============================================================
+// REPORTERS
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+// With MYASSERT_REPORT set to a comma separated list of format:path
+// entries, for example junit:report.xml,jsonl:report.jsonl, the results
+// of a run are also written in each format once it ends. An entry
+// without a path writes to stdout, and the runner then prints nothing
+// else there. Each report goes through a buffer of MYASSERT_REPORT_BUFFER
+// bytes, so a large suite takes few writes.
+
+enum myassert_escape
+{
+    MYASSERT_ESCAPE_XML,
+    MYASSERT_ESCAPE_JSON,
+    MYASSERT_ESCAPE_YAML,
+    MYASSERT_ESCAPE_BLOCK
+};
+
+// Writes text quoted for a format. YAML text is either single quoted or
+// a block scalar indented by four spaces.
+static inline void myassert_report_escaped(struct myassert_out *out,
+                                           const char *s, size_t len, int escape)
+{
+    for (size_t i = 0; i < len && s[i] != '\0'; i++)
+    {
+        unsigned char c = (unsigned char)s[i];
+        if (escape == MYASSERT_ESCAPE_XML)
+        {
+            switch (c)
+            {
+            case '&':
+                myassert_out_str(out, "&amp;");
+                break;
+            case '<':
+                myassert_out_str(out, "&lt;");
+                break;
+            case '>':
+                myassert_out_str(out, "&gt;");
+                break;
+            case '"':
+                myassert_out_str(out, "&quot;");
+                break;
+            case '\n':
+                myassert_out_str(out, "&#10;");
+                break;
+            case '\t':
+                myassert_out_str(out, "&#9;");
+                break;
+            default:
+                // XML 1.0 cannot represent other control characters.
+                myassert_out_char(out, c < 0x20 ? '?' : c);
+                break;
+            }
+        }
+        else if (escape == MYASSERT_ESCAPE_JSON)
+        {
+            if (c == '"' || c == '\\')
+            {
+                myassert_out_char(out, '\\');
+                myassert_out_char(out, c);
+            }
+            else if (c == '\n')
+            {
+                myassert_out_str(out, "\\n");
+            }
+            else if (c < 0x20)
+            {
+                myassert_out_str(out, "\\u00");
+                myassert_out_char(out, "0123456789abcdef"[c >> 4]);
+                myassert_out_char(out, "0123456789abcdef"[c & 0xf]);
+            }
+            else
+            {
+                myassert_out_char(out, c);
+            }
+        }
+        else if (c == '\n')
+        {
+            myassert_out_str(out, escape == MYASSERT_ESCAPE_BLOCK ? "\n    " : " ");
+        }
+        else
+        {
+            if (c == '\'' && escape == MYASSERT_ESCAPE_YAML)
+            {
+                myassert_out_char(out, '\'');
+            }
+            myassert_out_char(out, c);
+        }
+    }
+}
+
+static inline void myassert_report_str(struct myassert_out *out, const char *s, int escape)
+{
+    myassert_report_escaped(out, s, strlen(s), escape);
+}
+
+static inline void myassert_report_buf(struct myassert_out *out,
+                                       const struct myassert_buf *buf, int escape)
+{
+    myassert_report_escaped(out, buf->data, buf->len, escape);
+}
+
+// strsignal() may allocate, so reports describe the common signals
+// themselves, in glibc's words.
+static inline void myassert_put_signal(struct myassert_buf *buf, int signo)
+{
+    static const struct
+    {
+        int signo;
+        const char *text;
+    } names[] = {
+        {SIGABRT, "Aborted"},
+        {SIGALRM, "Alarm clock"},
+        {SIGBUS, "Bus error"},
+        {SIGFPE, "Floating point exception"},
+        {SIGHUP, "Hangup"},
+        {SIGILL, "Illegal instruction"},
+        {SIGINT, "Interrupt"},
+        {SIGKILL, "Killed"},
+        {SIGPIPE, "Broken pipe"},
+        {SIGQUIT, "Quit"},
+        {SIGSEGV, "Segmentation fault"},
+        {SIGSYS, "Bad system call"},
+        {SIGTERM, "Terminated"},
+        {SIGTRAP, "Trace/breakpoint trap"},
+        {SIGUSR1, "User defined signal 1"},
+        {SIGUSR2, "User defined signal 2"},
+        {SIGXCPU, "CPU time limit exceeded"},
+        {SIGXFSZ, "File size limit exceeded"},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (names[i].signo == signo)
+        {
+            myassert_put_str(buf, names[i].text);
+            return;
+        }
+    }
+    myassert_put_str(buf, "Signal ");
+    myassert_put_int(buf, signo);
+}
+
+// Why a test did not pass: its first failed check, the message it left,
+// or how its process ended.
+static inline void myassert_put_outcome(struct myassert_buf *buf,
+                                        const struct myassert_result *result)
+{
+    const struct myassert_detail *detail = result->detail;
+    if (detail != NULL && detail->what != NULL)
+    {
+        myassert_format_failure(buf, detail->what, &detail->failure);
+    }
+    else if (detail != NULL && detail->message[0] != '\0')
+    {
+        myassert_put_str(buf, detail->message);
+    }
+    else if (result->signal != 0)
+    {
+        myassert_put_str(buf, "Killed by signal: ");
+        myassert_put_signal(buf, result->signal);
+    }
+    else
+    {
+        myassert_put_str(buf, result->test->name);
+        myassert_put_str(buf, " failed");
+    }
+}
+
+static inline bool myassert_passed(const struct myassert_result *result)
+{
+    return result->status == TEST_OK || result->status == TEST_CACHED;
+}
+
+struct myassert_reporter
+{
+    const char *name;
+    void (*begin)(struct myassert_out *out, const struct myassert_result *results, size_t count);
+    void (*test)(struct myassert_out *out, const struct myassert_result *result, size_t number);
+    void (*end)(struct myassert_out *out, const struct myassert_result *results, size_t count);
+};
+
+// JUnit XML, one testsuite with a testcase per test. The classname is the
+// file of the test.
+static inline void myassert_junit_begin(struct myassert_out *out,
+                                        const struct myassert_result *results, size_t count)
+{
+    size_t skipped = 0;
+    size_t failed = 0;
+    double ms = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        skipped += results[i].status == TEST_SKIP;
+        failed += !myassert_passed(&results[i]) && results[i].status != TEST_SKIP;
+        ms += results[i].metrics.wall_ms;
+    }
+    myassert_out_str(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    for (int suite = 0; suite < 2; suite++)
+    {
+        myassert_out_str(out, suite == 0 ? "<testsuites tests=\""
+                                         : "  <testsuite name=\"myassert\" tests=\"");
+        myassert_out_uint(out, count);
+        myassert_out_str(out, "\" failures=\"");
+        myassert_out_uint(out, failed);
+        myassert_out_str(out, suite == 0 ? "\" skipped=\"" : "\" errors=\"0\" skipped=\"");
+        myassert_out_uint(out, skipped);
+        myassert_out_str(out, "\" time=\"");
+        myassert_out_fixed(out, ms / 1e3, 6);
+        myassert_out_str(out, "\">\n");
+    }
+}
+
+static inline void myassert_junit_test(struct myassert_out *out,
+                                       const struct myassert_result *result, size_t number)
+{
+    const struct myassert_test *test = result->test;
+    (void)number;
+    myassert_out_str(out, "    <testcase name=\"");
+    myassert_report_str(out, test->name, MYASSERT_ESCAPE_XML);
+    myassert_out_str(out, "\" classname=\"");
+    myassert_report_str(out, test->file, MYASSERT_ESCAPE_XML);
+    myassert_out_str(out, "\" file=\"");
+    myassert_report_str(out, test->file, MYASSERT_ESCAPE_XML);
+    myassert_out_str(out, "\" line=\"");
+    myassert_out_int(out, test->line);
+    myassert_out_str(out, "\" time=\"");
+    myassert_out_fixed(out, result->metrics.wall_ms / 1e3, 6);
+    myassert_out_str(out, "\"");
+    if (myassert_passed(result))
+    {
+        myassert_out_str(out, "/>\n");
+        return;
+    }
+
+    char data[MYASSERT_MESSAGE_SIZE];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+    myassert_put_outcome(&buf, result);
+    if (result->status == TEST_SKIP)
+    {
+        myassert_out_str(out, ">\n      <skipped message=\"");
+        myassert_report_buf(out, &buf, MYASSERT_ESCAPE_XML);
+        myassert_out_str(out, "\"/>\n    </testcase>\n");
+        return;
+    }
+
+    const struct myassert_detail *detail = result->detail;
+    const char *type = detail != NULL && detail->what != NULL ? detail->what
+                       : result->status == TEST_TIMEOUT       ? "Timeout"
+                       : result->signal != 0                  ? "Signal"
+                                                              : "Failure";
+    const char *newline = (const char *)memchr(data, '\n', buf.len);
+    myassert_out_str(out, ">\n      <failure message=\"");
+    myassert_report_escaped(out, data, newline != NULL ? (size_t)(newline - data) : buf.len,
+                            MYASSERT_ESCAPE_XML);
+    myassert_out_str(out, "\" type=\"");
+    myassert_out_str(out, type);
+    myassert_out_str(out, "\">");
+    myassert_report_buf(out, &buf, MYASSERT_ESCAPE_XML);
+    myassert_out_str(out, "</failure>\n    </testcase>\n");
+}
+
+static inline void myassert_junit_end(struct myassert_out *out,
+                                      const struct myassert_result *results, size_t count)
+{
+    (void)results;
+    (void)count;
+    myassert_out_str(out, "  </testsuite>\n</testsuites>\n");
+}
+
+// TAP version 13. A test that did not pass is followed by a YAML block
+// with where and why it failed.
+static inline void myassert_tap_begin(struct myassert_out *out,
+                                      const struct myassert_result *results, size_t count)
+{
+    (void)results;
+    myassert_out_str(out, "TAP version 13\n1..");
+    myassert_out_uint(out, count);
+    myassert_out_str(out, "\n");
+}
+
+static inline void myassert_tap_test(struct myassert_out *out,
+                                     const struct myassert_result *result, size_t number)
+{
+    const struct myassert_test *test = result->test;
+    char data[MYASSERT_MESSAGE_SIZE];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+
+    bool ok = myassert_passed(result) || result->status == TEST_SKIP;
+    myassert_out_str(out, ok ? "ok " : "not ok ");
+    myassert_out_uint(out, number);
+    myassert_out_str(out, " - ");
+    myassert_out_str(out, test->name);
+    if (result->status == TEST_CACHED)
+    {
+        myassert_out_str(out, " (cached)");
+    }
+    if (result->status == TEST_SKIP)
+    {
+        myassert_put_outcome(&buf, result);
+        myassert_out_str(out, " # SKIP ");
+        myassert_report_buf(out, &buf, MYASSERT_ESCAPE_YAML);
+    }
+    myassert_out_char(out, '\n');
+    if (ok)
+    {
+        return;
+    }
+
+    myassert_put_outcome(&buf, result);
+    myassert_out_str(out, "  ---\n  file: '");
+    myassert_report_str(out, test->file, MYASSERT_ESCAPE_YAML);
+    myassert_out_str(out, "'\n  line: ");
+    myassert_out_int(out, test->line);
+    myassert_out_str(out, "\n  status: ");
+    myassert_out_str(out, myassert_status_name(result->status));
+    myassert_out_str(out, "\n  duration_ms: ");
+    myassert_out_fixed(out, result->metrics.wall_ms, 3);
+    myassert_out_str(out, "\n");
+    const struct myassert_detail *detail = result->detail;
+    if (detail != NULL && detail->what != NULL)
+    {
+        const struct myassert_failure *failure = &detail->failure;
+        char text[MYASSERT_MESSAGE_SIZE];
+        struct myassert_buf part = {text, 0, sizeof(text)};
+        myassert_out_str(out, "  at:\n    file: '");
+        myassert_report_str(out, failure->site->file, MYASSERT_ESCAPE_YAML);
+        myassert_out_str(out, "'\n    line: ");
+        myassert_out_int(out, failure->site->line);
+        myassert_out_str(out, "\n  expression: '");
+        myassert_put_expression(&part, failure->site);
+        myassert_report_buf(out, &part, MYASSERT_ESCAPE_YAML);
+        part.len = 0;
+        myassert_put_operands(&part, failure);
+        if (part.len > 0)
+        {
+            myassert_out_str(out, "'\n  values: '");
+            myassert_report_buf(out, &part, MYASSERT_ESCAPE_YAML);
+        }
+        myassert_out_str(out, "'\n");
+    }
+    myassert_out_str(out, "  message: |\n    ");
+    myassert_report_buf(out, &buf, MYASSERT_ESCAPE_BLOCK);
+    myassert_out_str(out, "\n  ...\n");
+}
+
+// JSON Lines, one object per test.
+static inline void myassert_jsonl_test(struct myassert_out *out,
+                                       const struct myassert_result *result, size_t number)
+{
+    const struct myassert_test *test = result->test;
+    (void)number;
+    myassert_out_str(out, "{\"name\":\"");
+    myassert_report_str(out, test->name, MYASSERT_ESCAPE_JSON);
+    myassert_out_str(out, "\",\"file\":\"");
+    myassert_report_str(out, test->file, MYASSERT_ESCAPE_JSON);
+    myassert_out_str(out, "\",\"line\":");
+    myassert_out_int(out, test->line);
+    myassert_out_str(out, ",\"status\":\"");
+    myassert_out_str(out, myassert_status_name(result->status));
+    myassert_out_str(out, "\",\"duration_ms\":");
+    myassert_out_fixed(out, result->metrics.wall_ms, 6);
+    if (myassert_passed(result))
+    {
+        myassert_out_str(out, "}\n");
+        return;
+    }
+
+    const struct myassert_detail *detail = result->detail;
+    if (detail != NULL && detail->what != NULL)
+    {
+        const struct myassert_failure *failure = &detail->failure;
+        char text[MYASSERT_MESSAGE_SIZE];
+        struct myassert_buf part = {text, 0, sizeof(text)};
+        myassert_out_str(out, ",\"failure\":{\"what\":\"");
+        myassert_out_str(out, detail->what);
+        myassert_out_str(out, "\",\"file\":\"");
+        myassert_report_str(out, failure->site->file, MYASSERT_ESCAPE_JSON);
+        myassert_out_str(out, "\",\"line\":");
+        myassert_out_int(out, failure->site->line);
+        myassert_out_str(out, ",\"expression\":\"");
+        myassert_put_expression(&part, failure->site);
+        myassert_report_buf(out, &part, MYASSERT_ESCAPE_JSON);
+        part.len = 0;
+        myassert_put_operands(&part, failure);
+        if (part.len > 0)
+        {
+            myassert_out_str(out, "\",\"values\":\"");
+            myassert_report_buf(out, &part, MYASSERT_ESCAPE_JSON);
+        }
+        myassert_out_str(out, "\"}");
+    }
+    if (result->signal != 0)
+    {
+        myassert_out_str(out, ",\"signal\":\"");
+        char name[64];
+        struct myassert_buf buf = {name, 0, sizeof(name)};
+        myassert_put_signal(&buf, result->signal);
+        myassert_report_buf(out, &buf, MYASSERT_ESCAPE_JSON);
+        myassert_out_char(out, '"');
+    }
+
+    char data[MYASSERT_MESSAGE_SIZE];
+    struct myassert_buf buf = {data, 0, sizeof(data)};
+    myassert_put_outcome(&buf, result);
+    myassert_out_str(out, ",\"message\":\"");
+    myassert_report_buf(out, &buf, MYASSERT_ESCAPE_JSON);
+    myassert_out_str(out, "\"}\n");
+}
+
+static const struct myassert_reporter myassert_reporters[] = {
+    {"junit", myassert_junit_begin, myassert_junit_test, myassert_junit_end},
+    {"tap", myassert_tap_begin, myassert_tap_test, NULL},
+    {"jsonl", NULL, myassert_jsonl_test, NULL},
+};
+
+// Parses the next entry of MYASSERT_REPORT into its reporter, which is
+// NULL for an unknown format, and its path, which is empty for stdout.
+// Returns where the following entry starts.
+static inline const char *myassert_report_next(const char *spec,
+                                               const struct myassert_reporter **reporter,
+                                               char *path, size_t size)
+{
+    size_t len = strcspn(spec, ",");
+    size_t name = strcspn(spec, ":,");
+    size_t path_len = name < len ? len - name - 1 : 0;
+    if (path_len >= size)
+    {
+        path_len = size - 1;
+    }
+    memcpy(path, spec + name + (name < len), path_len);
+    path[path_len] = '\0';
+
+    *reporter = NULL;
+    for (size_t i = 0; i < sizeof(myassert_reporters) / sizeof(myassert_reporters[0]); i++)
+    {
+        if (strlen(myassert_reporters[i].name) == name &&
+            strncmp(myassert_reporters[i].name, spec, name) == 0)
+        {
+            *reporter = &myassert_reporters[i];
+        }
+    }
+    return spec[len] == ',' ? spec + len + 1 : spec + len;
+}
+
+static inline bool myassert_report_quiet(void)
+{
+    const char *spec = getenv("MYASSERT_REPORT");
+    const struct myassert_reporter *reporter;
+    char path[4096];
+    while (spec != NULL && *spec != '\0')
+    {
+        spec = myassert_report_next(spec, &reporter, path, sizeof(path));
+        if (reporter != NULL && path[0] == '\0')
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Writes one report through buffer, which holds MYASSERT_REPORT_BUFFER
+// bytes or is NULL. When aborting, the error message leaves out
+// strerror(), which may allocate.
+static inline void myassert_report_write(const struct myassert_reporter *reporter,
+                                         const char *path,
+                                         const struct myassert_result *results, size_t count,
+                                         char *buffer, bool aborting)
+{
+    int fd = path[0] != '\0' ? open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)
+                             : STDOUT_FILENO;
+    struct myassert_out out = {fd, buffer, 0, buffer != NULL ? (size_t)MYASSERT_REPORT_BUFFER : 0,
+                               fd < 0 ? errno : 0};
+    if (fd >= 0)
+    {
+        if (reporter->begin != NULL)
+        {
+            reporter->begin(&out, results, count);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            reporter->test(&out, &results[i], i + 1);
+        }
+        if (reporter->end != NULL)
+        {
+            reporter->end(&out, results, count);
+        }
+        myassert_out_flush(&out);
+    }
+    if (fd > STDOUT_FILENO && close(fd) != 0 && out.error == 0)
+    {
+        out.error = errno;
+    }
+    if (out.error != 0)
+    {
+        char data[MYASSERT_MESSAGE_SIZE];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_put_str(&buf, "myassert: cannot write report ");
+        myassert_put_str(&buf, path[0] != '\0' ? path : "to stdout");
+        if (!aborting)
+        {
+            myassert_put_str(&buf, ": ");
+            myassert_put_str(&buf, strerror(out.error));
+        }
+        myassert_write(STDERR_FILENO, &buf);
+    }
+}
+
+static inline void myassert_report_each(const char *spec, const struct myassert_result *results,
+                                        size_t count, char *buffer, bool aborting)
+{
+    const struct myassert_reporter *reporter;
+    char path[4096];
+    while (spec != NULL && *spec != '\0')
+    {
+        const char *entry = spec;
+        spec = myassert_report_next(spec, &reporter, path, sizeof(path));
+        if (reporter != NULL)
+        {
+            myassert_report_write(reporter, path, results, count, buffer, aborting);
+        }
+        else if (*entry != ',')
+        {
+            char data[256];
+            struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+            myassert_put_str(&buf, "myassert: unknown reporter ");
+            myassert_put_strn(&buf, entry, strcspn(entry, ":,"));
+            myassert_write(STDERR_FILENO, &buf);
+        }
+    }
+}
+
+static inline void myassert_report_results(const struct myassert_result *results, size_t count)
+{
+    const char *spec = getenv("MYASSERT_REPORT");
+    if (spec == NULL || spec[0] == '\0')
+    {
+        return;
+    }
+    // A report on stdout follows what the program printed there.
+    fflush(stdout);
+    char *buffer = (char *)malloc(MYASSERT_REPORT_BUFFER);
+    myassert_report_each(spec, results, count, buffer, false);
+    free(buffer);
+}
+
+MYASSERT_SHARED bool myassert_aborting;
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL bool myassert_abort_reporting;
+
+// A failed assertion in a test without a process of its own ends the
+// whole run. Before it does, the buffered progress lines are written out,
+// and so are the reports, with the tests that finished and the failing
+// one, as killed by SIGABRT. Like the failure message, this only formats
+// into memory reserved in advance and calls write(2), so it works from a
+// signal handler or an allocator. An assertion failing on another thread
+// meanwhile waits a few seconds for the process to end, then aborts it.
+static inline void myassert_report_abort(void)
+{
+    if (myassert_isolated || myassert_abort_reporting)
+    {
+        return;
+    }
+    if (__atomic_exchange_n(&myassert_aborting, true, __ATOMIC_ACQ_REL))
+    {
+        struct timespec wait = {0, 100000000};
+        for (int i = 0; i < 50; i++)
+        {
+            nanosleep(&wait, NULL);
+        }
+        return;
+    }
+    myassert_abort_reporting = true;
+    myassert_out_flush(&myassert_progress);
+
+    struct myassert_result *current = myassert_current_result;
+    const struct myassert_result *results = myassert_active_results;
+    struct myassert_result *finished = myassert_abort_results;
+    size_t count = myassert_active_count;
+    if (current == NULL || results == NULL || finished == NULL ||
+        count > myassert_abort_capacity)
+    {
+        return;
+    }
+    current->status = TEST_FAIL;
+    current->signal = SIGABRT;
+    current->done = true;
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (results[i].done || results[i].status == TEST_CACHED)
+        {
+            finished[n++] = results[i];
+        }
+    }
+    myassert_report_each(myassert_abort_spec, finished, n, myassert_abort_buffer, true);
+}
+
+#endif
+
+// =============================================================
+// BENCHMARKS
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+#ifndef MYASSERT_BENCH_MAX_REPETITIONS
+#define MYASSERT_BENCH_MAX_REPETITIONS 100
+#endif
+
+// Keeps the compiler from discarding a value whose result is otherwise
+// unused inside a benchmark loop.
+#if defined(__GNUC__) || defined(__clang__)
+#define DO_NOT_OPTIMIZE(value) __asm__ __volatile__("" : : "g"(value) : "memory")
+#define CLOBBER_MEMORY() __asm__ __volatile__("" : : : "memory")
+#else
+#define DO_NOT_OPTIMIZE(value) myassert_escape((const volatile void *)&(value))
+#define CLOBBER_MEMORY() myassert_escape(NULL)
+#endif
+
+MYASSERT_SHARED const volatile void *volatile myassert_escaped;
+
+static inline void myassert_escape(const volatile void *p)
+{
+    myassert_escaped = p;
+}
+
+struct myassert_bench
+{
+    const char *name;
+    void (*func)(uint64_t iterations);
+    const char *file;
+    int line;
+    struct myassert_bench *next;
+};
+
+struct myassert_bench_stats
+{
+    uint64_t iterations;
+    size_t repetitions;
+    double mean;
+    double median;
+    double stddev;
+    double min;
+    double samples[MYASSERT_BENCH_MAX_REPETITIONS];
+};
+
+MYASSERT_SHARED struct myassert_bench *myassert_benches;
+
+static inline void myassert_register_bench(struct myassert_bench *bench)
+{
+    bench->next = myassert_benches;
+    myassert_benches = bench;
+}
+
+// The body receives the number of iterations to run and must loop over
+// them itself, so the harness adds no per-iteration call overhead.
+#define BENCHMARK(name)                                       \
+    static void name(uint64_t iterations);                    \
+    static struct myassert_bench myassert_bench_##name =      \
+        {#name, name, __FILE__, __LINE__, NULL};              \
+    MYASSERT_ATTR((constructor))                              \
+    static void myassert_register_bench_##name(void)          \
+    {                                                         \
+        myassert_register_bench(&myassert_bench_##name);      \
+    }                                                         \
+    static void name(uint64_t iterations)
+
+// Evaluates to the benchmark's status. A regression also makes the
+// process exit with EXIT_FAILURE, as a failed stray expectation does.
+#define RUN_BENCHMARK(bench_func) \
+    myassert_run_benchmark_func(#bench_func, bench_func, __FILE__, __LINE__)
+
+static inline uint64_t myassert_bench_time(const struct myassert_bench *bench,
+                                           uint64_t iterations)
+{
+    uint64_t start = myassert_now_ns();
+    bench->func(iterations);
+    return myassert_now_ns() - start;
+}
+
+// Grows the iteration count until one repetition takes about
+// MYASSERT_BENCH_TIME_MS.
+static inline uint64_t myassert_bench_calibrate(const struct myassert_bench *bench,
+                                                uint64_t target_ns)
+{
+    uint64_t iterations = 1;
+    for (;;)
+    {
+        uint64_t elapsed = myassert_bench_time(bench, iterations);
+        if (elapsed >= target_ns || iterations >= UINT64_MAX / 100)
+        {
+            return iterations;
+        }
+        // Short runs are dominated by timer noise, so only extrapolate
+        // from one that took at least a tenth of the target.
+        if (elapsed * 10 >= target_ns)
+        {
+            return (uint64_t)((double)iterations * (double)target_ns / (double)elapsed) + 1;
+        }
+        iterations *= elapsed > 0 ? 10 : 100;
+    }
+}
+
+static inline int myassert_compare_double(const void *lhs, const void *rhs)
+{
+    double a = *(const double *)lhs;
+    double b = *(const double *)rhs;
+    return (a > b) - (a < b);
+}
+
+static inline void myassert_bench_summarize(struct myassert_bench_stats *stats)
+{
+    size_t n = stats->repetitions;
+    double sorted[MYASSERT_BENCH_MAX_REPETITIONS];
+    double sum = 0.0;
+    double squares = 0.0;
+
+    memcpy(sorted, stats->samples, n * sizeof(*sorted));
+    qsort(sorted, n, sizeof(*sorted), myassert_compare_double);
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += sorted[i];
+    }
+    stats->mean = sum / (double)n;
+    for (size_t i = 0; i < n; i++)
+    {
+        squares += (sorted[i] - stats->mean) * (sorted[i] - stats->mean);
+    }
+    stats->stddev = n > 1 ? sqrt(squares / (double)(n - 1)) : 0.0;
+    stats->median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    stats->min = sorted[0];
+}
+
+// =============================================================
+// BENCHMARK BASELINES
+// =============================================================
+
+struct myassert_bench_record
+{
+    char *name;
+    size_t repetitions;
+    double samples[MYASSERT_BENCH_MAX_REPETITIONS];
+};
+
+struct myassert_bench_table
+{
+    struct myassert_bench_record *records;
+    size_t count;
+    size_t capacity;
+};
+
+// Baseline loaded from MYASSERT_BENCH_BASELINE, and the results of this
+// run, saved to MYASSERT_BENCH_SAVE at exit.
+MYASSERT_SHARED struct myassert_bench_table myassert_bench_baseline;
+MYASSERT_SHARED struct myassert_bench_table myassert_bench_results;
+MYASSERT_SHARED bool myassert_bench_baseline_loaded;
+
+static inline struct myassert_bench_record *myassert_bench_table_add(
+    struct myassert_bench_table *table, const char *name, size_t repetitions,
+    const double *samples)
+{
+    if (table->count == table->capacity)
+    {
+        size_t capacity = table->capacity != 0 ? table->capacity * 2 : 16;
+        struct myassert_bench_record *records = (struct myassert_bench_record *)realloc(
+            table->records, capacity * sizeof(*records));
+        if (records == NULL)
+        {
+            FATAL("out of memory");
+        }
+        table->records = records;
+        table->capacity = capacity;
+    }
+
+    struct myassert_bench_record *record = &table->records[table->count++];
+    record->name = strdup(name);
+    record->repetitions = repetitions;
+    memcpy(record->samples, samples, repetitions * sizeof(*samples));
+    return record;
+}
+
+static inline const struct myassert_bench_record *myassert_bench_table_find(
+    const struct myassert_bench_table *table, const char *name)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        if (strcmp(table->records[i].name, name) == 0)
+        {
+            return &table->records[i];
+        }
+    }
+    return NULL;
+}
+
+// Baseline files hold one line per benchmark: its name, the number of
+// repetitions and the ns/iteration of each repetition.
+static inline void myassert_bench_load(struct myassert_bench_table *table, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char name[256];
+    size_t repetitions;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "myassert: cannot open benchmark baseline %s\n", path);
+        return;
+    }
+    while (fscanf(file, "%255s %zu", name, &repetitions) == 2)
+    {
+        double samples[MYASSERT_BENCH_MAX_REPETITIONS];
+        size_t n = 0;
+        for (size_t i = 0; i < repetitions; i++)
+        {
+            double sample;
+            if (fscanf(file, "%lf", &sample) != 1)
+            {
+                break;
+            }
+            if (n < MYASSERT_BENCH_MAX_REPETITIONS)
+            {
+                samples[n++] = sample;
+            }
+        }
+        if (n > 0)
+        {
+            myassert_bench_table_add(table, name, n, samples);
+        }
+    }
+    fclose(file);
+}
+
+static inline void myassert_bench_save(void)
+{
+    const char *path = getenv("MYASSERT_BENCH_SAVE");
+    FILE *file = path != NULL ? fopen(path, "w") : NULL;
+
+    if (path != NULL && file == NULL)
+    {
+        fprintf(stderr, "myassert: cannot write benchmark baseline %s\n", path);
+    }
+    for (size_t i = 0; file != NULL && i < myassert_bench_results.count; i++)
+    {
+        const struct myassert_bench_record *record = &myassert_bench_results.records[i];
+        fprintf(file, "%s %zu", record->name, record->repetitions);
+        for (size_t j = 0; j < record->repetitions; j++)
+        {
+            fprintf(file, " %.6g", record->samples[j]);
+        }
+        fprintf(file, "\n");
+    }
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+}
+
+// One-sided Mann-Whitney U test with the normal approximation and tie
+// correction. Returns the probability of seeing samples at least this much
+// slower than the baseline if both came from the same distribution.
+static inline double myassert_mann_whitney(const double *current, size_t n1,
+                                           const double *baseline, size_t n2)
+{
+    double u = 0.0;
+    double ties = 0.0;
+    double n = (double)(n1 + n2);
+    double all[2 * MYASSERT_BENCH_MAX_REPETITIONS];
+
+    for (size_t i = 0; i < n1; i++)
+    {
+        for (size_t j = 0; j < n2; j++)
+        {
+            u += current[i] > baseline[j] ? 1.0 : current[i] == baseline[j] ? 0.5 : 0.0;
+        }
+    }
+
+    memcpy(all, current, n1 * sizeof(*all));
+    memcpy(all + n1, baseline, n2 * sizeof(*all));
+    qsort(all, n1 + n2, sizeof(*all), myassert_compare_double);
+    for (size_t i = 0; i < n1 + n2;)
+    {
+        size_t j = i;
+        while (j < n1 + n2 && all[j] == all[i])
+        {
+            j++;
+        }
+        double t = (double)(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double mean = (double)n1 * (double)n2 / 2.0;
+    double variance = (double)n1 * (double)n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+    if (variance <= 0.0)
+    {
+        return u > mean ? 0.0 : 1.0;
+    }
+    double z = (u - mean - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+// Compares a benchmark against its baseline. It fails when the median is
+// more than MYASSERT_BENCH_THRESHOLD percent slower (default 5) and the
+// slowdown is significant at MYASSERT_BENCH_ALPHA (default 0.05).
+static inline int myassert_bench_check(const struct myassert_bench *bench,
+                                       const struct myassert_bench_stats *stats)
+{
+    const char *path = getenv("MYASSERT_BENCH_BASELINE");
+    if (path == NULL)
+    {
+        return TEST_OK;
+    }
+    if (!myassert_bench_baseline_loaded)
+    {
+        myassert_bench_baseline_loaded = true;
+        myassert_bench_load(&myassert_bench_baseline, path);
+    }
+
+    const struct myassert_bench_record *base =
+        myassert_bench_table_find(&myassert_bench_baseline, bench->name);
+    if (base == NULL)
+    {
+        printf("  no baseline\n");
+        return TEST_OK;
+    }
+
+    struct myassert_bench_stats previous;
+    memset(&previous, 0, sizeof(previous));
+    previous.repetitions = base->repetitions;
+    memcpy(previous.samples, base->samples, base->repetitions * sizeof(*base->samples));
+    myassert_bench_summarize(&previous);
+
+    const char *threshold_env = getenv("MYASSERT_BENCH_THRESHOLD");
+    const char *alpha_env = getenv("MYASSERT_BENCH_ALPHA");
+    double threshold = threshold_env != NULL ? atof(threshold_env) : 5.0;
+    double alpha = alpha_env != NULL ? atof(alpha_env) : 0.05;
+    double change = (stats->median / previous.median - 1.0) * 100.0;
+    double p = myassert_mann_whitney(stats->samples, stats->repetitions,
+                                     base->samples, base->repetitions);
+    int status = change > threshold && p < alpha ? TEST_FAIL : TEST_OK;
+
+    printf("  %+.1f%% vs baseline median %.3f ns/iter (p = %.4f) %s\n",
+           change, previous.median, p, status == TEST_OK ? "PASSED" : "FAILED");
+    return status;
+}
+
+// Calibrates, warms up and then times MYASSERT_BENCH_REPETITIONS
+// repetitions of a benchmark. Samples are in nanoseconds per iteration.
+// Returns TEST_FAIL when the benchmark regressed against its baseline.
+static inline int myassert_run_benchmark(const struct myassert_bench *bench,
+                                         struct myassert_bench_stats *stats)
+{
+    uint64_t target_ns = (uint64_t)myassert_env_ulong("MYASSERT_BENCH_TIME_MS", 50) * 1000000u;
+    unsigned long warmup = myassert_env_ulong("MYASSERT_BENCH_WARMUP", 1);
+    size_t repetitions = myassert_env_ulong("MYASSERT_BENCH_REPETITIONS", 10);
+
+    if (repetitions == 0)
+    {
+        repetitions = 1;
+    }
+    if (repetitions > MYASSERT_BENCH_MAX_REPETITIONS)
+    {
+        repetitions = MYASSERT_BENCH_MAX_REPETITIONS;
+    }
+
+    printf("Benchmark %s... ", bench->name);
+    fflush(stdout);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->iterations = myassert_bench_calibrate(bench, target_ns);
+    stats->repetitions = repetitions;
+    for (unsigned long i = 0; i < warmup; i++)
+    {
+        myassert_bench_time(bench, stats->iterations);
+    }
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        uint64_t elapsed = myassert_bench_time(bench, stats->iterations);
+        stats->samples[i] = (double)elapsed / (double)stats->iterations;
+    }
+    myassert_bench_summarize(stats);
+
+    printf("%.3f ns/iter (mean %.3f, median %.3f, stddev %.3f, min %.3f; "
+           "%zu x %" PRIu64 " iterations)\n",
+           stats->median, stats->mean, stats->median, stats->stddev, stats->min,
+           stats->repetitions, stats->iterations);
+
+    if (getenv("MYASSERT_BENCH_SAVE") != NULL)
+    {
+        if (myassert_bench_results.count == 0)
+        {
+            atexit(myassert_bench_save);
+        }
+        myassert_bench_table_add(&myassert_bench_results, bench->name,
+                                 stats->repetitions, stats->samples);
+    }
+
+    int status = myassert_bench_check(bench, stats);
+    fflush(stdout);
+    return status;
+}
+
+static inline int myassert_run_benchmark_func(const char *name, void (*func)(uint64_t iterations),
+                                              const char *file, int line)
+{
+    struct myassert_bench bench = {name, func, file, line, NULL};
+    struct myassert_bench_stats stats;
+    int status = myassert_run_benchmark(&bench, &stats);
+    if (status != TEST_OK)
+    {
+        __atomic_store_n(&myassert_process_failed, true, __ATOMIC_RELAXED);
+    }
+    return status;
+}
+
+static inline int myassert_compare_benches(const void *lhs, const void *rhs)
+{
+    const struct myassert_bench *a = *(struct myassert_bench *const *)lhs;
+    const struct myassert_bench *b = *(struct myassert_bench *const *)rhs;
+    int cmp = strcmp(a->file, b->file);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (a->line > b->line) - (a->line < b->line);
+}
+
+// Runs every BENCHMARK() one after another, in file/line order. Returns
+// EXIT_FAILURE when any of them regressed against the baseline.
+static inline int myassert_run_benchmarks(void)
+{
+    size_t count = 0;
+    for (struct myassert_bench *b = myassert_benches; b != NULL; b = b->next)
+    {
+        count++;
+    }
+
+    struct myassert_bench **benches =
+        (struct myassert_bench **)calloc(count + 1, sizeof(*benches));
+    if (benches == NULL)
+    {
+        FATAL("out of memory");
+    }
+    size_t n = 0;
+    for (struct myassert_bench *b = myassert_benches; b != NULL; b = b->next)
+    {
+        benches[n++] = b;
+    }
+    qsort(benches, count, sizeof(*benches), myassert_compare_benches);
+
+    size_t regressed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        struct myassert_bench_stats stats;
+        if (myassert_run_benchmark(benches[i], &stats) != TEST_OK)
+        {
+            regressed++;
+        }
+    }
+    if (regressed > 0)
+    {
+        printf("%zu of %zu benchmarks regressed\n", regressed, count);
+    }
+    free(benches);
+    return regressed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
+
+// =============================================================
+// LATENCY ASSERTIONS
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+// Durations are counted in clock ticks: TSC cycles on x86-64 when the
+// CPU reports an invariant TSC, nanoseconds from CLOCK_MONOTONIC
+// otherwise or with MYASSERT_TSC=0. The TSC is calibrated against
+// CLOCK_MONOTONIC once per process.
+#ifndef MYASSERT_HAVE_TSC
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MYASSERT_HAVE_TSC 1
+#else
+#define MYASSERT_HAVE_TSC 0
+#endif
+#endif
+
+#ifndef MYASSERT_TSC_CALIBRATE_MS
+#define MYASSERT_TSC_CALIBRATE_MS 5
+#endif
+
+struct myassert_clock
+{
+    bool tsc;
+    double ns_per_tick;
+    uint64_t overhead;
+};
+
+MYASSERT_SHARED struct myassert_clock myassert_clock;
+MYASSERT_SHARED pthread_once_t myassert_clock_once = PTHREAD_ONCE_INIT;
+
+// The fences keep the timed code from being reordered around the read.
+static inline uint64_t myassert_ticks(void)
+{
+#if MYASSERT_HAVE_TSC
+    if (myassert_clock.tsc)
+    {
+        __builtin_ia32_lfence();
+        uint64_t ticks = __builtin_ia32_rdtsc();
+        __builtin_ia32_lfence();
+        return ticks;
+    }
+#endif
+    return myassert_now_ns();
+}
+
+#if MYASSERT_HAVE_TSC
+static inline bool myassert_tsc_invariant(void)
+{
+    unsigned int a;
+    unsigned int b;
+    unsigned int c;
+    unsigned int d;
+    __asm__ __volatile__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(0x80000000u), "c"(0));
+    if (a < 0x80000007u)
+    {
+        return false;
+    }
+    __asm__ __volatile__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(0x80000007u), "c"(0));
+    return (d >> 8) & 1;
+}
+#endif
+
+// The cheapest of a few hundred back-to-back reads is taken as the cost
+// of timing an empty block and subtracted from every sample.
+static inline void myassert_clock_init(void)
+{
+    struct myassert_clock clock = {false, 1.0, 0};
+#if MYASSERT_HAVE_TSC
+    const char *env = getenv("MYASSERT_TSC");
+    if ((env == NULL || strcmp(env, "0") != 0) && myassert_tsc_invariant())
+    {
+        uint64_t start_ns = myassert_now_ns();
+        uint64_t start = __builtin_ia32_rdtsc();
+        uint64_t elapsed_ns;
+        do
+        {
+            elapsed_ns = myassert_now_ns() - start_ns;
+        } while (elapsed_ns < MYASSERT_TSC_CALIBRATE_MS * 1000000ull);
+        uint64_t elapsed = __builtin_ia32_rdtsc() - start;
+        if (elapsed > 0)
+        {
+            clock.tsc = true;
+            clock.ns_per_tick = (double)elapsed_ns / (double)elapsed;
+        }
+    }
+#endif
+    myassert_clock.tsc = clock.tsc;
+    clock.overhead = UINT64_MAX;
+    for (int i = 0; i < 256; i++)
+    {
+        uint64_t start = myassert_ticks();
+        uint64_t elapsed = myassert_ticks() - start;
+        clock.overhead = elapsed < clock.overhead ? elapsed : clock.overhead;
+    }
+    myassert_clock = clock;
+}
+
+// A fixed-size log-linear histogram in the style of HdrHistogram: values
+// below 2 * MYASSERT_HISTOGRAM_HALF ticks get a bucket each, and every
+// higher power of two is split into MYASSERT_HISTOGRAM_HALF buckets, so
+// a value is known to within 1/128 of itself. Values from 2^40 ticks up
+// share the last bucket, but the maximum is kept exactly.
+#define MYASSERT_HISTOGRAM_SHIFT 7
+#define MYASSERT_HISTOGRAM_HALF (1u << MYASSERT_HISTOGRAM_SHIFT)
+#define MYASSERT_HISTOGRAM_LIMIT (1ull << 40)
+#define MYASSERT_HISTOGRAM_BUCKETS ((40 - MYASSERT_HISTOGRAM_SHIFT + 1) * MYASSERT_HISTOGRAM_HALF)
+
+struct myassert_histogram
+{
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t counts[MYASSERT_HISTOGRAM_BUCKETS];
+};
+
+static inline void myassert_histogram_reset(struct myassert_histogram *histogram)
+{
+    pthread_once(&myassert_clock_once, myassert_clock_init);
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+static inline void myassert_histogram_record(struct myassert_histogram *histogram,
+                                             uint64_t ticks)
+{
+    ticks = ticks > myassert_clock.overhead ? ticks - myassert_clock.overhead : 0;
+    histogram->total++;
+    histogram->min = ticks < histogram->min ? ticks : histogram->min;
+    histogram->max = ticks > histogram->max ? ticks : histogram->max;
+    if (ticks >= MYASSERT_HISTOGRAM_LIMIT)
+    {
+        ticks = MYASSERT_HISTOGRAM_LIMIT - 1;
+    }
+    unsigned int top = 63 - (unsigned int)__builtin_clzll(ticks | 1);
+    unsigned int shift = top > MYASSERT_HISTOGRAM_SHIFT ? top - MYASSERT_HISTOGRAM_SHIFT : 0;
+    histogram->counts[shift * MYASSERT_HISTOGRAM_HALF + (ticks >> shift)]++;
+}
+
+// The highest value of the bucket holding the sample at the given rank,
+// in nanoseconds. 0 is the minimum and 100 the maximum.
+static inline double myassert_histogram_percentile(const struct myassert_histogram *histogram,
+                                                   double percentile)
+{
+    if (histogram->total == 0)
+    {
+        return 0.0;
+    }
+    // Without the nudge, 99.9% of 41000 samples would be rank 40960, not 40959.
+    double exact = percentile * (double)histogram->total / 100.0;
+    double nudged = exact - exact * 1e-12;
+    uint64_t rank = (uint64_t)nudged;
+    rank += (double)rank < nudged;
+    uint64_t ticks = histogram->max;
+    if (rank <= 1)
+    {
+        ticks = histogram->min;
+    }
+    else if (rank < histogram->total)
+    {
+        uint64_t seen = 0;
+        size_t i = 0;
+        while (seen + histogram->counts[i] < rank)
+        {
+            seen += histogram->counts[i++];
+        }
+        size_t shift = i < 2 * MYASSERT_HISTOGRAM_HALF ? 0 : i / MYASSERT_HISTOGRAM_HALF - 1;
+        uint64_t high = ((i - shift * MYASSERT_HISTOGRAM_HALF + 1) << shift) - 1;
+        ticks = high < ticks ? high : ticks;
+    }
+    return (double)ticks * myassert_clock.ns_per_tick;
+}
+
+static inline void myassert_latency_failure(struct myassert_failure *failure,
+                                            const struct myassert_histogram *histogram,
+                                            double a, double b)
+{
+    static const double percentiles[] = {0.0, 50.0, 90.0, 99.0, 99.9, 100.0};
+    failure->size = sizeof(double);
+    failure->count = histogram->total;
+    memcpy(failure->a, &a, sizeof(a));
+    memcpy(failure->b, &b, sizeof(b));
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++)
+    {
+        failure->latency[i] = myassert_histogram_percentile(histogram, percentiles[i]);
+    }
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_latency(const struct myassert_site *site,
+                                  const struct myassert_histogram *histogram, double a, double b)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    myassert_latency_failure(&failure, histogram, a, b);
+    myassert_abort(&failure);
+}
+
+MYASSERT_COLD
+static void myassert_expect_latency(const struct myassert_site *site,
+                                    const struct myassert_histogram *histogram, double a, double b)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        myassert_latency_failure(failure, histogram, a, b);
+        myassert_expect_done(failure);
+    }
+}
+
+// A histogram is too large for the stack, so each latency check keeps one
+// per thread in static storage. A check that MYASSERT_LEVEL compiles out
+// gets a null pointer instead, as it would otherwise still emit the
+// storage.
+#define MYASSERT_HISTOGRAM(level, name) MYASSERT_HISTOGRAM_AT(level, name)
+#define MYASSERT_HISTOGRAM_AT(level, name) MYASSERT_HISTOGRAM_##level(name)
+
+#define MYASSERT_HISTOGRAM_STATIC(name)                                    \
+    static MYASSERT_THREAD_LOCAL struct myassert_histogram name##_storage; \
+    struct myassert_histogram *const name = &name##_storage
+#define MYASSERT_HISTOGRAM_DEAD(name) struct myassert_histogram *const name = NULL
+
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL)
+#define MYASSERT_HISTOGRAM_1 MYASSERT_HISTOGRAM_STATIC
+#else
+#define MYASSERT_HISTOGRAM_1 MYASSERT_HISTOGRAM_DEAD
+#endif
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL)
+#define MYASSERT_HISTOGRAM_2 MYASSERT_HISTOGRAM_STATIC
+#else
+#define MYASSERT_HISTOGRAM_2 MYASSERT_HISTOGRAM_DEAD
+#endif
+#if MYASSERT_ENABLED(MYASSERT_LEVEL_PARANOID)
+#define MYASSERT_HISTOGRAM_3 MYASSERT_HISTOGRAM_STATIC
+#else
+#define MYASSERT_HISTOGRAM_3 MYASSERT_HISTOGRAM_DEAD
+#endif
+
+// Runs the block iterations times, timing each run on its own. Like an
+// allocation check, a disabled latency check still runs the block, but
+// only once. The block must not break out of or continue the timing loop.
+#define MYASSERT_LATENCY_BASE(macro, level, handler, percentile, name, ns, iterations, ...) \
+    do                                                                                      \
+    {                                                                                       \
+        if (!MYASSERT_ENABLED(level))                                                       \
+        {                                                                                   \
+            __VA_ARGS__                                                                     \
+            break;                                                                          \
+        }                                                                                   \
+        MYASSERT_SITE(level, myassert_site, macro, MYASSERT_SITE_LATENCY, name " latency",  \
+                      "<", #ns " ns", "f");                                                 \
+        MYASSERT_HIT(myassert_site);                                                        \
+        MYASSERT_HISTOGRAM(level, eval_histogram);                                          \
+        uint64_t const eval_iterations = (iterations);                                      \
+        myassert_histogram_reset(eval_histogram);                                           \
+        for (uint64_t eval_i = 0; eval_i < eval_iterations; eval_i++)                       \
+        {                                                                                   \
+            uint64_t const eval_start = myassert_ticks();                                   \
+            __VA_ARGS__                                                                     \
+            myassert_histogram_record(eval_histogram, myassert_ticks() - eval_start);       \
+        }                                                                                   \
+        double const eval_a = myassert_histogram_percentile(eval_histogram, percentile);    \
+        double const eval_b = (double)(ns);                                                 \
+        if (MYASSERT_UNLIKELY(!(eval_a < eval_b)))                                          \
+        {                                                                                   \
+            handler(&myassert_site, eval_histogram, eval_a, eval_b);                        \
+        }                                                                                   \
+    } while (0)
+
+#define ASSERT_LATENCY_P50_LT(ns, iterations, ...)                                 \
+    MYASSERT_LATENCY_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_latency, \
+                          50.0, "p50", ns, iterations, __VA_ARGS__)
+#define ASSERT_LATENCY_P99_LT(ns, iterations, ...)                                 \
+    MYASSERT_LATENCY_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_latency, \
+                          99.0, "p99", ns, iterations, __VA_ARGS__)
+#define ASSERT_LATENCY_P999_LT(ns, iterations, ...)                                \
+    MYASSERT_LATENCY_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_latency, \
+                          99.9, "p99.9", ns, iterations, __VA_ARGS__)
+#define ASSERT_LATENCY_MAX_LT(ns, iterations, ...)                                 \
+    MYASSERT_LATENCY_BASE("ASSERT", MYASSERT_LEVEL_FATAL, myassert_fail_latency, \
+                          100.0, "max", ns, iterations, __VA_ARGS__)
+
+#define EXPECT_LATENCY_P50_LT(ns, iterations, ...)                                    \
+    MYASSERT_LATENCY_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_latency, \
+                          50.0, "p50", ns, iterations, __VA_ARGS__)
+#define EXPECT_LATENCY_P99_LT(ns, iterations, ...)                                    \
+    MYASSERT_LATENCY_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_latency, \
+                          99.0, "p99", ns, iterations, __VA_ARGS__)
+#define EXPECT_LATENCY_P999_LT(ns, iterations, ...)                                   \
+    MYASSERT_LATENCY_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_latency, \
+                          99.9, "p99.9", ns, iterations, __VA_ARGS__)
+#define EXPECT_LATENCY_MAX_LT(ns, iterations, ...)                                    \
+    MYASSERT_LATENCY_BASE("EXPECT", MYASSERT_LEVEL_NORMAL, myassert_expect_latency, \
+                          100.0, "max", ns, iterations, __VA_ARGS__)
+
+#endif
+
+// =============================================================
+// BOOLEAN ASSERTIONS
+// =============================================================
+
+#define ASSERT_TRUE(a) \
+    ASSERT_BASE(a, ==, true, bool, "d")
+
+#define ASSERT_FALSE(a) \
+    ASSERT_BASE(a, ==, false, bool, "d")
+
+// =============================================================
+// NULL ASSERTIONS
+// =============================================================
+
+#define ASSERT_NULL(a) \
+    ASSERT_BASE(a, ==, NULL, const void *, "p")
+
+#define ASSERT_NOT_NULL(a) \
+    ASSERT_BASE(a, !=, NULL, const void *, "p")
+
+// =============================================================
+// MEMORY ASSERTIONS
+// =============================================================
+
+#define ASSERT_EQ_MEM(a, b, len) \
+    ASSERT_BASE_MEM_EQ(a, b, len)
+
+#define ASSERT_NE_MEM(a, b, len) \
+    ASSERT_BASE_LEN(memcmp(a, b, len) != 0, a, !=, b, "p", len)
+
+// =============================================================
+// STRING ASSERTIONS
+// =============================================================
+
+#define ASSERT_EQ_STR(a, b) \
+    ASSERT_BASE_STR(strcmp(a, b) == 0, a, ==, b, char *, "s")
+
+#define ASSERT_NE_STR(a, b) \
+    ASSERT_BASE_STR(strcmp(a, b) != 0, a, !=, b, char *, "s")
+
+#define ASSERT_EQ_STR_LEN(a, b, len) \
+    ASSERT_BASE_LEN(strncmp(a, b, len) == 0, a, ==, b, "s", len)
+
+#define ASSERT_NE_STR_LEN(a, b, len) \
+    ASSERT_BASE_LEN(strncmp(a, b, len) != 0, a, !=, b, "s", len)
+
+// ==============================================
+// BASIC INTEGER ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ(a, b) ASSERT_BASE(a, ==, b, int64_t, PRId64)
+#define ASSERT_GE(a, b) ASSERT_BASE(a, >=, b, int64_t, PRId64)
+#define ASSERT_GT(a, b) ASSERT_BASE(a, >, b, int64_t, PRId64)
+#define ASSERT_LE(a, b) ASSERT_BASE(a, <=, b, int64_t, PRId64)
+#define ASSERT_LT(a, b) ASSERT_BASE(a, <, b, int64_t, PRId64)
+#define ASSERT_NE(a, b) ASSERT_BASE(a, !=, b, int64_t, PRId64)
+
+// ==============================================
+// TYPE-SAFE INTEGER ASSERTIONS
+// ==============================================
+
+// The per-type integer and char macros. myassert.hpp turns them off,
+// since its ASSERT_EQ and friends deduce the type of their operands.
+#ifndef MYASSERT_TYPED_MACROS
+#define MYASSERT_TYPED_MACROS 1
+#endif
+
+#define TYPE_CHECK(expr, expected_type)                                     \
+    do                                                                      \
+    {                                                                       \
+        if (0)                                                              \
+        {                                                                   \
+            expected_type _type_check_var = expr;                           \
+            (void)_type_check_var;                                          \
+        }                                                                   \
+        (void)sizeof(char[sizeof(expr) == sizeof(expected_type) ? 1 : -1]); \
+    } while (0)
+
+#if MYASSERT_TYPED_MACROS
+
+// ==============================================
+// INT8_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_INT8(a, b)                  \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, int8_t);                \
+        TYPE_CHECK(b, int8_t);                \
+        ASSERT_BASE(a, ==, b, int8_t, PRId8); \
+    } while (0)
+
+#define ASSERT_GE_INT8(a, b)                  \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, int8_t);                \
+        TYPE_CHECK(b, int8_t);                \
+        ASSERT_BASE(a, >=, b, int8_t, PRId8); \
+    } while (0)
+
+#define ASSERT_GT_INT8(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, int8_t);               \
+        TYPE_CHECK(b, int8_t);               \
+        ASSERT_BASE(a, >, b, int8_t, PRId8); \
+    } while (0)
+
+#define ASSERT_LE_INT8(a, b)                  \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, int8_t);                \
+        TYPE_CHECK(b, int8_t);                \
+        ASSERT_BASE(a, <=, b, int8_t, PRId8); \
+    } while (0)
+
+#define ASSERT_LT_INT8(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, int8_t);               \
+        TYPE_CHECK(b, int8_t);               \
+        ASSERT_BASE(a, <, b, int8_t, PRId8); \
+    } while (0)
+
+#define ASSERT_NE_INT8(a, b)                  \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, int8_t);                \
+        TYPE_CHECK(b, int8_t);                \
+        ASSERT_BASE(a, !=, b, int8_t, PRId8); \
+    } while (0)
+
+// ==============================================
+// UINT8_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_UINT8(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, uint8_t);                \
+        TYPE_CHECK(b, uint8_t);                \
+        ASSERT_BASE(a, ==, b, uint8_t, PRIu8); \
+    } while (0)
+
+#define ASSERT_GE_UINT8(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, uint8_t);                \
+        TYPE_CHECK(b, uint8_t);                \
+        ASSERT_BASE(a, >=, b, uint8_t, PRIu8); \
+    } while (0)
+
+#define ASSERT_GT_UINT8(a, b)                 \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, uint8_t);               \
+        TYPE_CHECK(b, uint8_t);               \
+        ASSERT_BASE(a, >, b, uint8_t, PRIu8); \
+    } while (0)
+
+#define ASSERT_LE_UINT8(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, uint8_t);                \
+        TYPE_CHECK(b, uint8_t);                \
+        ASSERT_BASE(a, <=, b, uint8_t, PRIu8); \
+    } while (0)
+
+#define ASSERT_LT_UINT8(a, b)                 \
+    do                                        \
+    {                                         \
+        TYPE_CHECK(a, uint8_t);               \
+        TYPE_CHECK(b, uint8_t);               \
+        ASSERT_BASE(a, <, b, uint8_t, PRIu8); \
+    } while (0)
+
+#define ASSERT_NE_UINT8(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, uint8_t);                \
+        TYPE_CHECK(b, uint8_t);                \
+        ASSERT_BASE(a, !=, b, uint8_t, PRIu8); \
+    } while (0)
+
+// ==============================================
+// INT16_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_INT16(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int16_t);                 \
+        TYPE_CHECK(b, int16_t);                 \
+        ASSERT_BASE(a, ==, b, int16_t, PRId16); \
+    } while (0)
+
+#define ASSERT_GE_INT16(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int16_t);                 \
+        TYPE_CHECK(b, int16_t);                 \
+        ASSERT_BASE(a, >=, b, int16_t, PRId16); \
+    } while (0)
+
+#define ASSERT_GT_INT16(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int16_t);                \
+        TYPE_CHECK(b, int16_t);                \
+        ASSERT_BASE(a, >, b, int16_t, PRId16); \
+    } while (0)
+
+#define ASSERT_LE_INT16(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int16_t);                 \
+        TYPE_CHECK(b, int16_t);                 \
+        ASSERT_BASE(a, <=, b, int16_t, PRId16); \
+    } while (0)
+
+#define ASSERT_LT_INT16(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int16_t);                \
+        TYPE_CHECK(b, int16_t);                \
+        ASSERT_BASE(a, <, b, int16_t, PRId16); \
+    } while (0)
+
+#define ASSERT_NE_INT16(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int16_t);                 \
+        TYPE_CHECK(b, int16_t);                 \
+        ASSERT_BASE(a, !=, b, int16_t, PRId16); \
+    } while (0)
+
+// ==============================================
+// UINT16_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_UINT16(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint16_t);                 \
+        TYPE_CHECK(b, uint16_t);                 \
+        ASSERT_BASE(a, ==, b, uint16_t, PRIu16); \
+    } while (0)
+
+#define ASSERT_GE_UINT16(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint16_t);                 \
+        TYPE_CHECK(b, uint16_t);                 \
+        ASSERT_BASE(a, >=, b, uint16_t, PRIu16); \
+    } while (0)
+
+#define ASSERT_GT_UINT16(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint16_t);                \
+        TYPE_CHECK(b, uint16_t);                \
+        ASSERT_BASE(a, >, b, uint16_t, PRIu16); \
+    } while (0)
+
+#define ASSERT_LE_UINT16(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint16_t);                 \
+        TYPE_CHECK(b, uint16_t);                 \
+        ASSERT_BASE(a, <=, b, uint16_t, PRIu16); \
+    } while (0)
+
+#define ASSERT_LT_UINT16(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint16_t);                \
+        TYPE_CHECK(b, uint16_t);                \
+        ASSERT_BASE(a, <, b, uint16_t, PRIu16); \
+    } while (0)
+
+#define ASSERT_NE_UINT16(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint16_t);                 \
+        TYPE_CHECK(b, uint16_t);                 \
+        ASSERT_BASE(a, !=, b, uint16_t, PRIu16); \
+    } while (0)
+
+// ==============================================
+// INT32_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_INT32(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int32_t);                 \
+        TYPE_CHECK(b, int32_t);                 \
+        ASSERT_BASE(a, ==, b, int32_t, PRId32); \
+    } while (0)
+
+#define ASSERT_GE_INT32(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int32_t);                 \
+        TYPE_CHECK(b, int32_t);                 \
+        ASSERT_BASE(a, >=, b, int32_t, PRId32); \
+    } while (0)
+
+#define ASSERT_GT_INT32(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int32_t);                \
+        TYPE_CHECK(b, int32_t);                \
+        ASSERT_BASE(a, >, b, int32_t, PRId32); \
+    } while (0)
+
+#define ASSERT_LE_INT32(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int32_t);                 \
+        TYPE_CHECK(b, int32_t);                 \
+        ASSERT_BASE(a, <=, b, int32_t, PRId32); \
+    } while (0)
+
+#define ASSERT_LT_INT32(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int32_t);                \
+        TYPE_CHECK(b, int32_t);                \
+        ASSERT_BASE(a, <, b, int32_t, PRId32); \
+    } while (0)
+
+#define ASSERT_NE_INT32(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int32_t);                 \
+        TYPE_CHECK(b, int32_t);                 \
+        ASSERT_BASE(a, !=, b, int32_t, PRId32); \
+    } while (0)
+
+// ==============================================
+// UINT32_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_UINT32(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint32_t);                 \
+        TYPE_CHECK(b, uint32_t);                 \
+        ASSERT_BASE(a, ==, b, uint32_t, PRIu32); \
+    } while (0)
+
+#define ASSERT_GE_UINT32(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint32_t);                 \
+        TYPE_CHECK(b, uint32_t);                 \
+        ASSERT_BASE(a, >=, b, uint32_t, PRIu32); \
+    } while (0)
+
+#define ASSERT_GT_UINT32(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint32_t);                \
+        TYPE_CHECK(b, uint32_t);                \
+        ASSERT_BASE(a, >, b, uint32_t, PRIu32); \
+    } while (0)
+
+#define ASSERT_LE_UINT32(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint32_t);                 \
+        TYPE_CHECK(b, uint32_t);                 \
+        ASSERT_BASE(a, <=, b, uint32_t, PRIu32); \
+    } while (0)
+
+#define ASSERT_LT_UINT32(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint32_t);                \
+        TYPE_CHECK(b, uint32_t);                \
+        ASSERT_BASE(a, <, b, uint32_t, PRIu32); \
+    } while (0)
+
+#define ASSERT_NE_UINT32(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint32_t);                 \
+        TYPE_CHECK(b, uint32_t);                 \
+        ASSERT_BASE(a, !=, b, uint32_t, PRIu32); \
+    } while (0)
+
+// ==============================================
+// INT64_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_INT64(a, b)                   \
     do                                          \
     {                                           \
-        TYPE_CHECK(a, int16_t);                 \
-        TYPE_CHECK(b, int16_t);                 \
-        ASSERT_BASE(a, <=, b, int16_t, PRId16); \
+        TYPE_CHECK(a, int64_t);                 \
+        TYPE_CHECK(b, int64_t);                 \
+        ASSERT_BASE(a, ==, b, int64_t, PRId64); \
+    } while (0)
+
+#define ASSERT_GE_INT64(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int64_t);                 \
+        TYPE_CHECK(b, int64_t);                 \
+        ASSERT_BASE(a, >=, b, int64_t, PRId64); \
+    } while (0)
+
+#define ASSERT_GT_INT64(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int64_t);                \
+        TYPE_CHECK(b, int64_t);                \
+        ASSERT_BASE(a, >, b, int64_t, PRId64); \
+    } while (0)
+
+#define ASSERT_LE_INT64(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int64_t);                 \
+        TYPE_CHECK(b, int64_t);                 \
+        ASSERT_BASE(a, <=, b, int64_t, PRId64); \
+    } while (0)
+
+#define ASSERT_LT_INT64(a, b)                  \
+    do                                         \
+    {                                          \
+        TYPE_CHECK(a, int64_t);                \
+        TYPE_CHECK(b, int64_t);                \
+        ASSERT_BASE(a, <, b, int64_t, PRId64); \
+    } while (0)
+
+#define ASSERT_NE_INT64(a, b)                   \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, int64_t);                 \
+        TYPE_CHECK(b, int64_t);                 \
+        ASSERT_BASE(a, !=, b, int64_t, PRId64); \
+    } while (0)
+
+// ==============================================
+// UINT64_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_UINT64(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint64_t);                 \
+        TYPE_CHECK(b, uint64_t);                 \
+        ASSERT_BASE(a, ==, b, uint64_t, PRIu64); \
+    } while (0)
+
+#define ASSERT_GE_UINT64(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint64_t);                 \
+        TYPE_CHECK(b, uint64_t);                 \
+        ASSERT_BASE(a, >=, b, uint64_t, PRIu64); \
+    } while (0)
+
+#define ASSERT_GT_UINT64(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint64_t);                \
+        TYPE_CHECK(b, uint64_t);                \
+        ASSERT_BASE(a, >, b, uint64_t, PRIu64); \
+    } while (0)
+
+#define ASSERT_LE_UINT64(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint64_t);                 \
+        TYPE_CHECK(b, uint64_t);                 \
+        ASSERT_BASE(a, <=, b, uint64_t, PRIu64); \
+    } while (0)
+
+#define ASSERT_LT_UINT64(a, b)                  \
+    do                                          \
+    {                                           \
+        TYPE_CHECK(a, uint64_t);                \
+        TYPE_CHECK(b, uint64_t);                \
+        ASSERT_BASE(a, <, b, uint64_t, PRIu64); \
+    } while (0)
+
+#define ASSERT_NE_UINT64(a, b)                   \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, uint64_t);                 \
+        TYPE_CHECK(b, uint64_t);                 \
+        ASSERT_BASE(a, !=, b, uint64_t, PRIu64); \
+    } while (0)
+
+// ==============================================
+// SIZE_T ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_SIZE(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, size_t);               \
+        TYPE_CHECK(b, size_t);               \
+        ASSERT_BASE(a, ==, b, size_t, "zu"); \
+    } while (0)
+
+#define ASSERT_GE_SIZE(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, size_t);               \
+        TYPE_CHECK(b, size_t);               \
+        ASSERT_BASE(a, >=, b, size_t, "zu"); \
+    } while (0)
+
+#define ASSERT_GT_SIZE(a, b)                \
+    do                                      \
+    {                                       \
+        TYPE_CHECK(a, size_t);              \
+        TYPE_CHECK(b, size_t);              \
+        ASSERT_BASE(a, >, b, size_t, "zu"); \
+    } while (0)
+
+#define ASSERT_LE_SIZE(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, size_t);               \
+        TYPE_CHECK(b, size_t);               \
+        ASSERT_BASE(a, <=, b, size_t, "zu"); \
+    } while (0)
+
+#define ASSERT_LT_SIZE(a, b)                \
+    do                                      \
+    {                                       \
+        TYPE_CHECK(a, size_t);              \
+        TYPE_CHECK(b, size_t);              \
+        ASSERT_BASE(a, <, b, size_t, "zu"); \
+    } while (0)
+
+#define ASSERT_NE_SIZE(a, b)                 \
+    do                                       \
+    {                                        \
+        TYPE_CHECK(a, size_t);               \
+        TYPE_CHECK(b, size_t);               \
+        ASSERT_BASE(a, !=, b, size_t, "zu"); \
+    } while (0)
+
+// ==============================================
+// CHAR ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_CHAR(a, b)              \
+    do                                    \
+    {                                     \
+        TYPE_CHECK(a, char);              \
+        TYPE_CHECK(b, char);              \
+        ASSERT_BASE(a, ==, b, char, "c"); \
+    } while (0)
+
+#define ASSERT_NE_CHAR(a, b)              \
+    do                                    \
+    {                                     \
+        TYPE_CHECK(a, char);              \
+        TYPE_CHECK(b, char);              \
+        ASSERT_BASE(a, !=, b, char, "c"); \
+    } while (0)
+
+#define ASSERT_EQ_UCHAR(a, b)                      \
+    do                                             \
+    {                                              \
+        TYPE_CHECK(a, unsigned char);              \
+        TYPE_CHECK(b, unsigned char);              \
+        ASSERT_BASE(a, ==, b, unsigned char, "u"); \
+    } while (0)
+
+#define ASSERT_NE_UCHAR(a, b)                      \
+    do                                             \
+    {                                              \
+        TYPE_CHECK(a, unsigned char);              \
+        TYPE_CHECK(b, unsigned char);              \
+        ASSERT_BASE(a, !=, b, unsigned char, "u"); \
+    } while (0)
+
+#endif
+
+// ==============================================
+// FLOAT ASSERTIONS (with epsilon)
+// ==============================================
+
+#define ASSERT_EQ_FLOAT(a, b, epsilon)                                       \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                         \
+        {                                                                    \
+            MYASSERT_HINT(fabsf((a) - (b)) <= (epsilon));                    \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",         \
+                      MYASSERT_SITE_EPSILON, #a, "==", #b, "f");             \
+        MYASSERT_HIT(myassert_site);                                         \
+        TYPE_CHECK(a, float);                                                \
+        TYPE_CHECK(b, float);                                                \
+        TYPE_CHECK(epsilon, float);                                          \
+        float const eval_a = (a);                                            \
+        float const eval_b = (b);                                            \
+        float const eval_eps = (epsilon);                                    \
+        if (MYASSERT_UNLIKELY(!(fabsf(eval_a - eval_b) <= eval_eps)))        \
+        {                                                                    \
+            myassert_fail_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                    \
+    } while (0)
+
+#define ASSERT_NE_FLOAT(a, b, epsilon)                                       \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                         \
+        {                                                                    \
+            MYASSERT_HINT(fabsf((a) - (b)) > (epsilon));                     \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",         \
+                      MYASSERT_SITE_EPSILON, #a, "!=", #b, "f");             \
+        MYASSERT_HIT(myassert_site);                                         \
+        TYPE_CHECK(a, float);                                                \
+        TYPE_CHECK(b, float);                                                \
+        TYPE_CHECK(epsilon, float);                                          \
+        float const eval_a = (a);                                            \
+        float const eval_b = (b);                                            \
+        float const eval_eps = (epsilon);                                    \
+        if (MYASSERT_UNLIKELY(!(fabsf(eval_a - eval_b) > eval_eps)))         \
+        {                                                                    \
+            myassert_fail_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                    \
+    } while (0)
+
+// ==============================================
+// DOUBLE ASSERTIONS (with epsilon)
+// ==============================================
+
+#define ASSERT_EQ_DOUBLE(a, b, epsilon)                                      \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                         \
+        {                                                                    \
+            MYASSERT_HINT(fabs((a) - (b)) <= (epsilon));                     \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",         \
+                      MYASSERT_SITE_EPSILON, #a, "==", #b, "f");             \
+        MYASSERT_HIT(myassert_site);                                         \
+        TYPE_CHECK(a, double);                                               \
+        TYPE_CHECK(b, double);                                               \
+        TYPE_CHECK(epsilon, double);                                         \
+        double const eval_a = (a);                                           \
+        double const eval_b = (b);                                           \
+        double const eval_eps = (epsilon);                                   \
+        if (MYASSERT_UNLIKELY(!(fabs(eval_a - eval_b) <= eval_eps)))         \
+        {                                                                    \
+            myassert_fail_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                    \
+    } while (0)
+
+#define ASSERT_NE_DOUBLE(a, b, epsilon)                                      \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                         \
+        {                                                                    \
+            MYASSERT_HINT(fabs((a) - (b)) > (epsilon));                      \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",         \
+                      MYASSERT_SITE_EPSILON, #a, "!=", #b, "f");             \
+        MYASSERT_HIT(myassert_site);                                         \
+        TYPE_CHECK(a, double);                                               \
+        TYPE_CHECK(b, double);                                               \
+        TYPE_CHECK(epsilon, double);                                         \
+        double const eval_a = (a);                                           \
+        double const eval_b = (b);                                           \
+        double const eval_eps = (epsilon);                                   \
+        if (MYASSERT_UNLIKELY(!(fabs(eval_a - eval_b) > eval_eps)))          \
+        {                                                                    \
+            myassert_fail_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                    \
+    } while (0)
+
+// =============================================================
+// NON-FATAL EXPECTATIONS
+// =============================================================
+
+// EXPECT_* mirror the ASSERT_* macros, but a failure is recorded in a
+// preallocated per-thread buffer instead of aborting. RUN_TEST and the
+// runner report the records and mark the test FAILED once it returns.
+
+#define EXPECT(expr)                                                  \
+    do                                                                \
+    {                                                                 \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                 \
+        {                                                             \
+            break;                                                    \
+        }                                                             \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT", \
+                      MYASSERT_SITE_EXPR, #expr, "", "", "");         \
+        MYASSERT_HIT(myassert_site);                                  \
+        if (!(expr))                                                  \
+        {                                                             \
+            myassert_expect_value(&myassert_site, NULL, NULL, 0);     \
+        }                                                             \
+    } while (0)
+
+#define EXPECT_BASE(a, operator, b, type, conv)                       \
+    do                                                                \
+    {                                                                 \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                 \
+        {                                                             \
+            break;                                                    \
+        }                                                             \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT", \
+                      MYASSERT_SITE_VALUE, #a, #operator, #b, conv);  \
+        MYASSERT_HIT(myassert_site);                                  \
+        type const eval_a = (a);                                      \
+        type const eval_b = (b);                                      \
+        if (MYASSERT_UNLIKELY(!(eval_a operator eval_b)))             \
+        {                                                             \
+            type const fail_a = eval_a;                               \
+            type const fail_b = eval_b;                               \
+            myassert_expect_value(&myassert_site, &fail_a, &fail_b,   \
+                                  sizeof(type));                      \
+        }                                                             \
+    } while (0)
+
+#define EXPECT_OK(a)                                                  \
+    do                                                                \
+    {                                                                 \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                 \
+        {                                                             \
+            break;                                                    \
+        }                                                             \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT", \
+                      MYASSERT_SITE_OK, #a, "", "", PRId64);          \
+        MYASSERT_HIT(myassert_site);                                  \
+        int64_t const eval_a = (a);                                   \
+        if (MYASSERT_UNLIKELY(eval_a))                                \
+        {                                                             \
+            int64_t const fail_a = eval_a;                            \
+            myassert_expect_value(&myassert_site, &fail_a, &fail_a,   \
+                                  sizeof(fail_a));                    \
+        }                                                             \
+    } while (0)
+
+#define EXPECT_BASE_STR(expr, a, operator, b, len)                    \
+    do                                                                \
+    {                                                                 \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                 \
+        {                                                             \
+            break;                                                    \
+        }                                                             \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT", \
+                      MYASSERT_SITE_TEXT, #a, #operator, #b, "s");    \
+        MYASSERT_HIT(myassert_site);                                  \
+        if (!(expr))                                                  \
+        {                                                             \
+            myassert_expect_text(&myassert_site, a, b, len);          \
+        }                                                             \
+    } while (0)
+
+#define EXPECT_BASE_MEM(expr, a, operator, b)                         \
+    do                                                                \
+    {                                                                 \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                 \
+        {                                                             \
+            break;                                                    \
+        }                                                             \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT", \
+                      MYASSERT_SITE_VALUE, #a, #operator, #b, "p");   \
+        MYASSERT_HIT(myassert_site);                                  \
+        if (!(expr))                                                  \
+        {                                                             \
+            const void *const eval_a = (a);                           \
+            const void *const eval_b = (b);                           \
+            myassert_expect_value(&myassert_site, &eval_a, &eval_b,   \
+                                  sizeof(eval_a));                    \
+        }                                                             \
+    } while (0)
+
+#define EXPECT_BASE_MEM_EQ(a, b, len)                                         \
+    do                                                                        \
+    {                                                                         \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                         \
+        {                                                                     \
+            break;                                                            \
+        }                                                                     \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",         \
+                      MYASSERT_SITE_MEMORY, #a, "==", #b, "x");               \
+        MYASSERT_HIT(myassert_site);                                          \
+        const void *const eval_a = (a);                                       \
+        const void *const eval_b = (b);                                       \
+        size_t const eval_len = (len);                                        \
+        if (MYASSERT_UNLIKELY(memcmp(eval_a, eval_b, eval_len) != 0))         \
+        {                                                                     \
+            myassert_expect_memory(&myassert_site, eval_a, eval_b, eval_len); \
+        }                                                                     \
+    } while (0)
+
+#define EXPECT_TYPED(a, operator, b, type, conv) \
+    do                                           \
+    {                                            \
+        TYPE_CHECK(a, type);                     \
+        TYPE_CHECK(b, type);                     \
+        EXPECT_BASE(a, operator, b, type, conv); \
+    } while (0)
+
+#define EXPECT_TRUE(a) \
+    EXPECT_BASE(a, ==, true, bool, "d")
+
+#define EXPECT_FALSE(a) \
+    EXPECT_BASE(a, ==, false, bool, "d")
+
+#define EXPECT_NULL(a) \
+    EXPECT_BASE(a, ==, NULL, const void *, "p")
+
+#define EXPECT_NOT_NULL(a) \
+    EXPECT_BASE(a, !=, NULL, const void *, "p")
+
+#define EXPECT_EQ_MEM(a, b, len) \
+    EXPECT_BASE_MEM_EQ(a, b, len)
+
+#define EXPECT_NE_MEM(a, b, len) \
+    EXPECT_BASE_MEM(memcmp(a, b, len) != 0, a, !=, b)
+
+#define EXPECT_EQ_STR(a, b) \
+    EXPECT_BASE_STR(strcmp(a, b) == 0, a, ==, b, SIZE_MAX)
+
+#define EXPECT_NE_STR(a, b) \
+    EXPECT_BASE_STR(strcmp(a, b) != 0, a, !=, b, SIZE_MAX)
+
+#define EXPECT_EQ_STR_LEN(a, b, len) \
+    EXPECT_BASE_STR(strncmp(a, b, len) == 0, a, ==, b, len)
+
+#define EXPECT_NE_STR_LEN(a, b, len) \
+    EXPECT_BASE_STR(strncmp(a, b, len) != 0, a, !=, b, len)
+
+#define EXPECT_EQ(a, b) EXPECT_BASE(a, ==, b, int64_t, PRId64)
+#define EXPECT_GE(a, b) EXPECT_BASE(a, >=, b, int64_t, PRId64)
+#define EXPECT_GT(a, b) EXPECT_BASE(a, >, b, int64_t, PRId64)
+#define EXPECT_LE(a, b) EXPECT_BASE(a, <=, b, int64_t, PRId64)
+#define EXPECT_LT(a, b) EXPECT_BASE(a, <, b, int64_t, PRId64)
+#define EXPECT_NE(a, b) EXPECT_BASE(a, !=, b, int64_t, PRId64)
+
+#if MYASSERT_TYPED_MACROS
+
+// ==============================================
+// INT8_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_INT8(a, b) EXPECT_TYPED(a, ==, b, int8_t, PRId8)
+#define EXPECT_GE_INT8(a, b) EXPECT_TYPED(a, >=, b, int8_t, PRId8)
+#define EXPECT_GT_INT8(a, b) EXPECT_TYPED(a, >, b, int8_t, PRId8)
+#define EXPECT_LE_INT8(a, b) EXPECT_TYPED(a, <=, b, int8_t, PRId8)
+#define EXPECT_LT_INT8(a, b) EXPECT_TYPED(a, <, b, int8_t, PRId8)
+#define EXPECT_NE_INT8(a, b) EXPECT_TYPED(a, !=, b, int8_t, PRId8)
+
+// ==============================================
+// UINT8_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_UINT8(a, b) EXPECT_TYPED(a, ==, b, uint8_t, PRIu8)
+#define EXPECT_GE_UINT8(a, b) EXPECT_TYPED(a, >=, b, uint8_t, PRIu8)
+#define EXPECT_GT_UINT8(a, b) EXPECT_TYPED(a, >, b, uint8_t, PRIu8)
+#define EXPECT_LE_UINT8(a, b) EXPECT_TYPED(a, <=, b, uint8_t, PRIu8)
+#define EXPECT_LT_UINT8(a, b) EXPECT_TYPED(a, <, b, uint8_t, PRIu8)
+#define EXPECT_NE_UINT8(a, b) EXPECT_TYPED(a, !=, b, uint8_t, PRIu8)
+
+// ==============================================
+// INT16_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_INT16(a, b) EXPECT_TYPED(a, ==, b, int16_t, PRId16)
+#define EXPECT_GE_INT16(a, b) EXPECT_TYPED(a, >=, b, int16_t, PRId16)
+#define EXPECT_GT_INT16(a, b) EXPECT_TYPED(a, >, b, int16_t, PRId16)
+#define EXPECT_LE_INT16(a, b) EXPECT_TYPED(a, <=, b, int16_t, PRId16)
+#define EXPECT_LT_INT16(a, b) EXPECT_TYPED(a, <, b, int16_t, PRId16)
+#define EXPECT_NE_INT16(a, b) EXPECT_TYPED(a, !=, b, int16_t, PRId16)
+
+// ==============================================
+// UINT16_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_UINT16(a, b) EXPECT_TYPED(a, ==, b, uint16_t, PRIu16)
+#define EXPECT_GE_UINT16(a, b) EXPECT_TYPED(a, >=, b, uint16_t, PRIu16)
+#define EXPECT_GT_UINT16(a, b) EXPECT_TYPED(a, >, b, uint16_t, PRIu16)
+#define EXPECT_LE_UINT16(a, b) EXPECT_TYPED(a, <=, b, uint16_t, PRIu16)
+#define EXPECT_LT_UINT16(a, b) EXPECT_TYPED(a, <, b, uint16_t, PRIu16)
+#define EXPECT_NE_UINT16(a, b) EXPECT_TYPED(a, !=, b, uint16_t, PRIu16)
+
+// ==============================================
+// INT32_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_INT32(a, b) EXPECT_TYPED(a, ==, b, int32_t, PRId32)
+#define EXPECT_GE_INT32(a, b) EXPECT_TYPED(a, >=, b, int32_t, PRId32)
+#define EXPECT_GT_INT32(a, b) EXPECT_TYPED(a, >, b, int32_t, PRId32)
+#define EXPECT_LE_INT32(a, b) EXPECT_TYPED(a, <=, b, int32_t, PRId32)
+#define EXPECT_LT_INT32(a, b) EXPECT_TYPED(a, <, b, int32_t, PRId32)
+#define EXPECT_NE_INT32(a, b) EXPECT_TYPED(a, !=, b, int32_t, PRId32)
+
+// ==============================================
+// UINT32_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_UINT32(a, b) EXPECT_TYPED(a, ==, b, uint32_t, PRIu32)
+#define EXPECT_GE_UINT32(a, b) EXPECT_TYPED(a, >=, b, uint32_t, PRIu32)
+#define EXPECT_GT_UINT32(a, b) EXPECT_TYPED(a, >, b, uint32_t, PRIu32)
+#define EXPECT_LE_UINT32(a, b) EXPECT_TYPED(a, <=, b, uint32_t, PRIu32)
+#define EXPECT_LT_UINT32(a, b) EXPECT_TYPED(a, <, b, uint32_t, PRIu32)
+#define EXPECT_NE_UINT32(a, b) EXPECT_TYPED(a, !=, b, uint32_t, PRIu32)
+
+// ==============================================
+// INT64_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_INT64(a, b) EXPECT_TYPED(a, ==, b, int64_t, PRId64)
+#define EXPECT_GE_INT64(a, b) EXPECT_TYPED(a, >=, b, int64_t, PRId64)
+#define EXPECT_GT_INT64(a, b) EXPECT_TYPED(a, >, b, int64_t, PRId64)
+#define EXPECT_LE_INT64(a, b) EXPECT_TYPED(a, <=, b, int64_t, PRId64)
+#define EXPECT_LT_INT64(a, b) EXPECT_TYPED(a, <, b, int64_t, PRId64)
+#define EXPECT_NE_INT64(a, b) EXPECT_TYPED(a, !=, b, int64_t, PRId64)
+
+// ==============================================
+// UINT64_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_UINT64(a, b) EXPECT_TYPED(a, ==, b, uint64_t, PRIu64)
+#define EXPECT_GE_UINT64(a, b) EXPECT_TYPED(a, >=, b, uint64_t, PRIu64)
+#define EXPECT_GT_UINT64(a, b) EXPECT_TYPED(a, >, b, uint64_t, PRIu64)
+#define EXPECT_LE_UINT64(a, b) EXPECT_TYPED(a, <=, b, uint64_t, PRIu64)
+#define EXPECT_LT_UINT64(a, b) EXPECT_TYPED(a, <, b, uint64_t, PRIu64)
+#define EXPECT_NE_UINT64(a, b) EXPECT_TYPED(a, !=, b, uint64_t, PRIu64)
+
+// ==============================================
+// SIZE_T EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_SIZE(a, b) EXPECT_TYPED(a, ==, b, size_t, "zu")
+#define EXPECT_GE_SIZE(a, b) EXPECT_TYPED(a, >=, b, size_t, "zu")
+#define EXPECT_GT_SIZE(a, b) EXPECT_TYPED(a, >, b, size_t, "zu")
+#define EXPECT_LE_SIZE(a, b) EXPECT_TYPED(a, <=, b, size_t, "zu")
+#define EXPECT_LT_SIZE(a, b) EXPECT_TYPED(a, <, b, size_t, "zu")
+#define EXPECT_NE_SIZE(a, b) EXPECT_TYPED(a, !=, b, size_t, "zu")
+
+// ==============================================
+// CHAR EXPECTATIONS
+// ==============================================
+
+#define EXPECT_EQ_CHAR(a, b) EXPECT_TYPED(a, ==, b, char, "c")
+#define EXPECT_NE_CHAR(a, b) EXPECT_TYPED(a, !=, b, char, "c")
+#define EXPECT_EQ_UCHAR(a, b) EXPECT_TYPED(a, ==, b, unsigned char, "u")
+#define EXPECT_NE_UCHAR(a, b) EXPECT_TYPED(a, !=, b, unsigned char, "u")
+
+#endif
+
+// ==============================================
+// FLOAT EXPECTATIONS (with epsilon)
+// ==============================================
+
+#define EXPECT_EQ_FLOAT(a, b, epsilon)                                         \
+    do                                                                         \
+    {                                                                          \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",          \
+                      MYASSERT_SITE_EPSILON, #a, "==", #b, "f");               \
+        MYASSERT_HIT(myassert_site);                                           \
+        TYPE_CHECK(a, float);                                                  \
+        TYPE_CHECK(b, float);                                                  \
+        TYPE_CHECK(epsilon, float);                                            \
+        float const eval_a = (a);                                              \
+        float const eval_b = (b);                                              \
+        float const eval_eps = (epsilon);                                      \
+        if (!(fabsf(eval_a - eval_b) <= eval_eps))                             \
+        {                                                                      \
+            myassert_expect_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                      \
+    } while (0)
+
+#define EXPECT_NE_FLOAT(a, b, epsilon)                                         \
+    do                                                                         \
+    {                                                                          \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",          \
+                      MYASSERT_SITE_EPSILON, #a, "!=", #b, "f");               \
+        MYASSERT_HIT(myassert_site);                                           \
+        TYPE_CHECK(a, float);                                                  \
+        TYPE_CHECK(b, float);                                                  \
+        TYPE_CHECK(epsilon, float);                                            \
+        float const eval_a = (a);                                              \
+        float const eval_b = (b);                                              \
+        float const eval_eps = (epsilon);                                      \
+        if (!(fabsf(eval_a - eval_b) > eval_eps))                              \
+        {                                                                      \
+            myassert_expect_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                      \
+    } while (0)
+
+// ==============================================
+// DOUBLE EXPECTATIONS (with epsilon)
+// ==============================================
+
+#define EXPECT_EQ_DOUBLE(a, b, epsilon)                                        \
+    do                                                                         \
+    {                                                                          \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",          \
+                      MYASSERT_SITE_EPSILON, #a, "==", #b, "f");               \
+        MYASSERT_HIT(myassert_site);                                           \
+        TYPE_CHECK(a, double);                                                 \
+        TYPE_CHECK(b, double);                                                 \
+        TYPE_CHECK(epsilon, double);                                           \
+        double const eval_a = (a);                                             \
+        double const eval_b = (b);                                             \
+        double const eval_eps = (epsilon);                                     \
+        if (!(fabs(eval_a - eval_b) <= eval_eps))                              \
+        {                                                                      \
+            myassert_expect_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                      \
+    } while (0)
+
+#define EXPECT_NE_DOUBLE(a, b, epsilon)                                        \
+    do                                                                         \
+    {                                                                          \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",          \
+                      MYASSERT_SITE_EPSILON, #a, "!=", #b, "f");               \
+        MYASSERT_HIT(myassert_site);                                           \
+        TYPE_CHECK(a, double);                                                 \
+        TYPE_CHECK(b, double);                                                 \
+        TYPE_CHECK(epsilon, double);                                           \
+        double const eval_a = (a);                                             \
+        double const eval_b = (b);                                             \
+        double const eval_eps = (epsilon);                                     \
+        if (!(fabs(eval_a - eval_b) > eval_eps))                               \
+        {                                                                      \
+            myassert_expect_epsilon(&myassert_site, eval_a, eval_b, eval_eps); \
+        }                                                                      \
+    } while (0)
+
+// =============================================================
+// SAMPLED ASSERTIONS
+// =============================================================
+
+// The *_SAMPLED macros run their check on the first pass through a call
+// site and then on every nth pass. The countdown is per site and per
+// thread, so hot paths on different cores do not share a cache line.
+// ASSERT_SAMPLED* abort like ASSERT. EXPECT_SAMPLED* never abort; each
+// site logs at most MYASSERT_SAMPLED_RATE failures per second and counts
+// the rest.
+
+#ifndef MYASSERT_SAMPLED_RATE
+#define MYASSERT_SAMPLED_RATE 5
+#endif
+
+struct myassert_limit
+{
+    uint64_t second;
+    uint64_t logged;
+    uint64_t dropped;
+};
+
+static inline uint64_t myassert_now_seconds(void)
+{
+#if MYASSERT_HAVE_POSIX
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec;
+#else
+    return (uint64_t)time(NULL);
+#endif
+}
+
+// Reports a failed sampled expectation unless its site already used up
+// the current second. A new second starts with a note about the failures
+// that were dropped in the previous one.
+MYASSERT_COLD
+static void myassert_soft_report(struct myassert_limit *limit,
+                                 const struct myassert_failure *failure)
+{
+    uint64_t now = myassert_now_seconds();
+    uint64_t second = __atomic_load_n(&limit->second, __ATOMIC_RELAXED);
+
+    myassert_expect.logged++;
+    myassert_ring_push("Expectation", failure);
+    if (!myassert_expect.active)
+    {
+        // Fails the tests running at the time, but never the process:
+        // sampled checks are meant to stay in production code.
+        myassert_expect.logged = 0;
+        __atomic_fetch_add(&myassert_stray_failures, 1, __ATOMIC_RELAXED);
+    }
+    if (second != now &&
+        __atomic_compare_exchange_n(&limit->second, &second, now, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&limit->logged, 0, __ATOMIC_RELAXED);
+        uint64_t dropped = __atomic_exchange_n(&limit->dropped, 0, __ATOMIC_RELAXED);
+        if (dropped > 0)
+        {
+            char data[MYASSERT_MESSAGE_SIZE];
+            struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+            myassert_put_str(&buf, "Expectation in ");
+            myassert_put_str(&buf, failure->site->file);
+            myassert_put_str(&buf, " on line ");
+            myassert_put_int(&buf, failure->site->line);
+            myassert_put_str(&buf, ": ");
+            myassert_put_uint(&buf, dropped, 10);
+            myassert_put_str(&buf, " more failures not logged");
+            myassert_write(STDERR_FILENO, &buf);
+        }
+    }
+
+    if (__atomic_fetch_add(&limit->logged, 1, __ATOMIC_RELAXED) < MYASSERT_SAMPLED_RATE)
+    {
+        myassert_report_failure(STDERR_FILENO, "Expectation", failure);
+    }
+    else
+    {
+        __atomic_fetch_add(&limit->dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+MYASSERT_COLD
+static void myassert_soft_value(const struct myassert_site *site, struct myassert_limit *limit,
+                                const void *a, const void *b, size_t size)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    failure.size = size;
+    if (size > 0)
+    {
+        memcpy(failure.a, a, size);
+        memcpy(failure.b, b, size);
+    }
+    myassert_soft_report(limit, &failure);
+}
+
+// Passes to skip after a sampled check runs. A period below 1 counts as
+// 1 rather than wrapping around to a check every 2^32 passes.
+static inline uint32_t myassert_sample_skips(int64_t n)
+{
+    if (n <= 1)
+    {
+        return 0;
+    }
+    return n - 1 > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)(n - 1);
+}
+
+#define MYASSERT_SAMPLED(level, n, check)                          \
+    do                                                             \
+    {                                                              \
+        static MYASSERT_THREAD_LOCAL uint32_t myassert_countdown;  \
+        if (!MYASSERT_ENABLED(level) || myassert_countdown-- != 0) \
+        {                                                          \
+            break;                                                 \
+        }                                                          \
+        myassert_countdown = myassert_sample_skips((int64_t)(n));  \
+        check;                                                     \
+    } while (0)
+
+#define MYASSERT_SOFT(expr)                                                   \
+    do                                                                        \
+    {                                                                         \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT_SAMPLED", \
+                      MYASSERT_SITE_EXPR, #expr, "", "", "");                 \
+        MYASSERT_HIT(myassert_site);                                          \
+        if (MYASSERT_UNLIKELY(!(expr)))                                       \
+        {                                                                     \
+            static struct myassert_limit myassert_limit;                      \
+            myassert_soft_value(&myassert_site, &myassert_limit,              \
+                                NULL, NULL, 0);                               \
+        }                                                                     \
+    } while (0)
+
+#define MYASSERT_SOFT_BASE(a, operator, b)                                    \
+    do                                                                        \
+    {                                                                         \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT_SAMPLED", \
+                      MYASSERT_SITE_VALUE, #a, #operator, #b, PRId64);        \
+        MYASSERT_HIT(myassert_site);                                          \
+        int64_t const eval_a = (a);                                           \
+        int64_t const eval_b = (b);                                           \
+        if (MYASSERT_UNLIKELY(!(eval_a operator eval_b)))                     \
+        {                                                                     \
+            static struct myassert_limit myassert_limit;                      \
+            int64_t const fail_a = eval_a;                                    \
+            int64_t const fail_b = eval_b;                                    \
+            myassert_soft_value(&myassert_site, &myassert_limit,              \
+                                &fail_a, &fail_b, sizeof(int64_t));           \
+        }                                                                     \
+    } while (0)
+
+#define ASSERT_SAMPLED(expr, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT(expr))
+
+#define ASSERT_SAMPLED_EQ(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_EQ(a, b))
+#define ASSERT_SAMPLED_GE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_GE(a, b))
+#define ASSERT_SAMPLED_GT(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_GT(a, b))
+#define ASSERT_SAMPLED_LE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_LE(a, b))
+#define ASSERT_SAMPLED_LT(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_LT(a, b))
+#define ASSERT_SAMPLED_NE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_FATAL, n, ASSERT_NE(a, b))
+
+#define EXPECT_SAMPLED(expr, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT(expr))
+
+#define EXPECT_SAMPLED_EQ(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, ==, b))
+#define EXPECT_SAMPLED_GE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, >=, b))
+#define EXPECT_SAMPLED_GT(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, >, b))
+#define EXPECT_SAMPLED_LE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, <=, b))
+#define EXPECT_SAMPLED_LT(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, <, b))
+#define EXPECT_SAMPLED_NE(a, b, n) \
+    MYASSERT_SAMPLED(MYASSERT_LEVEL_NORMAL, n, MYASSERT_SOFT_BASE(a, !=, b))
+
+// =============================================================
+// ARRAY ASSERTIONS
+// =============================================================
+
+// Whole-array checks for the type-safe integer families, built on the
+// byte comparison kernels. Only a failure walks the array a second time
+// to count the mismatches and capture the values around the first one.
+
+// Describes a failed array check: the first mismatch goes to a, the
+// number of mismatching elements to b, and up to MYASSERT_ARRAY_WINDOW
+// values around the first mismatch are copied into the captures.
+MYASSERT_COLD
+static void myassert_array_failure(struct myassert_failure *failure, const void *a, const void *b,
+                                   size_t count, size_t size, bool all, size_t first)
+{
+    uint64_t mismatches = myassert_count_mismatches(a, b, count, size, all, first);
+    size_t start;
+    size_t window = myassert_array_window(first, count, size, &start);
+
+    uint64_t index = first;
+    failure->size = size;
+    failure->count = count;
+    memcpy(failure->a, &index, sizeof(index));
+    memcpy(failure->b, &mismatches, sizeof(mismatches));
+    memcpy(failure->capture_a, (const unsigned char *)a + start * size, window * size);
+    for (size_t i = 0; i < window; i++)
+    {
+        const unsigned char *expected = (const unsigned char *)b + (all ? 0 : (start + i) * size);
+        memcpy(failure->capture_b + i * size, expected, size);
+    }
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_array(const struct myassert_site *site, const void *a, const void *b,
+                                size_t count, size_t size, bool all, size_t first)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    myassert_array_failure(&failure, a, b, count, size, all, first);
+    myassert_abort(&failure);
+}
+
+MYASSERT_COLD
+static void myassert_expect_array(const struct myassert_site *site, const void *a, const void *b,
+                                  size_t count, size_t size, bool all, size_t first)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        myassert_array_failure(failure, a, b, count, size, all, first);
+        myassert_expect_done(failure);
+    }
+}
+
+#define ASSERT_ARRAY_BASE(a, b, count, type, conv)                          \
+    do                                                                      \
+    {                                                                       \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                        \
+        {                                                                   \
+            break;                                                          \
+        }                                                                   \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",        \
+                      MYASSERT_SITE_ARRAY, #a, "==", #b, conv);             \
+        MYASSERT_HIT(myassert_site);                                        \
+        const type *const eval_a = (a);                                     \
+        const type *const eval_b = (b);                                     \
+        size_t const eval_count = (count);                                  \
+        size_t const eval_first =                                           \
+            myassert_array_mismatch(eval_a, eval_b, eval_count,             \
+                                    sizeof(type), false, 0);                \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                    \
+        {                                                                   \
+            myassert_fail_array(&myassert_site, eval_a, eval_b, eval_count, \
+                                sizeof(type), false, eval_first);           \
+        }                                                                   \
+    } while (0)
+
+#define ASSERT_ALL_BASE(a, value, count, type, conv)                             \
+    do                                                                           \
+    {                                                                            \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                             \
+        {                                                                        \
+            break;                                                               \
+        }                                                                        \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",             \
+                      MYASSERT_SITE_ARRAY, #a, "==", #value, conv);              \
+        MYASSERT_HIT(myassert_site);                                             \
+        const type *const eval_a = (a);                                          \
+        type const eval_value = (value);                                         \
+        size_t const eval_count = (count);                                       \
+        size_t const eval_first =                                                \
+            myassert_array_mismatch(eval_a, &eval_value, eval_count,             \
+                                    sizeof(type), true, 0);                      \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                         \
+        {                                                                        \
+            myassert_fail_array(&myassert_site, eval_a, &eval_value, eval_count, \
+                                sizeof(type), true, eval_first);                 \
+        }                                                                        \
+    } while (0)
+
+#define EXPECT_ARRAY_BASE(a, b, count, type, conv)                            \
+    do                                                                        \
+    {                                                                         \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                         \
+        {                                                                     \
+            break;                                                            \
+        }                                                                     \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",         \
+                      MYASSERT_SITE_ARRAY, #a, "==", #b, conv);               \
+        MYASSERT_HIT(myassert_site);                                          \
+        const type *const eval_a = (a);                                       \
+        const type *const eval_b = (b);                                       \
+        size_t const eval_count = (count);                                    \
+        size_t const eval_first =                                             \
+            myassert_array_mismatch(eval_a, eval_b, eval_count,               \
+                                    sizeof(type), false, 0);                  \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                      \
+        {                                                                     \
+            myassert_expect_array(&myassert_site, eval_a, eval_b, eval_count, \
+                                  sizeof(type), false, eval_first);           \
+        }                                                                     \
+    } while (0)
+
+#define EXPECT_ALL_BASE(a, value, count, type, conv)                               \
+    do                                                                             \
+    {                                                                              \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                              \
+        {                                                                          \
+            break;                                                                 \
+        }                                                                          \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",              \
+                      MYASSERT_SITE_ARRAY, #a, "==", #value, conv);                \
+        MYASSERT_HIT(myassert_site);                                               \
+        const type *const eval_a = (a);                                            \
+        type const eval_value = (value);                                           \
+        size_t const eval_count = (count);                                         \
+        size_t const eval_first =                                                  \
+            myassert_array_mismatch(eval_a, &eval_value, eval_count,               \
+                                    sizeof(type), true, 0);                        \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                           \
+        {                                                                          \
+            myassert_expect_array(&myassert_site, eval_a, &eval_value, eval_count, \
+                                  sizeof(type), true, eval_first);                 \
+        }                                                                          \
+    } while (0)
+
+// ==============================================
+// INT8_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_INT8(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, int8_t, PRId8)
+
+#define ASSERT_ALL_INT8(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, int8_t, PRId8)
+
+#define EXPECT_EQ_ARRAY_INT8(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, int8_t, PRId8)
+
+#define EXPECT_ALL_INT8(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, int8_t, PRId8)
+
+// ==============================================
+// UINT8_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_UINT8(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, uint8_t, PRIu8)
+
+#define ASSERT_ALL_UINT8(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, uint8_t, PRIu8)
+
+#define EXPECT_EQ_ARRAY_UINT8(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, uint8_t, PRIu8)
+
+#define EXPECT_ALL_UINT8(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, uint8_t, PRIu8)
+
+// ==============================================
+// INT16_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_INT16(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, int16_t, PRId16)
+
+#define ASSERT_ALL_INT16(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, int16_t, PRId16)
+
+#define EXPECT_EQ_ARRAY_INT16(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, int16_t, PRId16)
+
+#define EXPECT_ALL_INT16(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, int16_t, PRId16)
+
+// ==============================================
+// UINT16_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_UINT16(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, uint16_t, PRIu16)
+
+#define ASSERT_ALL_UINT16(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, uint16_t, PRIu16)
+
+#define EXPECT_EQ_ARRAY_UINT16(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, uint16_t, PRIu16)
+
+#define EXPECT_ALL_UINT16(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, uint16_t, PRIu16)
+
+// ==============================================
+// INT32_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_INT32(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, int32_t, PRId32)
+
+#define ASSERT_ALL_INT32(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, int32_t, PRId32)
+
+#define EXPECT_EQ_ARRAY_INT32(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, int32_t, PRId32)
+
+#define EXPECT_ALL_INT32(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, int32_t, PRId32)
+
+// ==============================================
+// UINT32_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_UINT32(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, uint32_t, PRIu32)
+
+#define ASSERT_ALL_UINT32(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, uint32_t, PRIu32)
+
+#define EXPECT_EQ_ARRAY_UINT32(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, uint32_t, PRIu32)
+
+#define EXPECT_ALL_UINT32(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, uint32_t, PRIu32)
+
+// ==============================================
+// INT64_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_INT64(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, int64_t, PRId64)
+
+#define ASSERT_ALL_INT64(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, int64_t, PRId64)
+
+#define EXPECT_EQ_ARRAY_INT64(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, int64_t, PRId64)
+
+#define EXPECT_ALL_INT64(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, int64_t, PRId64)
+
+// ==============================================
+// UINT64_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_UINT64(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, uint64_t, PRIu64)
+
+#define ASSERT_ALL_UINT64(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, uint64_t, PRIu64)
+
+#define EXPECT_EQ_ARRAY_UINT64(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, uint64_t, PRIu64)
+
+#define EXPECT_ALL_UINT64(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, uint64_t, PRIu64)
+
+// ==============================================
+// SIZE_T ARRAY ASSERTIONS
+// ==============================================
+
+#define ASSERT_EQ_ARRAY_SIZE(a, b, count) \
+    ASSERT_ARRAY_BASE(a, b, count, size_t, "zu")
+
+#define ASSERT_ALL_SIZE(a, value, count) \
+    ASSERT_ALL_BASE(a, value, count, size_t, "zu")
+
+#define EXPECT_EQ_ARRAY_SIZE(a, b, count) \
+    EXPECT_ARRAY_BASE(a, b, count, size_t, "zu")
+
+#define EXPECT_ALL_SIZE(a, value, count) \
+    EXPECT_ALL_BASE(a, value, count, size_t, "zu")
+
+// =============================================================
+// FLOATING-POINT TOLERANCES
+// =============================================================
+
+// ASSERT_NEAR_* accept a difference of at most abs, or of at most rel
+// times the larger magnitude. ASSERT_ULP_* accept at most ulps
+// representable values between the operands. Infinities only match
+// themselves. NaN matches NaN unless MYASSERT_NAN_EQUAL is 0, in which
+// case it matches nothing.
+
+#ifndef MYASSERT_NAN_EQUAL
+#define MYASSERT_NAN_EQUAL 1
+#endif
+
+// Distance in units in the last place, with +0 and -0 as one value.
+static inline uint64_t myassert_ulps_float(float a, float b)
+{
+    uint32_t x;
+    uint32_t y;
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+    uint64_t kx = x >> 31 ? 0x80000000u - (uint64_t)(x & 0x7fffffffu) : 0x80000000u + (uint64_t)x;
+    uint64_t ky = y >> 31 ? 0x80000000u - (uint64_t)(y & 0x7fffffffu) : 0x80000000u + (uint64_t)y;
+    return kx > ky ? kx - ky : ky - kx;
+}
+
+static inline uint64_t myassert_ulps_double(double a, double b)
+{
+    const uint64_t sign = UINT64_C(1) << 63;
+    uint64_t x;
+    uint64_t y;
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+    uint64_t kx = (x & sign) != 0 ? sign - (x & ~sign) : sign + x;
+    uint64_t ky = (y & sign) != 0 ? sign - (y & ~sign) : sign + y;
+    return kx > ky ? kx - ky : ky - kx;
+}
+
+static inline bool myassert_near_float(float a, float b, float abs_tol, float rel_tol,
+                                       uint64_t ulps)
+{
+    if (a == b)
+    {
+        return true;
+    }
+    if (a != a || b != b)
+    {
+        return MYASSERT_NAN_EQUAL && a != a && b != b;
+    }
+    float fa = fabsf(a);
+    float fb = fabsf(b);
+    float larger = fa > fb ? fa : fb;
+    if (!(larger <= FLT_MAX))
+    {
+        return false;
+    }
+    float diff = fabsf(a - b);
+    return diff <= abs_tol || diff <= rel_tol * larger || myassert_ulps_float(a, b) <= ulps;
+}
+
+static inline bool myassert_near_double(double a, double b, double abs_tol, double rel_tol,
+                                        uint64_t ulps)
+{
+    if (a == b)
+    {
+        return true;
+    }
+    if (a != a || b != b)
+    {
+        return MYASSERT_NAN_EQUAL && a != a && b != b;
+    }
+    double fa = fabs(a);
+    double fb = fabs(b);
+    double larger = fa > fb ? fa : fb;
+    if (!(larger <= DBL_MAX))
+    {
+        return false;
+    }
+    double diff = fabs(a - b);
+    return diff <= abs_tol || diff <= rel_tol * larger || myassert_ulps_double(a, b) <= ulps;
+}
+
+#if MYASSERT_HAVE_X86_SIMD
+
+// The array kernels only screen elements. A lane passes when both values
+// are equal, or finite and within abs or rel, or of the same sign and at
+// most spacing times the power of two below the smaller magnitude apart.
+// The caller caps spacing at a quarter of that power, so such a lane is
+// never more than ulps apart. The kernels return the first lane that did
+// not pass, or the start of the tail, and the caller rechecks it with
+// myassert_near_*: NaN and distances across a power of two cost a scalar
+// check, never a wrong result.
+
+#if MYASSERT_AVX2
+MYASSERT_ATTR((target("avx2")))
+static inline size_t myassert_far_float_avx2(const float *a, const float *b, size_t from,
+                                             size_t count, float abs_tol, float rel_tol,
+                                             float spacing)
+{
+    const __m256 magnitude = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 exponent = _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000));
+    const __m256 sign = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MIN));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 largest = _mm256_set1_ps(FLT_MAX);
+    const __m256 vabs = _mm256_set1_ps(abs_tol);
+    const __m256 vrel = _mm256_set1_ps(rel_tol);
+    const __m256 vspacing = _mm256_set1_ps(spacing);
+    size_t i = from;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        __m256 fa = _mm256_and_ps(va, magnitude);
+        __m256 fb = _mm256_and_ps(vb, magnitude);
+        __m256 larger = _mm256_max_ps(fa, fb);
+        __m256 smaller = _mm256_min_ps(fa, fb);
+        __m256 diff = _mm256_and_ps(_mm256_sub_ps(va, vb), magnitude);
+        __m256 same = _mm256_or_ps(_mm256_and_ps(_mm256_xor_ps(va, vb), sign), one);
+        __m256 unit = _mm256_mul_ps(_mm256_and_ps(smaller, exponent), vspacing);
+        __m256 near = _mm256_or_ps(
+            _mm256_or_ps(_mm256_cmp_ps(diff, vabs, _CMP_LE_OQ),
+                         _mm256_cmp_ps(diff, _mm256_mul_ps(vrel, larger), _CMP_LE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(same, zero, _CMP_GT_OQ),
+                          _mm256_cmp_ps(diff, unit, _CMP_LE_OQ)));
+        __m256 pass = _mm256_or_ps(_mm256_cmp_ps(va, vb, _CMP_EQ_OQ),
+                                   _mm256_and_ps(_mm256_cmp_ps(larger, largest, _CMP_LE_OQ), near));
+        unsigned mask = (unsigned)_mm256_movemask_ps(pass);
+        if (mask != 0xff)
+        {
+            return i + (size_t)__builtin_ctz(~mask);
+        }
+    }
+    return i;
+}
+#endif
+
+static inline size_t myassert_far_float_sse2(const float *a, const float *b, size_t from,
+                                             size_t count, float abs_tol, float rel_tol,
+                                             float spacing)
+{
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 exponent = _mm_castsi128_ps(_mm_set1_epi32(0x7f800000));
+    const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32(INT32_MIN));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 largest = _mm_set1_ps(FLT_MAX);
+    const __m128 vabs = _mm_set1_ps(abs_tol);
+    const __m128 vrel = _mm_set1_ps(rel_tol);
+    const __m128 vspacing = _mm_set1_ps(spacing);
+    size_t i = from;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 va = _mm_loadu_ps(a + i);
+        __m128 vb = _mm_loadu_ps(b + i);
+        __m128 fa = _mm_and_ps(va, magnitude);
+        __m128 fb = _mm_and_ps(vb, magnitude);
+        __m128 larger = _mm_max_ps(fa, fb);
+        __m128 smaller = _mm_min_ps(fa, fb);
+        __m128 diff = _mm_and_ps(_mm_sub_ps(va, vb), magnitude);
+        __m128 same = _mm_or_ps(_mm_and_ps(_mm_xor_ps(va, vb), sign), one);
+        __m128 unit = _mm_mul_ps(_mm_and_ps(smaller, exponent), vspacing);
+        __m128 near = _mm_or_ps(
+            _mm_or_ps(_mm_cmple_ps(diff, vabs), _mm_cmple_ps(diff, _mm_mul_ps(vrel, larger))),
+            _mm_and_ps(_mm_cmpgt_ps(same, zero), _mm_cmple_ps(diff, unit)));
+        __m128 pass = _mm_or_ps(_mm_cmpeq_ps(va, vb),
+                                _mm_and_ps(_mm_cmple_ps(larger, largest), near));
+        unsigned mask = (unsigned)_mm_movemask_ps(pass);
+        if (mask != 0xf)
+        {
+            return i + (size_t)__builtin_ctz(~mask);
+        }
+    }
+    return i;
+}
+
+#if MYASSERT_AVX2
+MYASSERT_ATTR((target("avx2")))
+static inline size_t myassert_far_double_avx2(const double *a, const double *b, size_t from,
+                                              size_t count, double abs_tol, double rel_tol,
+                                              double spacing)
+{
+    const __m256d magnitude = _mm256_castsi256_pd(_mm256_set1_epi64x(INT64_MAX));
+    const __m256d exponent = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7ff0000000000000));
+    const __m256d sign = _mm256_castsi256_pd(_mm256_set1_epi64x(INT64_MIN));
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d largest = _mm256_set1_pd(DBL_MAX);
+    const __m256d vabs = _mm256_set1_pd(abs_tol);
+    const __m256d vrel = _mm256_set1_pd(rel_tol);
+    const __m256d vspacing = _mm256_set1_pd(spacing);
+    size_t i = from;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d va = _mm256_loadu_pd(a + i);
+        __m256d vb = _mm256_loadu_pd(b + i);
+        __m256d fa = _mm256_and_pd(va, magnitude);
+        __m256d fb = _mm256_and_pd(vb, magnitude);
+        __m256d larger = _mm256_max_pd(fa, fb);
+        __m256d smaller = _mm256_min_pd(fa, fb);
+        __m256d diff = _mm256_and_pd(_mm256_sub_pd(va, vb), magnitude);
+        __m256d same = _mm256_or_pd(_mm256_and_pd(_mm256_xor_pd(va, vb), sign), one);
+        __m256d unit = _mm256_mul_pd(_mm256_and_pd(smaller, exponent), vspacing);
+        __m256d near = _mm256_or_pd(
+            _mm256_or_pd(_mm256_cmp_pd(diff, vabs, _CMP_LE_OQ),
+                         _mm256_cmp_pd(diff, _mm256_mul_pd(vrel, larger), _CMP_LE_OQ)),
+            _mm256_and_pd(_mm256_cmp_pd(same, zero, _CMP_GT_OQ),
+                          _mm256_cmp_pd(diff, unit, _CMP_LE_OQ)));
+        __m256d pass = _mm256_or_pd(_mm256_cmp_pd(va, vb, _CMP_EQ_OQ),
+                                    _mm256_and_pd(_mm256_cmp_pd(larger, largest, _CMP_LE_OQ), near));
+        unsigned mask = (unsigned)_mm256_movemask_pd(pass);
+        if (mask != 0xf)
+        {
+            return i + (size_t)__builtin_ctz(~mask);
+        }
+    }
+    return i;
+}
+#endif
+
+static inline size_t myassert_far_double_sse2(const double *a, const double *b, size_t from,
+                                              size_t count, double abs_tol, double rel_tol,
+                                              double spacing)
+{
+    const __m128d magnitude = _mm_castsi128_pd(_mm_set1_epi64x(INT64_MAX));
+    const __m128d exponent = _mm_castsi128_pd(_mm_set1_epi64x(0x7ff0000000000000));
+    const __m128d sign = _mm_castsi128_pd(_mm_set1_epi64x(INT64_MIN));
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d largest = _mm_set1_pd(DBL_MAX);
+    const __m128d vabs = _mm_set1_pd(abs_tol);
+    const __m128d vrel = _mm_set1_pd(rel_tol);
+    const __m128d vspacing = _mm_set1_pd(spacing);
+    size_t i = from;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d va = _mm_loadu_pd(a + i);
+        __m128d vb = _mm_loadu_pd(b + i);
+        __m128d fa = _mm_and_pd(va, magnitude);
+        __m128d fb = _mm_and_pd(vb, magnitude);
+        __m128d larger = _mm_max_pd(fa, fb);
+        __m128d smaller = _mm_min_pd(fa, fb);
+        __m128d diff = _mm_and_pd(_mm_sub_pd(va, vb), magnitude);
+        __m128d same = _mm_or_pd(_mm_and_pd(_mm_xor_pd(va, vb), sign), one);
+        __m128d unit = _mm_mul_pd(_mm_and_pd(smaller, exponent), vspacing);
+        __m128d near = _mm_or_pd(
+            _mm_or_pd(_mm_cmple_pd(diff, vabs), _mm_cmple_pd(diff, _mm_mul_pd(vrel, larger))),
+            _mm_and_pd(_mm_cmpgt_pd(same, zero), _mm_cmple_pd(diff, unit)));
+        __m128d pass = _mm_or_pd(_mm_cmpeq_pd(va, vb),
+                                 _mm_and_pd(_mm_cmple_pd(larger, largest), near));
+        unsigned mask = (unsigned)_mm_movemask_pd(pass);
+        if (mask != 0x3)
+        {
+            return i + (size_t)__builtin_ctz(~mask);
+        }
+    }
+    return i;
+}
+
+#endif
+
+// Returns the index of the first element at or after from that is out of
+// tolerance, or count.
+static inline size_t myassert_near_array_float(const float *a, const float *b, size_t count,
+                                               float abs_tol, float rel_tol, uint64_t ulps,
+                                               size_t from)
+{
+    size_t i = from;
+#if MYASSERT_HAVE_X86_SIMD
+    int simd = myassert_simd();
+    float spacing = (float)(ulps < (UINT64_C(1) << 21) ? ulps : (UINT64_C(1) << 21)) / 8388608.0f;
+    for (; simd != MYASSERT_SIMD_SCALAR; i++)
+    {
+#if MYASSERT_AVX2
+        i = simd == MYASSERT_SIMD_AVX2
+                ? myassert_far_float_avx2(a, b, i, count, abs_tol, rel_tol, spacing)
+                : myassert_far_float_sse2(a, b, i, count, abs_tol, rel_tol, spacing);
+#else
+        i = myassert_far_float_sse2(a, b, i, count, abs_tol, rel_tol, spacing);
+#endif
+        if (i == count || !myassert_near_float(a[i], b[i], abs_tol, rel_tol, ulps))
+        {
+            return i;
+        }
+    }
+#endif
+    while (i < count && myassert_near_float(a[i], b[i], abs_tol, rel_tol, ulps))
+    {
+        i++;
+    }
+    return i;
+}
+
+static inline size_t myassert_near_array_double(const double *a, const double *b, size_t count,
+                                                double abs_tol, double rel_tol, uint64_t ulps,
+                                                size_t from)
+{
+    size_t i = from;
+#if MYASSERT_HAVE_X86_SIMD
+    int simd = myassert_simd();
+    double spacing = (double)(ulps < (UINT64_C(1) << 50) ? ulps : (UINT64_C(1) << 50)) /
+                     4503599627370496.0;
+    for (; simd != MYASSERT_SIMD_SCALAR; i++)
+    {
+#if MYASSERT_AVX2
+        i = simd == MYASSERT_SIMD_AVX2
+                ? myassert_far_double_avx2(a, b, i, count, abs_tol, rel_tol, spacing)
+                : myassert_far_double_sse2(a, b, i, count, abs_tol, rel_tol, spacing);
+#else
+        i = myassert_far_double_sse2(a, b, i, count, abs_tol, rel_tol, spacing);
+#endif
+        if (i == count || !myassert_near_double(a[i], b[i], abs_tol, rel_tol, ulps))
+        {
+            return i;
+        }
+    }
+#endif
+    while (i < count && myassert_near_double(a[i], b[i], abs_tol, rel_tol, ulps))
+    {
+        i++;
+    }
+    return i;
+}
+
+// Describes a failed tolerance check of count elements, or of one value
+// when count is 0. Every element is visited to find the largest errors.
+// The worst element is the one furthest out of its tolerance.
+MYASSERT_COLD
+static void myassert_tolerance_failure(struct myassert_failure *failure, const void *a,
+                                       const void *b, size_t count, size_t size,
+                                       double abs_tol, double rel_tol, uint64_t ulps,
+                                       size_t first)
+{
+    struct myassert_tolerance *tolerance = &failure->tolerance;
+    uint64_t mismatches = 0;
+    double worst_excess = 0.0;
+    tolerance->abs = abs_tol;
+    tolerance->rel = rel_tol;
+    tolerance->ulps = ulps;
+    tolerance->max_error = 0.0;
+    tolerance->max_ulps = 0;
+    tolerance->worst = first;
+    for (size_t i = 0; i < (count != 0 ? count : 1); i++)
+    {
+        double x;
+        double y;
+        bool near;
+        uint64_t distance;
+        if (size == sizeof(float))
+        {
+            float fx = ((const float *)a)[i];
+            float fy = ((const float *)b)[i];
+            near = myassert_near_float(fx, fy, (float)abs_tol, (float)rel_tol, ulps);
+            distance = myassert_ulps_float(fx, fy);
+            x = fx;
+            y = fy;
+        }
+        else
+        {
+            x = ((const double *)a)[i];
+            y = ((const double *)b)[i];
+            near = myassert_near_double(x, y, abs_tol, rel_tol, ulps);
+            distance = myassert_ulps_double(x, y);
+        }
+
+        double error = fabs(x - y);
+        double excess = HUGE_VAL;
+        if (!isfinite(x) || !isfinite(y))
+        {
+            if (near)
+            {
+                continue;
+            }
+            error = HUGE_VAL;
+            distance = UINT64_MAX;
+        }
+        else
+        {
+            double larger = fabs(x) > fabs(y) ? fabs(x) : fabs(y);
+            if (abs_tol > 0.0)
+            {
+                excess = error / abs_tol;
+            }
+            if (rel_tol > 0.0 && larger > 0.0 && error / (rel_tol * larger) < excess)
+            {
+                excess = error / (rel_tol * larger);
+            }
+            if (ulps > 0 && (double)distance / (double)ulps < excess)
+            {
+                excess = (double)distance / (double)ulps;
+            }
+        }
+        if (error > tolerance->max_error)
+        {
+            tolerance->max_error = error;
+        }
+        if (distance > tolerance->max_ulps)
+        {
+            tolerance->max_ulps = distance;
+        }
+        if (!near && (mismatches++ == 0 || excess > worst_excess))
+        {
+            tolerance->worst = i;
+            worst_excess = excess;
+        }
+    }
+
+    uint64_t index = first;
+    failure->size = size;
+    failure->count = count;
+    memcpy(failure->a, &index, sizeof(index));
+    memcpy(failure->b, &mismatches, sizeof(mismatches));
+    memcpy(failure->capture_a, (const unsigned char *)a + tolerance->worst * size, size);
+    memcpy(failure->capture_b, (const unsigned char *)b + tolerance->worst * size, size);
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_tolerance(const struct myassert_site *site, const void *a,
+                                    const void *b, size_t count, size_t size, double abs_tol,
+                                    double rel_tol, uint64_t ulps, size_t first)
+{
+    struct myassert_failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.site = site;
+    myassert_tolerance_failure(&failure, a, b, count, size, abs_tol, rel_tol, ulps, first);
+    myassert_abort(&failure);
+}
+
+MYASSERT_COLD
+static void myassert_expect_tolerance(const struct myassert_site *site, const void *a,
+                                      const void *b, size_t count, size_t size, double abs_tol,
+                                      double rel_tol, uint64_t ulps, size_t first)
+{
+    struct myassert_failure *failure = myassert_expect_next(site);
+    if (failure != NULL)
+    {
+        myassert_tolerance_failure(failure, a, b, count, size, abs_tol, rel_tol, ulps, first);
+        myassert_expect_done(failure);
+    }
+}
+
+#define ASSERT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, ulps, type)                      \
+    do                                                                                 \
+    {                                                                                  \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                                   \
+        {                                                                              \
+            break;                                                                     \
+        }                                                                              \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",                   \
+                      MYASSERT_SITE_TOLERANCE, #a, "~=", #b, "f");                     \
+        MYASSERT_HIT(myassert_site);                                                   \
+        TYPE_CHECK(a, type);                                                           \
+        TYPE_CHECK(b, type);                                                           \
+        TYPE_CHECK(abs_tol, type);                                                     \
+        TYPE_CHECK(rel_tol, type);                                                     \
+        type const eval_a = (a);                                                       \
+        type const eval_b = (b);                                                       \
+        type const eval_abs = (abs_tol);                                               \
+        type const eval_rel = (rel_tol);                                               \
+        uint64_t const eval_ulps = (ulps);                                             \
+        if (MYASSERT_UNLIKELY(!myassert_near_##type(eval_a, eval_b, eval_abs,          \
+                                                    eval_rel, eval_ulps)))             \
+        {                                                                              \
+            myassert_fail_tolerance(&myassert_site, &eval_a, &eval_b, 0, sizeof(type), \
+                                    eval_abs, eval_rel, eval_ulps, 0);                 \
+        }                                                                              \
+    } while (0)
+
+#define ASSERT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, ulps, type)                \
+    do                                                                                        \
+    {                                                                                         \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                                          \
+        {                                                                                     \
+            break;                                                                            \
+        }                                                                                     \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",                          \
+                      MYASSERT_SITE_TOLERANCE, #a, "~=", #b, "f");                            \
+        MYASSERT_HIT(myassert_site);                                                          \
+        TYPE_CHECK(abs_tol, type);                                                            \
+        TYPE_CHECK(rel_tol, type);                                                            \
+        const type *const eval_a = (a);                                                       \
+        const type *const eval_b = (b);                                                       \
+        size_t const eval_count = (count);                                                    \
+        type const eval_abs = (abs_tol);                                                      \
+        type const eval_rel = (rel_tol);                                                      \
+        uint64_t const eval_ulps = (ulps);                                                    \
+        size_t const eval_first =                                                             \
+            myassert_near_array_##type(eval_a, eval_b, eval_count, eval_abs,                  \
+                                       eval_rel, eval_ulps, 0);                               \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                                      \
+        {                                                                                     \
+            myassert_fail_tolerance(&myassert_site, eval_a, eval_b, eval_count, sizeof(type), \
+                                    eval_abs, eval_rel, eval_ulps, eval_first);               \
+        }                                                                                     \
     } while (0)
 
-#define ASSERT_LT_INT16(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int16_t);                \
-        TYPE_CHECK(b, int16_t);                \
-        ASSERT_BASE(a, <, b, int16_t, PRId16); \
-    } while (0)
+#define EXPECT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, ulps, type)                        \
+    do                                                                                   \
+    {                                                                                    \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                                    \
+        {                                                                                \
+            break;                                                                       \
+        }                                                                                \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",                    \
+                      MYASSERT_SITE_TOLERANCE, #a, "~=", #b, "f");                       \
+        MYASSERT_HIT(myassert_site);                                                     \
+        TYPE_CHECK(a, type);                                                             \
+        TYPE_CHECK(b, type);                                                             \
+        TYPE_CHECK(abs_tol, type);                                                       \
+        TYPE_CHECK(rel_tol, type);                                                       \
+        type const eval_a = (a);                                                         \
+        type const eval_b = (b);                                                         \
+        type const eval_abs = (abs_tol);                                                 \
+        type const eval_rel = (rel_tol);                                                 \
+        uint64_t const eval_ulps = (ulps);                                               \
+        if (MYASSERT_UNLIKELY(!myassert_near_##type(eval_a, eval_b, eval_abs,            \
+                                                    eval_rel, eval_ulps)))               \
+        {                                                                                \
+            myassert_expect_tolerance(&myassert_site, &eval_a, &eval_b, 0, sizeof(type), \
+                                      eval_abs, eval_rel, eval_ulps, 0);                 \
+        }                                                                                \
+    } while (0)
+
+#define EXPECT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, ulps, type)                  \
+    do                                                                                          \
+    {                                                                                           \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                                           \
+        {                                                                                       \
+            break;                                                                              \
+        }                                                                                       \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",                           \
+                      MYASSERT_SITE_TOLERANCE, #a, "~=", #b, "f");                              \
+        MYASSERT_HIT(myassert_site);                                                            \
+        TYPE_CHECK(abs_tol, type);                                                              \
+        TYPE_CHECK(rel_tol, type);                                                              \
+        const type *const eval_a = (a);                                                         \
+        const type *const eval_b = (b);                                                         \
+        size_t const eval_count = (count);                                                      \
+        type const eval_abs = (abs_tol);                                                        \
+        type const eval_rel = (rel_tol);                                                        \
+        uint64_t const eval_ulps = (ulps);                                                      \
+        size_t const eval_first =                                                               \
+            myassert_near_array_##type(eval_a, eval_b, eval_count, eval_abs,                    \
+                                       eval_rel, eval_ulps, 0);                                 \
+        if (MYASSERT_UNLIKELY(eval_first != eval_count))                                        \
+        {                                                                                       \
+            myassert_expect_tolerance(&myassert_site, eval_a, eval_b, eval_count, sizeof(type), \
+                                      eval_abs, eval_rel, eval_ulps, eval_first);               \
+        }                                                                                       \
+    } while (0)
+
+// ==============================================
+// FLOAT TOLERANCES
+// ==============================================
+
+#define ASSERT_NEAR_FLOAT(a, b, abs_tol, rel_tol) \
+    ASSERT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, 0, float)
+
+#define ASSERT_ULP_FLOAT(a, b, ulps) \
+    ASSERT_TOLERANCE_BASE(a, b, 0.0f, 0.0f, ulps, float)
+
+#define ASSERT_NEAR_ARRAY_FLOAT(a, b, count, abs_tol, rel_tol) \
+    ASSERT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, 0, float)
+
+#define ASSERT_ULP_ARRAY_FLOAT(a, b, count, ulps) \
+    ASSERT_TOLERANCE_ARRAY_BASE(a, b, count, 0.0f, 0.0f, ulps, float)
+
+#define EXPECT_NEAR_FLOAT(a, b, abs_tol, rel_tol) \
+    EXPECT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, 0, float)
+
+#define EXPECT_ULP_FLOAT(a, b, ulps) \
+    EXPECT_TOLERANCE_BASE(a, b, 0.0f, 0.0f, ulps, float)
+
+#define EXPECT_NEAR_ARRAY_FLOAT(a, b, count, abs_tol, rel_tol) \
+    EXPECT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, 0, float)
+
+#define EXPECT_ULP_ARRAY_FLOAT(a, b, count, ulps) \
+    EXPECT_TOLERANCE_ARRAY_BASE(a, b, count, 0.0f, 0.0f, ulps, float)
+
+// ==============================================
+// DOUBLE TOLERANCES
+// ==============================================
+
+#define ASSERT_NEAR_DOUBLE(a, b, abs_tol, rel_tol) \
+    ASSERT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, 0, double)
+
+#define ASSERT_ULP_DOUBLE(a, b, ulps) \
+    ASSERT_TOLERANCE_BASE(a, b, 0.0, 0.0, ulps, double)
+
+#define ASSERT_NEAR_ARRAY_DOUBLE(a, b, count, abs_tol, rel_tol) \
+    ASSERT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, 0, double)
+
+#define ASSERT_ULP_ARRAY_DOUBLE(a, b, count, ulps) \
+    ASSERT_TOLERANCE_ARRAY_BASE(a, b, count, 0.0, 0.0, ulps, double)
+
+#define EXPECT_NEAR_DOUBLE(a, b, abs_tol, rel_tol) \
+    EXPECT_TOLERANCE_BASE(a, b, abs_tol, rel_tol, 0, double)
+
+#define EXPECT_ULP_DOUBLE(a, b, ulps) \
+    EXPECT_TOLERANCE_BASE(a, b, 0.0, 0.0, ulps, double)
+
+#define EXPECT_NEAR_ARRAY_DOUBLE(a, b, count, abs_tol, rel_tol) \
+    EXPECT_TOLERANCE_ARRAY_BASE(a, b, count, abs_tol, rel_tol, 0, double)
+
+#define EXPECT_ULP_ARRAY_DOUBLE(a, b, count, ulps) \
+    EXPECT_TOLERANCE_ARRAY_BASE(a, b, count, 0.0, 0.0, ulps, double)
+
+// =============================================================
+// FILE ASSERTIONS
+// =============================================================
+
+// ASSERT_FILE_EQ* compare files one window at a time, so memory use is
+// the same for any file size. Regular files are mapped
+// MYASSERT_FILE_WINDOW bytes at a time. Other files, and files that
+// cannot be mapped, are read into one buffer of that size. Only a failure
+// goes back to count lines and capture the data around the difference.
+
+#ifndef MYASSERT_FILE_WINDOW
+#define MYASSERT_FILE_WINDOW (16u << 20)
+#endif
+
+#if MYASSERT_HAVE_POSIX
+#define MYASSERT_FSEEK fseeko
+#define MYASSERT_FTELL ftello
+#define MYASSERT_OFFSET off_t
+#else
+#define MYASSERT_FSEEK fseek
+#define MYASSERT_FTELL ftell
+#define MYASSERT_OFFSET long
+#endif
+
+enum myassert_stream_mode
+{
+    MYASSERT_STREAM_MEMORY,
+    MYASSERT_STREAM_MAP,
+    MYASSERT_STREAM_READ
+};
+
+struct myassert_stream
+{
+    const char *path;
+    int mode;
+    FILE *file;
+    const unsigned char *memory;
+    uint64_t size;
+    uint64_t offset;
+    const unsigned char *window;
+    size_t len;
+    void *map;
+    unsigned char *chunk;
+    int error;
+};
+
+static inline void myassert_stream_open(struct myassert_stream *stream, const char *path,
+                                        const void *memory, size_t len)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->path = path;
+    stream->size = UINT64_MAX;
+    if (path == NULL)
+    {
+        stream->mode = MYASSERT_STREAM_MEMORY;
+        stream->memory = (const unsigned char *)memory;
+        stream->size = len;
+        return;
+    }
+
+    stream->mode = MYASSERT_STREAM_READ;
+    stream->file = fopen(path, "rb");
+    if (stream->file == NULL)
+    {
+        stream->error = errno;
+        return;
+    }
+#if MYASSERT_HAVE_POSIX
+    struct stat st;
+    if (fstat(fileno(stream->file), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        stream->mode = MYASSERT_STREAM_MAP;
+        stream->size = (uint64_t)st.st_size;
+    }
+#endif
+}
+
+static inline void myassert_stream_unmap(struct myassert_stream *stream)
+{
+#if MYASSERT_HAVE_POSIX
+    if (stream->map != NULL)
+    {
+        munmap(stream->map, stream->len);
+        stream->map = NULL;
+    }
+#else
+    (void)stream;
+#endif
+}
+
+static inline void myassert_stream_close(struct myassert_stream *stream)
+{
+    myassert_stream_unmap(stream);
+    free(stream->chunk);
+    if (stream->file != NULL)
+    {
+        fclose(stream->file);
+    }
+}
+
+// Moves to the next window, which is MYASSERT_FILE_WINDOW bytes long
+// unless the stream ends in it.
+static inline void myassert_stream_next(struct myassert_stream *stream)
+{
+    myassert_stream_unmap(stream);
+    stream->offset += stream->len;
+    stream->len = 0;
+    if (stream->error != 0)
+    {
+        return;
+    }
 
-#define ASSERT_NE_INT16(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int16_t);                 \
-        TYPE_CHECK(b, int16_t);                 \
-        ASSERT_BASE(a, !=, b, int16_t, PRId16); \
-    } while (0)
+    uint64_t left = stream->size > stream->offset ? stream->size - stream->offset : 0;
+    size_t n = left < MYASSERT_FILE_WINDOW ? (size_t)left : MYASSERT_FILE_WINDOW;
+    if (stream->mode == MYASSERT_STREAM_MEMORY)
+    {
+        stream->window = stream->memory + stream->offset;
+        stream->len = n;
+        return;
+    }
+#if MYASSERT_HAVE_POSIX
+    if (stream->mode == MYASSERT_STREAM_MAP)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+        void *map = mmap(NULL, n, PROT_READ, MAP_PRIVATE, fileno(stream->file),
+                         (MYASSERT_OFFSET)stream->offset);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, n, MADV_SEQUENTIAL);
+            stream->map = map;
+            stream->window = (const unsigned char *)map;
+            stream->len = n;
+            return;
+        }
+        stream->mode = MYASSERT_STREAM_READ;
+        if (MYASSERT_FSEEK(stream->file, (MYASSERT_OFFSET)stream->offset, SEEK_SET) != 0)
+        {
+            stream->error = errno;
+            return;
+        }
+    }
+#endif
 
-// ==============================================
-// UINT16_T ASSERTIONS
-// ==============================================
+    if (stream->chunk == NULL)
+    {
+        stream->chunk = (unsigned char *)malloc(MYASSERT_FILE_WINDOW);
+        if (stream->chunk == NULL)
+        {
+            stream->error = ENOMEM;
+            return;
+        }
+    }
+    stream->window = stream->chunk;
+    stream->len = fread(stream->chunk, 1, MYASSERT_FILE_WINDOW, stream->file);
+    if (stream->len < MYASSERT_FILE_WINDOW && ferror(stream->file))
+    {
+        stream->error = errno != 0 ? errno : EIO;
+    }
+}
 
-#define ASSERT_EQ_UINT16(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint16_t);                 \
-        TYPE_CHECK(b, uint16_t);                 \
-        ASSERT_BASE(a, ==, b, uint16_t, PRIu16); \
-    } while (0)
+// Copies up to n bytes at offset, from the current window when a pipe
+// cannot seek back to them. Returns the number of bytes copied.
+static inline size_t myassert_stream_peek(struct myassert_stream *stream, uint64_t offset,
+                                          unsigned char *dst, size_t n)
+{
+    if (stream->mode == MYASSERT_STREAM_MEMORY)
+    {
+        if (offset >= stream->size)
+        {
+            return 0;
+        }
+        n = n < stream->size - offset ? n : (size_t)(stream->size - offset);
+        memcpy(dst, stream->memory + offset, n);
+        return n;
+    }
+    if (MYASSERT_FSEEK(stream->file, (MYASSERT_OFFSET)offset, SEEK_SET) == 0)
+    {
+        return fread(dst, 1, n, stream->file);
+    }
+    if (offset < stream->offset || offset >= stream->offset + stream->len)
+    {
+        return 0;
+    }
+    size_t at = (size_t)(offset - stream->offset);
+    n = n < stream->len - at ? n : stream->len - at;
+    memcpy(dst, stream->window + at, n);
+    return n;
+}
 
-#define ASSERT_GE_UINT16(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint16_t);                 \
-        TYPE_CHECK(b, uint16_t);                 \
-        ASSERT_BASE(a, >=, b, uint16_t, PRIu16); \
-    } while (0)
+// Finds the size of a stream that was not known up front, reading a pipe
+// to its end.
+static inline void myassert_stream_measure(struct myassert_stream *stream)
+{
+    if (stream->size != UINT64_MAX || stream->error != 0)
+    {
+        return;
+    }
+    if (MYASSERT_FSEEK(stream->file, 0, SEEK_END) == 0)
+    {
+        stream->size = (uint64_t)MYASSERT_FTELL(stream->file);
+        return;
+    }
+    while (stream->len > 0 && stream->error == 0)
+    {
+        myassert_stream_next(stream);
+    }
+    stream->size = stream->offset;
+}
 
-#define ASSERT_GT_UINT16(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint16_t);                \
-        TYPE_CHECK(b, uint16_t);                \
-        ASSERT_BASE(a, >, b, uint16_t, PRIu16); \
-    } while (0)
+// Counts the lines before offset and whether they hold a NUL byte.
+// Returns false for a pipe, which cannot be read again.
+static inline bool myassert_stream_lines(struct myassert_stream *stream, uint64_t offset,
+                                         uint64_t *lines, bool *binary)
+{
+    myassert_stream_unmap(stream);
+    if (stream->file != NULL && MYASSERT_FSEEK(stream->file, 0, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    stream->offset = 0;
+    stream->len = 0;
+    *lines = 1;
+    *binary = false;
+    for (myassert_stream_next(stream); stream->len > 0 && stream->offset < offset;
+         myassert_stream_next(stream))
+    {
+        size_t n = offset - stream->offset < stream->len ? (size_t)(offset - stream->offset)
+                                                          : stream->len;
+        const unsigned char *p = stream->window;
+        const unsigned char *end = p + n;
+        while ((p = (const unsigned char *)memchr(p, '\n', (size_t)(end - p))) != NULL)
+        {
+            (*lines)++;
+            p++;
+        }
+        *binary = *binary || memchr(stream->window, '\0', n) != NULL;
+    }
+    return stream->error == 0;
+}
 
-#define ASSERT_LE_UINT16(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint16_t);                 \
-        TYPE_CHECK(b, uint16_t);                 \
-        ASSERT_BASE(a, <=, b, uint16_t, PRIu16); \
-    } while (0)
+// Copies the line around offset as text, replacing control characters.
+// Returns false if the captured bytes look binary.
+static inline bool myassert_capture_line(char *dst, const unsigned char *data, size_t len,
+                                         size_t at, bool clipped)
+{
+    size_t start = at;
+    while (start > 0 && data[start - 1] != '\n')
+    {
+        start--;
+    }
+    size_t n = 0;
+    if (start == 0 && clipped)
+    {
+        memcpy(dst, "...", 3);
+        n = 3;
+    }
+    for (size_t i = start; i < len && data[i] != '\n' && n < MYASSERT_EXPECT_CAPTURE - 1; i++)
+    {
+        if (data[i] == '\0')
+        {
+            return false;
+        }
+        dst[n++] = data[i] < 0x20 || data[i] == 0x7f ? '.' : (char)data[i];
+    }
+    dst[n] = '\0';
+    return true;
+}
 
-#define ASSERT_LT_UINT16(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint16_t);                \
-        TYPE_CHECK(b, uint16_t);                \
-        ASSERT_BASE(a, <, b, uint16_t, PRIu16); \
-    } while (0)
+// Describes two streams that differ at first, or an error of either one.
+MYASSERT_COLD
+static void myassert_file_failure(struct myassert_failure *failure, struct myassert_stream *a,
+                                  struct myassert_stream *b, uint64_t first)
+{
+    memset(failure->a, 0, sizeof(failure->a));
+    memset(failure->b, 0, sizeof(failure->b));
+    failure->error = a->error != 0 ? a->error : b->error;
+    if (failure->error != 0)
+    {
+        const char *path = a->error != 0 ? a->path : b->path;
+        myassert_capture_text(failure->capture_a, path, SIZE_MAX);
+        myassert_capture_text(failure->capture_b, strerror(failure->error), SIZE_MAX);
+        return;
+    }
 
-#define ASSERT_NE_UINT16(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint16_t);                 \
-        TYPE_CHECK(b, uint16_t);                 \
-        ASSERT_BASE(a, !=, b, uint16_t, PRIu16); \
-    } while (0)
+    // Both captures are taken before a pipe is drained to find its size.
+    // Text starts up to a third of a capture before the difference.
+    unsigned char data_a[MYASSERT_EXPECT_CAPTURE];
+    unsigned char data_b[MYASSERT_EXPECT_CAPTURE];
+    uint64_t back = first < MYASSERT_EXPECT_CAPTURE / 3 ? first : MYASSERT_EXPECT_CAPTURE / 3;
+    size_t len_a = myassert_stream_peek(a, first - back, data_a, sizeof(data_a));
+    size_t len_b = myassert_stream_peek(b, first - back, data_b, sizeof(data_b));
+    unsigned char rows_a[MYASSERT_EXPECT_CAPTURE] = {0};
+    unsigned char rows_b[MYASSERT_EXPECT_CAPTURE] = {0};
+    size_t start;
+    size_t window = myassert_memory_window((size_t)first, SIZE_MAX, &start);
+    myassert_stream_peek(a, start, rows_a, window);
+    myassert_stream_peek(b, start, rows_b, window);
+    bool text = myassert_capture_line(failure->capture_a, data_a, len_a, (size_t)back,
+                                      first > back);
+    text = myassert_capture_line(failure->capture_b, data_b, len_b, (size_t)back,
+                                 first > back) && text;
 
-// ==============================================
-// INT32_T ASSERTIONS
-// ==============================================
+    myassert_stream_measure(a);
+    myassert_stream_measure(b);
+    failure->count = (size_t)a->size;
+    failure->count_b = (size_t)b->size;
 
-#define ASSERT_EQ_INT32(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int32_t);                 \
-        TYPE_CHECK(b, int32_t);                 \
-        ASSERT_BASE(a, ==, b, int32_t, PRId32); \
+    uint64_t lines = 0;
+    bool binary = true;
+    if (!myassert_stream_lines(a, first, &lines, &binary) &&
+        !myassert_stream_lines(b, first, &lines, &binary))
+    {
+        lines = 0;
+        binary = true;
+    }
+    if (!text || binary)
+    {
+        lines = 0;
+        memcpy(failure->capture_a, rows_a, sizeof(rows_a));
+        memcpy(failure->capture_b, rows_b, sizeof(rows_b));
+    }
+    failure->size = 1;
+    memcpy(failure->a, &first, sizeof(first));
+    memcpy(failure->b, &lines, sizeof(lines));
+}
+
+// Compares the file at path_a with the file at path_b, or with len bytes
+// at memory when path_b is NULL. Fills in failure if they differ.
+static inline bool myassert_compare_file(const char *path_a, const char *path_b,
+                                         const void *memory, size_t len,
+                                         struct myassert_failure *failure)
+{
+    struct myassert_stream a;
+    struct myassert_stream b;
+    myassert_stream_open(&a, path_a, NULL, 0);
+    myassert_stream_open(&b, path_b, memory, len);
+
+    bool equal = false;
+    for (;;)
+    {
+        myassert_stream_next(&a);
+        myassert_stream_next(&b);
+        if (MYASSERT_UNLIKELY(a.error != 0 || b.error != 0))
+        {
+            myassert_file_failure(failure, &a, &b, 0);
+            break;
+        }
+        size_t n = a.len < b.len ? a.len : b.len;
+        size_t at = myassert_array_mismatch(a.window, b.window, n, 1, false, 0);
+        if (MYASSERT_UNLIKELY(at != n || a.len != b.len))
+        {
+            myassert_file_failure(failure, &a, &b, a.offset + at);
+            break;
+        }
+        if (n == 0)
+        {
+            equal = true;
+            break;
+        }
+    }
+    myassert_stream_close(&a);
+    myassert_stream_close(&b);
+    return equal;
+}
+
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void myassert_fail_file(const struct myassert_site *site, struct myassert_failure *failure)
+{
+    failure->site = site;
+    myassert_abort(failure);
+}
+
+MYASSERT_COLD
+static void myassert_expect_file(const struct myassert_site *site,
+                                 const struct myassert_failure *failure)
+{
+    struct myassert_failure *record = myassert_expect_next(site);
+    if (record != NULL)
+    {
+        *record = *failure;
+        record->site = site;
+        myassert_expect_done(record);
+    }
+}
+
+#define ASSERT_BASE_FILE(a, b, path_b, memory, len)                          \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                         \
+        {                                                                    \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",         \
+                      MYASSERT_SITE_FILE, #a, "==", #b, "s");                \
+        MYASSERT_HIT(myassert_site);                                         \
+        struct myassert_failure eval_failure;                                \
+        if (MYASSERT_UNLIKELY(!myassert_compare_file(a, path_b, memory, len, \
+                                                     &eval_failure)))        \
+        {                                                                    \
+            myassert_fail_file(&myassert_site, &eval_failure);               \
+        }                                                                    \
     } while (0)
 
-#define ASSERT_GE_INT32(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int32_t);                 \
-        TYPE_CHECK(b, int32_t);                 \
-        ASSERT_BASE(a, >=, b, int32_t, PRId32); \
+#define EXPECT_BASE_FILE(a, b, path_b, memory, len)                          \
+    do                                                                       \
+    {                                                                        \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                        \
+        {                                                                    \
+            break;                                                           \
+        }                                                                    \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",        \
+                      MYASSERT_SITE_FILE, #a, "==", #b, "s");                \
+        MYASSERT_HIT(myassert_site);                                         \
+        struct myassert_failure eval_failure;                                \
+        if (MYASSERT_UNLIKELY(!myassert_compare_file(a, path_b, memory, len, \
+                                                     &eval_failure)))        \
+        {                                                                    \
+            myassert_expect_file(&myassert_site, &eval_failure);             \
+        }                                                                    \
     } while (0)
 
-#define ASSERT_GT_INT32(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int32_t);                \
-        TYPE_CHECK(b, int32_t);                \
-        ASSERT_BASE(a, >, b, int32_t, PRId32); \
+#define ASSERT_FILE_EQ(path_a, path_b) \
+    ASSERT_BASE_FILE(path_a, path_b, path_b, NULL, 0)
+
+#define ASSERT_FILE_EQ_MEM(path, buf, len) \
+    ASSERT_BASE_FILE(path, buf, NULL, buf, len)
+
+#define EXPECT_FILE_EQ(path_a, path_b) \
+    EXPECT_BASE_FILE(path_a, path_b, path_b, NULL, 0)
+
+#define EXPECT_FILE_EQ_MEM(path, buf, len) \
+    EXPECT_BASE_FILE(path, buf, NULL, buf, len)
+
+// =============================================================
+// SNAPSHOTS
+// =============================================================
+
+// ASSERT_SNAPSHOT compares a buffer with a named snapshot. All snapshots
+// live in one store file, MYASSERT_SNAPSHOTS (default "myassert.snap"),
+// which is mapped on first use. Its index is sorted by name hash, so each
+// lookup is a binary search.
+//
+// With MYASSERT_SNAPSHOT_UPDATE=1, a missing or different snapshot is
+// appended to a journal next to the store instead of failing. Each record
+// is a single write(2) in append mode, so parallel and forked tests can
+// record at the same time. The journal is merged into the store when the
+// tests finish. The store uses the byte order of the machine that wrote it.
+
+#if MYASSERT_HAVE_POSIX
+
+#define MYASSERT_SNAPSHOT_MAGIC "MYSNAP1\n"
+#define MYASSERT_SNAPSHOT_HEADER 16
+
+struct myassert_snapshot_entry
+{
+    uint64_t hash;
+    uint64_t name;
+    uint64_t name_len;
+    uint64_t data;
+    uint64_t data_len;
+};
+
+struct myassert_snapshot_store
+{
+    const unsigned char *map;
+    size_t size;
+    const struct myassert_snapshot_entry *entries;
+    uint64_t count;
+};
+
+MYASSERT_SHARED struct myassert_snapshot_store myassert_snapshots;
+MYASSERT_SHARED int myassert_snapshots_loaded;
+MYASSERT_SHARED int myassert_snapshots_recorded;
+MYASSERT_SHARED pthread_mutex_t myassert_snapshots_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline const char *myassert_snapshot_path(void)
+{
+    const char *path = getenv("MYASSERT_SNAPSHOTS");
+    return path != NULL && path[0] != '\0' ? path : "myassert.snap";
+}
+
+static inline uint64_t myassert_snapshot_hash(const char *name, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)name[i]) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+// Maps a store and checks that its index stays inside the file. A missing
+// store is empty; a damaged one is reported and treated as empty.
+static inline bool myassert_snapshot_map(struct myassert_snapshot_store *store, const char *path)
+{
+    memset(store, 0, sizeof(*store));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= MYASSERT_SNAPSHOT_HEADER)
+    {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    store->map = (const unsigned char *)map;
+    store->size = (size_t)st.st_size;
+    store->entries = (const struct myassert_snapshot_entry *)(store->map + MYASSERT_SNAPSHOT_HEADER);
+    memcpy(&store->count, store->map + 8, sizeof(store->count));
+    bool valid = memcmp(store->map, MYASSERT_SNAPSHOT_MAGIC, 8) == 0 &&
+                 store->count <= (store->size - MYASSERT_SNAPSHOT_HEADER) / sizeof(*store->entries);
+    for (uint64_t i = 0; valid && i < store->count; i++)
+    {
+        const struct myassert_snapshot_entry *entry = &store->entries[i];
+        valid = entry->name <= store->size && entry->name_len <= store->size - entry->name &&
+                entry->data <= store->size && entry->data_len <= store->size - entry->data;
+    }
+    if (!valid)
+    {
+        fprintf(stderr, "myassert: ignoring damaged snapshot store %s\n", path);
+        munmap(map, store->size);
+        memset(store, 0, sizeof(*store));
+        return false;
+    }
+    return true;
+}
+
+static inline const struct myassert_snapshot_entry *myassert_snapshot_find(
+    const struct myassert_snapshot_store *store, const char *name, size_t name_len)
+{
+    uint64_t hash = myassert_snapshot_hash(name, name_len);
+    size_t low = 0;
+    size_t high = (size_t)store->count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (store->entries[mid].hash < hash)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    for (; low < store->count && store->entries[low].hash == hash; low++)
+    {
+        const struct myassert_snapshot_entry *entry = &store->entries[low];
+        if (entry->name_len == name_len && memcmp(store->map + entry->name, name, name_len) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static inline const struct myassert_snapshot_store *myassert_snapshot_store(void)
+{
+    if (!__atomic_load_n(&myassert_snapshots_loaded, __ATOMIC_ACQUIRE))
+    {
+        pthread_mutex_lock(&myassert_snapshots_lock);
+        if (!myassert_snapshots_loaded)
+        {
+            myassert_snapshot_map(&myassert_snapshots, myassert_snapshot_path());
+            __atomic_store_n(&myassert_snapshots_loaded, 1, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&myassert_snapshots_lock);
+    }
+    return &myassert_snapshots;
+}
+
+// The journal of the store, or the copy a merge of process id took.
+static inline void myassert_snapshot_journal(char *path, size_t size, long id)
+{
+    if (id != 0)
+    {
+        snprintf(path, size, "%s.journal.%ld", myassert_snapshot_path(), id);
+    }
+    else
+    {
+        snprintf(path, size, "%s.journal", myassert_snapshot_path());
+    }
+}
+
+struct myassert_snapshot_item
+{
+    uint64_t hash;
+    const unsigned char *name;
+    uint64_t name_len;
+    const unsigned char *data;
+    uint64_t data_len;
+    size_t order;
+};
+
+static inline bool myassert_snapshot_same(const struct myassert_snapshot_item *x,
+                                          const struct myassert_snapshot_item *y)
+{
+    return x->hash == y->hash && x->name_len == y->name_len &&
+           memcmp(x->name, y->name, (size_t)x->name_len) == 0;
+}
+
+// Orders items by hash and name, the newest record of a name first.
+static inline int myassert_compare_snapshot_items(const void *a, const void *b)
+{
+    const struct myassert_snapshot_item *x = (const struct myassert_snapshot_item *)a;
+    const struct myassert_snapshot_item *y = (const struct myassert_snapshot_item *)b;
+    if (x->hash != y->hash)
+    {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    if (x->name_len != y->name_len)
+    {
+        return x->name_len < y->name_len ? -1 : 1;
+    }
+    int order = memcmp(x->name, y->name, (size_t)x->name_len);
+    if (order != 0)
+    {
+        return order;
+    }
+    return x->order > y->order ? -1 : x->order < y->order ? 1 : 0;
+}
+
+// Writes the store with every journal record, the newest record of each
+// name winning, and removes the journal. The journal is renamed first so
+// that records appended meanwhile go to a fresh one.
+static inline void myassert_snapshot_merge(void)
+{
+    char journal[4096];
+    char taken[4096];
+    myassert_snapshot_journal(journal, sizeof(journal), 0);
+    myassert_snapshot_journal(taken, sizeof(taken), (long)getpid());
+    if (rename(journal, taken) != 0)
+    {
+        return;
+    }
+
+    const char *path = myassert_snapshot_path();
+    struct myassert_snapshot_store old;
+    myassert_snapshot_map(&old, path);
+    int fd = open(taken, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    const unsigned char *records = NULL;
+    size_t size = 0;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            records = (const unsigned char *)map;
+            size = (size_t)st.st_size;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    size_t capacity = (size_t)old.count + size / MYASSERT_SNAPSHOT_HEADER;
+    struct myassert_snapshot_item *items = (struct myassert_snapshot_item *)malloc(
+        (capacity + 1) * sizeof(*items));
+    size_t count = 0;
+    size_t recorded = 0;
+    for (uint64_t i = 0; items != NULL && i < old.count; i++, count++)
+    {
+        const struct myassert_snapshot_entry *entry = &old.entries[i];
+        struct myassert_snapshot_item item = {entry->hash, old.map + entry->name, entry->name_len,
+                                              old.map + entry->data, entry->data_len, count};
+        items[count] = item;
+    }
+    for (size_t at = 0; items != NULL && size - at >= MYASSERT_SNAPSHOT_HEADER; count++)
+    {
+        uint64_t lengths[2];
+        memcpy(lengths, records + at, sizeof(lengths));
+        at += MYASSERT_SNAPSHOT_HEADER;
+        if (lengths[0] > size - at || lengths[1] > size - at - lengths[0])
+        {
+            break;
+        }
+        const char *name = (const char *)records + at;
+        struct myassert_snapshot_item item = {myassert_snapshot_hash(name, (size_t)lengths[0]),
+                                              records + at, lengths[0],
+                                              records + at + lengths[0], lengths[1], count};
+        items[count] = item;
+        at += (size_t)(lengths[0] + lengths[1]);
+        recorded++;
+    }
+
+    char temp[4096];
+    snprintf(temp, sizeof(temp), "%s.%ld", path, (long)getpid());
+    FILE *file = items != NULL ? fopen(temp, "wb") : NULL;
+    if (file != NULL)
+    {
+        qsort(items, count, sizeof(*items), myassert_compare_snapshot_items);
+        size_t unique = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (unique == 0 || !myassert_snapshot_same(&items[unique - 1], &items[i]))
+            {
+                items[unique++] = items[i];
+            }
+        }
+
+        uint64_t total = unique;
+        uint64_t offset = MYASSERT_SNAPSHOT_HEADER + unique * sizeof(struct myassert_snapshot_entry);
+        fwrite(MYASSERT_SNAPSHOT_MAGIC, 1, 8, file);
+        fwrite(&total, sizeof(total), 1, file);
+        for (size_t i = 0; i < unique; i++)
+        {
+            struct myassert_snapshot_entry entry = {items[i].hash, offset, items[i].name_len,
+                                                    offset + items[i].name_len,
+                                                    items[i].data_len};
+            fwrite(&entry, sizeof(entry), 1, file);
+            offset += items[i].name_len + items[i].data_len;
+        }
+        for (size_t i = 0; i < unique; i++)
+        {
+            fwrite(items[i].name, 1, (size_t)items[i].name_len, file);
+            fwrite(items[i].data, 1, (size_t)items[i].data_len, file);
+        }
+        bool written = !ferror(file);
+        if (fclose(file) == 0 && written && rename(temp, path) == 0)
+        {
+            unlink(taken);
+            fprintf(stderr, "myassert: recorded %zu snapshots in %s\n", recorded, path);
+        }
+        else
+        {
+            fprintf(stderr, "myassert: cannot write snapshot store %s\n", path);
+            unlink(temp);
+            rename(taken, journal);
+        }
+    }
+    free(items);
+    if (records != NULL)
+    {
+        munmap((void *)records, size);
+    }
+    if (old.map != NULL)
+    {
+        munmap((void *)old.map, old.size);
+    }
+}
+
+// Appends a snapshot to the journal and makes sure this process merges it
+// when it exits. Forked tests exit without merging; the runner merges
+// their records when all tests are done.
+static inline bool myassert_snapshot_record(const char *name, const void *buf, size_t len)
+{
+    char journal[4096];
+    myassert_snapshot_journal(journal, sizeof(journal), 0);
+    uint64_t lengths[2] = {strlen(name), len};
+    size_t total = MYASSERT_SNAPSHOT_HEADER + (size_t)lengths[0] + len;
+    unsigned char *record = (unsigned char *)malloc(total);
+    int fd = open(journal, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    bool written = false;
+    if (record != NULL && fd >= 0)
+    {
+        memcpy(record, lengths, sizeof(lengths));
+        memcpy(record + MYASSERT_SNAPSHOT_HEADER, name, (size_t)lengths[0]);
+        memcpy(record + MYASSERT_SNAPSHOT_HEADER + lengths[0], buf, len);
+        written = write(fd, record, total) == (ssize_t)total;
+    }
+    if (!written)
+    {
+        fprintf(stderr, "myassert: cannot record snapshot %s in %s\n", name, journal);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    free(record);
+    if (written && !__atomic_exchange_n(&myassert_snapshots_recorded, 1, __ATOMIC_RELAXED))
+    {
+        atexit(myassert_snapshot_merge);
+    }
+    return written;
+}
+
+// Describes a buffer that differs from its snapshot, or a missing one.
+MYASSERT_COLD
+static void myassert_snapshot_failure(struct myassert_failure *failure, const char *name,
+                                      const unsigned char *snapshot, size_t snapshot_len,
+                                      const void *buf, size_t len)
+{
+    if (snapshot == NULL)
+    {
+        failure->error = ENOENT;
+        myassert_capture_text(failure->capture_a, name, SIZE_MAX);
+        myassert_capture_text(failure->capture_b, myassert_snapshot_path(), SIZE_MAX);
+        return;
+    }
+    struct myassert_stream a;
+    struct myassert_stream b;
+    myassert_stream_open(&a, NULL, buf, len);
+    myassert_stream_open(&b, NULL, snapshot, snapshot_len);
+    size_t shorter = len < snapshot_len ? len : snapshot_len;
+    myassert_file_failure(failure, &a, &b,
+                          myassert_array_mismatch(buf, snapshot, shorter, 1, false, 0));
+}
+
+// Compares len bytes at buf with the snapshot called name, recording it
+// instead in update mode. Fills in failure if they differ.
+static inline bool myassert_compare_snapshot(const char *name, const void *buf, size_t len,
+                                             struct myassert_failure *failure)
+{
+    const struct myassert_snapshot_store *store = myassert_snapshot_store();
+    const struct myassert_snapshot_entry *entry = myassert_snapshot_find(store, name, strlen(name));
+    const unsigned char *snapshot = entry != NULL ? store->map + entry->data : NULL;
+    size_t snapshot_len = entry != NULL ? (size_t)entry->data_len : 0;
+    if (MYASSERT_UNLIKELY(snapshot == NULL || snapshot_len != len ||
+                          memcmp(snapshot, buf, len) != 0))
+    {
+        if (myassert_env_flag("MYASSERT_SNAPSHOT_UPDATE") &&
+            myassert_snapshot_record(name, buf, len))
+        {
+            return true;
+        }
+        myassert_snapshot_failure(failure, name, snapshot, snapshot_len, buf, len);
+        return false;
+    }
+    return true;
+}
+
+#define ASSERT_SNAPSHOT(name, buf, len)                                   \
+    do                                                                    \
+    {                                                                     \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_FATAL))                      \
+        {                                                                 \
+            break;                                                        \
+        }                                                                 \
+        MYASSERT_SITE(MYASSERT_LEVEL_FATAL, myassert_site, "ASSERT",      \
+                      MYASSERT_SITE_SNAPSHOT, #buf, "==", #name, "s");    \
+        MYASSERT_HIT(myassert_site);                                      \
+        struct myassert_failure eval_failure;                             \
+        if (MYASSERT_UNLIKELY(!myassert_compare_snapshot(name, buf, len,  \
+                                                         &eval_failure))) \
+        {                                                                 \
+            myassert_fail_file(&myassert_site, &eval_failure);            \
+        }                                                                 \
     } while (0)
 
-#define ASSERT_LE_INT32(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int32_t);                 \
-        TYPE_CHECK(b, int32_t);                 \
-        ASSERT_BASE(a, <=, b, int32_t, PRId32); \
+#define EXPECT_SNAPSHOT(name, buf, len)                                   \
+    do                                                                    \
+    {                                                                     \
+        if (!MYASSERT_ENABLED(MYASSERT_LEVEL_NORMAL))                     \
+        {                                                                 \
+            break;                                                        \
+        }                                                                 \
+        MYASSERT_SITE(MYASSERT_LEVEL_NORMAL, myassert_site, "EXPECT",     \
+                      MYASSERT_SITE_SNAPSHOT, #buf, "==", #name, "s");    \
+        MYASSERT_HIT(myassert_site);                                      \
+        struct myassert_failure eval_failure;                             \
+        if (MYASSERT_UNLIKELY(!myassert_compare_snapshot(name, buf, len,  \
+                                                         &eval_failure))) \
+        {                                                                 \
+            myassert_expect_file(&myassert_site, &eval_failure);          \
+        }                                                                 \
     } while (0)
 
-#define ASSERT_LT_INT32(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int32_t);                \
-        TYPE_CHECK(b, int32_t);                \
-        ASSERT_BASE(a, <, b, int32_t, PRId32); \
+#else
+
+static inline void myassert_snapshot_merge(void)
+{
+}
+
+#endif
+
+// =============================================================
+// PROPERTY TESTS
+// =============================================================
+
+#if MYASSERT_HAVE_POSIX
+
+// PROPERTY(name) runs its body MYASSERT_PROPERTY_CASES times (default
+// 100) on inputs drawn with the GEN_* generators, spread over
+// MYASSERT_PROPERTY_JOBS threads (default: one per CPU). A case fails when
+// an ASSERT_* or EXPECT_* in it fails. The failing case with the lowest
+// number is shrunk and reported with its drawn values and the seed, and
+// MYASSERT_SEED replays the run with that seed.
+//
+// Every draw takes the next number of a choice sequence, and generators
+// map smaller numbers to simpler values. A case can be replayed from its
+// sequence, so shrinking only has to make the sequence shorter and its
+// numbers smaller, whatever the generators built from it.
+//
+// A failed assertion leaves the case with longjmp, so the body must not
+// hold resources it cannot lose, and C++ destructors in it are skipped.
+#ifndef MYASSERT_PROPERTY_CHOICES
+#define MYASSERT_PROPERTY_CHOICES 16384
+#endif
+
+enum
+{
+    MYASSERT_CASE_PASS,
+    MYASSERT_CASE_FAIL,
+    MYASSERT_CASE_DISCARD
+};
+
+// Memory handed out by GEN_STRING, GEN_BYTES and GEN_ARRAY, freed when
+// the case ends.
+struct myassert_block
+{
+    struct myassert_block *next;
+    double align;
+};
+
+// Elements of a GEN_ARRAY, which are shown as name[index].
+struct myassert_collection
+{
+    const char *name;
+    size_t index;
+    size_t max;
+    uint64_t target;
+    struct myassert_collection *outer;
+};
+
+struct myassert_property
+{
+    uint64_t record[MYASSERT_PROPERTY_CHOICES];
+    size_t count;
+    const uint64_t *source;
+    size_t source_length;
+    uint64_t rng;
+    bool log;
+    int outcome;
+    struct myassert_failure failure;
+    struct myassert_block *blocks;
+    struct myassert_collection *collection;
+    jmp_buf exit;
+};
+
+MYASSERT_SHARED MYASSERT_THREAD_LOCAL struct myassert_property *myassert_property_case;
+MYASSERT_SHARED uint64_t myassert_seed_value;
+
+static inline uint64_t myassert_mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+    return z ^ (z >> 31);
+}
+
+// The seed of this run: MYASSERT_SEED when set, otherwise drawn once per
+// process from the clock and the process id.
+static inline uint64_t myassert_seed(void)
+{
+    const char *env = getenv("MYASSERT_SEED");
+    if (env != NULL && env[0] != '\0')
+    {
+        return strtoull(env, NULL, 0);
+    }
+    uint64_t seed = __atomic_load_n(&myassert_seed_value, __ATOMIC_RELAXED);
+    if (seed == 0)
+    {
+        uint64_t fresh = myassert_mix64(myassert_now_ns() ^ ((uint64_t)getpid() << 32)) | 1;
+        seed = __atomic_compare_exchange_n(&myassert_seed_value, &seed, fresh, false,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+                   ? fresh
+                   : seed;
+    }
+    return seed;
+}
+
+static inline struct myassert_property *myassert_property_get(void)
+{
+    struct myassert_property *p = myassert_property_case;
+    if (p == NULL)
+    {
+        FATAL("GEN_* used outside of a PROPERTY");
+    }
+    return p;
+}
+
+static inline uint64_t myassert_property_next(struct myassert_property *p)
+{
+    p->rng += 0x9e3779b97f4a7c15u;
+    return myassert_mix64(p->rng);
+}
+
+// A fresh choice below span (0 for 2^64). Small choices and the largest
+// ones, which generators map to the ends of their range, are drawn far
+// more often than a uniform draw would.
+static inline uint64_t myassert_property_random(struct myassert_property *p, uint64_t span)
+{
+    uint64_t r = myassert_property_next(p);
+    uint64_t c;
+    if ((r & 15) == 0)
+    {
+        c = span - 1 - (r >> 4) % 3;
+        if (span != 0 && span <= 3)
+        {
+            c = (r >> 4) % span;
+        }
+    }
+    else if ((r & 15) < 8)
+    {
+        unsigned bits = (unsigned)((r >> 4) % 65);
+        c = myassert_property_next(p);
+        if (bits < 64)
+        {
+            c &= ((uint64_t)1 << bits) - 1;
+        }
+    }
+    else
+    {
+        c = myassert_property_next(p);
+    }
+    return span != 0 ? c % span : c;
+}
+
+// Takes the next choice of the sequence, or fresh when a new case is being
+// generated. Once the sequence is used up every choice is 0.
+static inline uint64_t myassert_property_choose(struct myassert_property *p, uint64_t span,
+                                                uint64_t fresh)
+{
+    if (p->count == MYASSERT_PROPERTY_CHOICES)
+    {
+        return 0;
+    }
+    uint64_t c = fresh;
+    if (p->source != NULL)
+    {
+        c = p->count < p->source_length ? p->source[p->count] : 0;
+    }
+    c = span != 0 ? c % span : c;
+    p->record[p->count++] = c;
+    return c;
+}
+
+static inline uint64_t myassert_property_draw(struct myassert_property *p, uint64_t span)
+{
+    return myassert_property_choose(p, span, p->source == NULL ? myassert_property_random(p, span) : 0);
+}
+
+// Maps choice c to the values of [lo, hi] in order of their distance from
+// origin, alternating above and below it: 0 gives origin, and a smaller
+// choice never gives a value further away.
+static inline uint64_t myassert_property_spread(uint64_t c, uint64_t lo, uint64_t hi,
+                                                uint64_t origin)
+{
+    uint64_t up = hi - origin;
+    uint64_t down = origin - lo;
+    uint64_t near = up < down ? up : down;
+    if (c <= 2 * near)
+    {
+        uint64_t distance = (c + 1) / 2;
+        return c % 2 == 1 ? origin + distance : origin - distance;
+    }
+    uint64_t rest = c - 2 * near;
+    return up > down ? origin + near + rest : origin - near - rest;
+}
+
+static inline uint64_t myassert_property_range(struct myassert_property *p, uint64_t lo,
+                                               uint64_t hi, uint64_t origin)
+{
+    if (lo > hi)
+    {
+        FATAL("empty range in a GEN_* generator");
+    }
+    return myassert_property_spread(myassert_property_draw(p, hi - lo + 1), lo, hi, origin);
+}
+
+// Starts the line that shows a drawn value in the report of a failure.
+static inline void myassert_property_label(const struct myassert_property *p,
+                                           struct myassert_buf *buf, const char *label)
+{
+    myassert_put_str(buf, "  ");
+    if (p->collection != NULL)
+    {
+        myassert_put_str(buf, p->collection->name);
+        myassert_put_str(buf, "[");
+        myassert_put_uint(buf, p->collection->index, 10);
+        myassert_put_str(buf, "]");
+    }
+    else
+    {
+        myassert_put_str(buf, label);
+    }
+    myassert_put_str(buf, " = ");
+}
+
+static inline void *myassert_property_alloc(struct myassert_property *p, size_t size)
+{
+    struct myassert_block *block =
+        (struct myassert_block *)malloc(sizeof(struct myassert_block) + size);
+    if (block == NULL)
+    {
+        FATAL("out of memory");
+    }
+    block->next = p->blocks;
+    p->blocks = block;
+    return block + 1;
+}
+
+static inline int64_t myassert_gen_int(const char *label, int64_t lo, int64_t hi)
+{
+    struct myassert_property *p = myassert_property_get();
+    const uint64_t bias = (uint64_t)1 << 63;
+    uint64_t ulo = (uint64_t)lo ^ bias;
+    uint64_t uhi = (uint64_t)hi ^ bias;
+    uint64_t origin = bias < ulo ? ulo : bias > uhi ? uhi : bias;
+    int64_t v = (int64_t)(myassert_property_range(p, ulo, uhi, origin) ^ bias);
+    if (p->log)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_int(&buf, v);
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return v;
+}
+
+static inline uint64_t myassert_gen_uint(const char *label, uint64_t lo, uint64_t hi)
+{
+    struct myassert_property *p = myassert_property_get();
+    uint64_t v = myassert_property_range(p, lo, hi, lo);
+    if (p->log)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_uint(&buf, v, 10);
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return v;
+}
+
+// A finite value of [lo, hi]. The sequence picks the integer part, nearest
+// to 0 first, then a 52-bit fraction, so values shrink towards small
+// integers. A few choices instead give lo, hi or raw bit patterns, which
+// reach denormals and large magnitudes.
+static inline double myassert_property_real(struct myassert_property *p, double lo, double hi,
+                                            bool single)
+{
+    if (!(lo <= hi))
+    {
+        FATAL("empty range in a GEN_* generator");
+    }
+    uint64_t kind = myassert_property_draw(p, 16);
+    if (kind == 12)
+    {
+        return lo;
+    }
+    if (kind == 13)
+    {
+        return hi;
+    }
+    if (kind >= 14)
+    {
+        double d;
+        if (single)
+        {
+            uint32_t bits = (uint32_t)myassert_property_draw(p, (uint64_t)1 << 32);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            d = f;
+        }
+        else
+        {
+            uint64_t bits = myassert_property_draw(p, 0);
+            memcpy(&d, &bits, sizeof(d));
+        }
+        if (d >= lo && d <= hi)
+        {
+            return d;
+        }
+    }
+
+    // Round the bounds inwards to integers by truncation, after clamping
+    // them into the int64_t range.
+    const double limit = 4611686018427387904.0;
+    int64_t ilo = (int64_t)(lo > -limit ? lo : -limit);
+    int64_t ihi = (int64_t)(hi < limit ? hi : limit);
+    ilo += (double)ilo < lo;
+    ihi -= (double)ihi > hi;
+    if (ilo > ihi)
+    {
+        return lo + (hi - lo) * ((double)myassert_property_draw(p, (uint64_t)1 << 52) / 4503599627370496.0);
+    }
+    int64_t n = myassert_gen_int(NULL, ilo, ihi);
+    double fraction = (double)myassert_property_draw(p, (uint64_t)1 << 52) / 4503599627370496.0;
+    double d = n < 0 || (n == 0 && kind % 2 == 1) ? (double)n - fraction : (double)n + fraction;
+    return d >= lo && d <= hi ? d : (double)n;
+}
+
+static inline float myassert_gen_float(const char *label, float lo, float hi)
+{
+    struct myassert_property *p = myassert_property_get();
+    bool log = p->log;
+    p->log = false;
+    float v = (float)myassert_property_real(p, lo, hi, true);
+    v = v < lo ? lo : v > hi ? hi : v;
+    p->log = log;
+    if (log)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_exp(&buf, v, 8);
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return v;
+}
+
+static inline double myassert_gen_double(const char *label, double lo, double hi)
+{
+    struct myassert_property *p = myassert_property_get();
+    bool log = p->log;
+    p->log = false;
+    double v = myassert_property_real(p, lo, hi, false);
+    p->log = log;
+    if (log)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_exp(&buf, v, 16);
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return v;
+}
+
+// Collections are a run of "one more element" flags, so removing the
+// choices of an element removes it cleanly. A new case decides its length
+// up front and only records the flags.
+static inline void myassert_collection_start(struct myassert_property *p,
+                                             struct myassert_collection *c, size_t max)
+{
+    c->index = 0;
+    c->max = max;
+    c->target = p->source == NULL ? myassert_property_random(p, (uint64_t)max + 1) : 0;
+}
+
+static inline bool myassert_collection_next(struct myassert_property *p,
+                                            struct myassert_collection *c, size_t n)
+{
+    return n < c->max && myassert_property_choose(p, 2, n < c->target) != 0;
+}
+
+static inline void *myassert_collection_begin(struct myassert_collection *c, const char *name,
+                                              size_t max, size_t size)
+{
+    struct myassert_property *p = myassert_property_get();
+    myassert_collection_start(p, c, max);
+    c->name = name;
+    c->index = (size_t)-1;
+    c->outer = p->collection;
+    p->collection = c;
+    return myassert_property_alloc(p, max * size);
+}
+
+static inline bool myassert_collection_more(struct myassert_collection *c)
+{
+    struct myassert_property *p = myassert_property_get();
+    c->index++;
+    return myassert_collection_next(p, c, c->index);
+}
+
+static inline void myassert_collection_end(struct myassert_collection *c)
+{
+    myassert_property_get()->collection = c->outer;
+}
+
+static inline char *myassert_gen_string(const char *label, size_t max_len)
+{
+    struct myassert_property *p = myassert_property_get();
+    struct myassert_collection c;
+    myassert_collection_start(p, &c, max_len);
+    char *s = (char *)myassert_property_alloc(p, max_len + 1);
+    size_t len = 0;
+    while (myassert_collection_next(p, &c, len))
+    {
+        s[len++] = (char)myassert_property_range(p, 0x20, 0x7e, 'a');
+    }
+    s[len] = '\0';
+    if (p->log)
+    {
+        char data[MYASSERT_MESSAGE_SIZE];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_str(&buf, "\"");
+        for (size_t i = 0; i < len; i++)
+        {
+            if (s[i] == '"' || s[i] == '\\')
+            {
+                myassert_put_str(&buf, "\\");
+            }
+            myassert_put(&buf, &s[i], 1);
+        }
+        myassert_put_str(&buf, "\"");
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return s;
+}
+
+static inline unsigned char *myassert_gen_bytes(const char *label, size_t *len, size_t max_len)
+{
+    struct myassert_property *p = myassert_property_get();
+    struct myassert_collection c;
+    myassert_collection_start(p, &c, max_len);
+    unsigned char *bytes = (unsigned char *)myassert_property_alloc(p, max_len);
+    size_t n = 0;
+    while (myassert_collection_next(p, &c, n))
+    {
+        bytes[n++] = (unsigned char)myassert_property_draw(p, 256);
+    }
+    *len = n;
+    if (p->log)
+    {
+        char data[MYASSERT_MESSAGE_SIZE];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_uint(&buf, n, 10);
+        myassert_put_str(&buf, " bytes");
+        for (size_t i = 0; i < n && i < 64; i++)
+        {
+            myassert_put_str(&buf, i == 0 ? ": " : " ");
+            myassert_put_hex(&buf, bytes[i], 2);
+        }
+        if (n > 64)
+        {
+            myassert_put_str(&buf, " ...");
+        }
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return bytes;
+}
+
+static inline bool myassert_gen_bool(const char *label)
+{
+    struct myassert_property *p = myassert_property_get();
+    bool v = myassert_property_draw(p, 2) != 0;
+    if (p->log)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_property_label(p, &buf, label);
+        myassert_put_str(&buf, v ? "true" : "false");
+        myassert_write(STDERR_FILENO, &buf);
+    }
+    return v;
+}
+
+#define GEN_INT8(lo, hi) ((int8_t)myassert_gen_int("GEN_INT8(" #lo ", " #hi ")", lo, hi))
+#define GEN_INT16(lo, hi) ((int16_t)myassert_gen_int("GEN_INT16(" #lo ", " #hi ")", lo, hi))
+#define GEN_INT32(lo, hi) ((int32_t)myassert_gen_int("GEN_INT32(" #lo ", " #hi ")", lo, hi))
+#define GEN_INT64(lo, hi) ((int64_t)myassert_gen_int("GEN_INT64(" #lo ", " #hi ")", lo, hi))
+#define GEN_UINT8(lo, hi) ((uint8_t)myassert_gen_uint("GEN_UINT8(" #lo ", " #hi ")", lo, hi))
+#define GEN_UINT16(lo, hi) ((uint16_t)myassert_gen_uint("GEN_UINT16(" #lo ", " #hi ")", lo, hi))
+#define GEN_UINT32(lo, hi) ((uint32_t)myassert_gen_uint("GEN_UINT32(" #lo ", " #hi ")", lo, hi))
+#define GEN_UINT64(lo, hi) ((uint64_t)myassert_gen_uint("GEN_UINT64(" #lo ", " #hi ")", lo, hi))
+#define GEN_SIZE(lo, hi) ((size_t)myassert_gen_uint("GEN_SIZE(" #lo ", " #hi ")", lo, hi))
+#define GEN_BOOL() myassert_gen_bool("GEN_BOOL()")
+#define GEN_FLOAT(lo, hi) myassert_gen_float("GEN_FLOAT(" #lo ", " #hi ")", lo, hi)
+#define GEN_DOUBLE(lo, hi) myassert_gen_double("GEN_DOUBLE(" #lo ", " #hi ")", lo, hi)
+#define GEN_STRING(max_len) myassert_gen_string("GEN_STRING(" #max_len ")", max_len)
+#define GEN_BYTES(len, max_len) myassert_gen_bytes("GEN_BYTES(" #len ", " #max_len ")", len, max_len)
+
+// Fills array with up to max_len elements drawn by gen and stores their
+// number in len. The memory lasts until the case ends.
+#define GEN_ARRAY(array, len, max_len, gen)                                      \
+    do                                                                           \
+    {                                                                            \
+        struct myassert_collection myassert_collection;                          \
+        void *myassert_block = myassert_collection_begin(                        \
+            &myassert_collection, #array, max_len, sizeof(*(array)));            \
+        memcpy(&(array), &myassert_block, sizeof(myassert_block));               \
+        for ((len) = 0; myassert_collection_more(&myassert_collection); (len)++) \
+        {                                                                        \
+            (array)[len] = (gen);                                                \
+        }                                                                        \
+        myassert_collection_end(&myassert_collection);                           \
     } while (0)
 
-#define ASSERT_NE_INT32(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int32_t);                 \
-        TYPE_CHECK(b, int32_t);                 \
-        ASSERT_BASE(a, !=, b, int32_t, PRId32); \
+// Drops the current case when expr is false. Dropped cases still count
+// towards MYASSERT_PROPERTY_CASES.
+#define PROPERTY_ASSUME(expr)              \
+    do                                     \
+    {                                      \
+        if (!(expr))                       \
+        {                                  \
+            myassert_property_discard();   \
+        }                                  \
     } while (0)
 
-// ==============================================
-// UINT32_T ASSERTIONS
-// ==============================================
+MYASSERT_ATTR((noreturn))
+static inline void myassert_property_discard(void)
+{
+    struct myassert_property *p = myassert_property_get();
+    p->outcome = MYASSERT_CASE_DISCARD;
+    longjmp(p->exit, 1);
+}
+
+static inline void myassert_property_catch(const struct myassert_failure *failure)
+{
+    struct myassert_property *p = myassert_property_case;
+    if (p == NULL)
+    {
+        return;
+    }
+    p->failure = *failure;
+    const struct myassert_site *site = failure->site;
+    if (site->kind == MYASSERT_SITE_TEXT && site->conv[0] != 'p')
+    {
+        myassert_capture_text(p->failure.capture_a, failure->text_a, failure->size);
+        myassert_capture_text(p->failure.capture_b, failure->text_b, failure->size);
+        p->failure.text_a = p->failure.capture_a;
+        p->failure.text_b = p->failure.capture_b;
+    }
+    p->outcome = MYASSERT_CASE_FAIL;
+    longjmp(p->exit, 1);
+}
+
+// Runs one case, from p->source or from p->rng, and sets p->outcome. A
+// failed expectation fails the case as well; the records are kept for the
+// report when p->log is set and dropped otherwise.
+static inline void myassert_property_run_case(struct myassert_property *p, void (*body)(void))
+{
+    p->count = 0;
+    p->outcome = MYASSERT_CASE_PASS;
+    p->failure.site = NULL;
+    p->collection = NULL;
+    myassert_expect_reset();
+    myassert_property_case = p;
+    if (setjmp(p->exit) == 0)
+    {
+        body();
+    }
+    myassert_property_case = NULL;
+    while (p->blocks != NULL)
+    {
+        struct myassert_block *next = p->blocks->next;
+        free(p->blocks);
+        p->blocks = next;
+    }
+    if (p->outcome == MYASSERT_CASE_PASS && (myassert_expect.count != 0 || myassert_expect.logged != 0))
+    {
+        p->outcome = MYASSERT_CASE_FAIL;
+    }
+    if (!p->log)
+    {
+        myassert_expect_reset();
+    }
+}
+
+// Cases are handed out in order. Every case below the lowest failure seen
+// so far still runs, so the case that is shrunk does not depend on the
+// number of threads or their timing.
+struct myassert_search
+{
+    void (*body)(void);
+    uint64_t seed;
+    uint64_t cases;
+    uint64_t next;
+    uint64_t failed;
+    uint64_t discarded;
+    pthread_mutex_t lock;
+    uint64_t *choices;
+    size_t length;
+};
+
+static inline void *myassert_property_search(void *arg)
+{
+    struct myassert_search *search = (struct myassert_search *)arg;
+    struct myassert_property *p = (struct myassert_property *)calloc(1, sizeof(*p));
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    for (;;)
+    {
+        uint64_t i = __atomic_fetch_add(&search->next, 1, __ATOMIC_RELAXED);
+        if (i >= search->cases || i > __atomic_load_n(&search->failed, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        p->rng = myassert_mix64(search->seed + i * 0x9e3779b97f4a7c15u);
+        myassert_property_run_case(p, search->body);
+        if (p->outcome == MYASSERT_CASE_DISCARD)
+        {
+            __atomic_fetch_add(&search->discarded, 1, __ATOMIC_RELAXED);
+        }
+        else if (p->outcome == MYASSERT_CASE_FAIL)
+        {
+            pthread_mutex_lock(&search->lock);
+            if (i < search->failed)
+            {
+                __atomic_store_n(&search->failed, i, __ATOMIC_RELAXED);
+                memcpy(search->choices, p->record, p->count * sizeof(*p->record));
+                search->length = p->count;
+            }
+            pthread_mutex_unlock(&search->lock);
+        }
+    }
+    free(p);
+    return NULL;
+}
+
+struct myassert_shrink
+{
+    struct myassert_property *p;
+    void (*body)(void);
+    uint64_t *best;
+    size_t length;
+    uint64_t *candidate;
+    unsigned long attempts;
+    unsigned long limit;
+    unsigned long steps;
+};
+
+// Replays candidate and keeps it when the case still fails and the
+// choices it used are fewer, or as many and smaller.
+static inline bool myassert_shrink_try(struct myassert_shrink *s, size_t length)
+{
+    if (s->attempts == s->limit)
+    {
+        return false;
+    }
+    s->attempts++;
+    struct myassert_property *p = s->p;
+    p->source = s->candidate;
+    p->source_length = length;
+    myassert_property_run_case(p, s->body);
+    if (p->outcome != MYASSERT_CASE_FAIL)
+    {
+        return false;
+    }
+    if (p->count > s->length)
+    {
+        return false;
+    }
+    int order = 0;
+    for (size_t i = 0; i < p->count && order == 0; i++)
+    {
+        order = (p->record[i] > s->best[i]) - (p->record[i] < s->best[i]);
+    }
+    if (p->count == s->length && order >= 0)
+    {
+        return false;
+    }
+    memcpy(s->best, p->record, p->count * sizeof(*p->record));
+    s->length = p->count;
+    s->steps++;
+    return true;
+}
+
+// Removes a block of k choices at i.
+static inline bool myassert_shrink_delete(struct myassert_shrink *s, size_t i, size_t k)
+{
+    memcpy(s->candidate, s->best, i * sizeof(*s->best));
+    memcpy(s->candidate + i, s->best + i + k, (s->length - i - k) * sizeof(*s->best));
+    return myassert_shrink_try(s, s->length - k);
+}
+
+// Sets choice i to value, and zeroes the k - 1 choices after it.
+static inline bool myassert_shrink_lower(struct myassert_shrink *s, size_t i, size_t k,
+                                         uint64_t value)
+{
+    memcpy(s->candidate, s->best, s->length * sizeof(*s->best));
+    s->candidate[i] = value;
+    memset(s->candidate + i + 1, 0, (k - 1) * sizeof(*s->best));
+    return myassert_shrink_try(s, s->length);
+}
+
+// Moves d from choice i to choice j, which keeps a sum of values while
+// the earlier one shrinks.
+static inline bool myassert_shrink_move(struct myassert_shrink *s, size_t i, size_t j,
+                                        uint64_t d)
+{
+    memcpy(s->candidate, s->best, s->length * sizeof(*s->best));
+    s->candidate[i] -= d;
+    s->candidate[j] += d;
+    return s->candidate[j] >= d && myassert_shrink_try(s, s->length);
+}
 
-#define ASSERT_EQ_UINT32(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint32_t);                 \
-        TYPE_CHECK(b, uint32_t);                 \
-        ASSERT_BASE(a, ==, b, uint32_t, PRIu32); \
-    } while (0)
+static inline void myassert_shrink(struct myassert_shrink *s)
+{
+    bool progress = true;
+    while (progress && s->attempts < s->limit)
+    {
+        progress = false;
+        for (size_t k = 8; k > 0; k /= 2)
+        {
+            for (size_t i = s->length; i-- > 0;)
+            {
+                if (i + k <= s->length && myassert_shrink_delete(s, i, k))
+                {
+                    progress = true;
+                }
+            }
+        }
+        for (size_t k = 8; k > 1; k /= 2)
+        {
+            for (size_t i = 0; i + k <= s->length; i++)
+            {
+                bool zero = true;
+                for (size_t j = i; j < i + k; j++)
+                {
+                    zero = zero && s->best[j] == 0;
+                }
+                if (!zero && myassert_shrink_lower(s, i, k, 0))
+                {
+                    progress = true;
+                }
+            }
+        }
+        // Binary search for the smallest failing value of each choice,
+        // assuming that smaller values mostly keep failing.
+        for (size_t i = 0; i < s->length; i++)
+        {
+            if (s->best[i] == 0)
+            {
+                continue;
+            }
+            if (myassert_shrink_lower(s, i, 1, 0))
+            {
+                progress = true;
+                continue;
+            }
+            uint64_t low = 0;
+            while (i < s->length && low + 1 < s->best[i])
+            {
+                uint64_t mid = low + (s->best[i] - low) / 2;
+                if (myassert_shrink_lower(s, i, 1, mid))
+                {
+                    progress = true;
+                }
+                else
+                {
+                    low = mid;
+                }
+            }
+        }
+        for (size_t i = 0; i < s->length; i++)
+        {
+            for (size_t j = i + 1; j < s->length && j <= i + 4 && s->best[i] != 0; j++)
+            {
+                for (uint64_t d = s->best[i]; d > 0; d /= 2)
+                {
+                    if (myassert_shrink_move(s, i, j, d))
+                    {
+                        progress = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
 
-#define ASSERT_GE_UINT32(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint32_t);                 \
-        TYPE_CHECK(b, uint32_t);                 \
-        ASSERT_BASE(a, >=, b, uint32_t, PRIu32); \
-    } while (0)
+static inline size_t myassert_property_jobs(uint64_t cases)
+{
+    long jobs = (long)myassert_env_ulong("MYASSERT_PROPERTY_JOBS", 0);
+    if (jobs <= 0)
+    {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs <= 0)
+    {
+        jobs = 1;
+    }
+    return (uint64_t)jobs < cases ? (size_t)jobs : (size_t)cases;
+}
 
-#define ASSERT_GT_UINT32(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint32_t);                \
-        TYPE_CHECK(b, uint32_t);                \
-        ASSERT_BASE(a, >, b, uint32_t, PRIu32); \
-    } while (0)
+static inline int myassert_property_run(const char *name, void (*body)(void))
+{
+    uint64_t seed = myassert_seed();
+    struct myassert_search search;
+    memset(&search, 0, sizeof(search));
+    search.body = body;
+    search.seed = myassert_mix64(seed ^ myassert_snapshot_hash(name, strlen(name)));
+    search.cases = myassert_env_ulong("MYASSERT_PROPERTY_CASES", 100);
+    search.failed = UINT64_MAX;
+    search.choices = (uint64_t *)malloc(MYASSERT_PROPERTY_CHOICES * sizeof(uint64_t));
+    struct myassert_property *p = (struct myassert_property *)calloc(1, sizeof(*p));
+    uint64_t *candidate = (uint64_t *)malloc(MYASSERT_PROPERTY_CHOICES * sizeof(uint64_t));
+    if (search.choices == NULL || p == NULL || candidate == NULL)
+    {
+        FATAL("out of memory");
+    }
+    pthread_mutex_init(&search.lock, NULL);
 
-#define ASSERT_LE_UINT32(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint32_t);                 \
-        TYPE_CHECK(b, uint32_t);                 \
-        ASSERT_BASE(a, <=, b, uint32_t, PRIu32); \
-    } while (0)
+    size_t jobs = myassert_property_jobs(search.cases);
+    pthread_t *threads = (pthread_t *)calloc(jobs, sizeof(*threads));
+    size_t started = 0;
+    while (threads != NULL && started + 1 < jobs &&
+           pthread_create(&threads[started], NULL, myassert_property_search, &search) == 0)
+    {
+        started++;
+    }
+    myassert_property_search(&search);
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&search.lock);
 
-#define ASSERT_LT_UINT32(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint32_t);                \
-        TYPE_CHECK(b, uint32_t);                \
-        ASSERT_BASE(a, <, b, uint32_t, PRIu32); \
-    } while (0)
+    int status = TEST_OK;
+    if (search.failed != UINT64_MAX)
+    {
+        struct myassert_shrink shrink = {p, body, search.choices, search.length, candidate, 0,
+                                         myassert_env_ulong("MYASSERT_PROPERTY_SHRINKS", 10000), 0};
+        myassert_shrink(&shrink);
 
-#define ASSERT_NE_UINT32(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint32_t);                 \
-        TYPE_CHECK(b, uint32_t);                 \
-        ASSERT_BASE(a, !=, b, uint32_t, PRIu32); \
-    } while (0)
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_put_str(&buf, "Property ");
+        myassert_put_str(&buf, name);
+        myassert_put_str(&buf, " failed on case ");
+        myassert_put_uint(&buf, search.failed + 1, 10);
+        myassert_put_str(&buf, " of ");
+        myassert_put_uint(&buf, search.cases, 10);
+        myassert_put_str(&buf, ", shrunk in ");
+        myassert_put_uint(&buf, shrink.steps, 10);
+        myassert_put_str(&buf, " steps (MYASSERT_SEED=0x");
+        myassert_put_hex(&buf, seed, 16);
+        myassert_put_str(&buf, "):");
+        myassert_write(STDERR_FILENO, &buf);
 
-// ==============================================
-// INT64_T ASSERTIONS
-// ==============================================
+        p->source = shrink.best;
+        p->source_length = shrink.length;
+        p->log = true;
+        myassert_property_run_case(p, body);
+        myassert_expect_finish();
+        if (p->failure.site != NULL)
+        {
+            myassert_detail_record("Assertion", &p->failure);
+            myassert_report_failure(STDERR_FILENO, "Assertion", &p->failure);
+        }
+        if (p->outcome != MYASSERT_CASE_FAIL)
+        {
+            buf.len = 0;
+            myassert_put_str(&buf, "myassert: property ");
+            myassert_put_str(&buf, name);
+            myassert_put_str(&buf, " passed when replayed, it depends on state outside the case");
+            myassert_write(STDERR_FILENO, &buf);
+        }
+        status = TEST_FAIL;
+    }
+    else if (search.discarded == search.cases)
+    {
+        char data[256];
+        struct myassert_buf buf = {data, 0, sizeof(data) - 1};
+        myassert_put_str(&buf, "myassert: property ");
+        myassert_put_str(&buf, name);
+        myassert_put_str(&buf, " discarded all of its cases");
+        myassert_write(STDERR_FILENO, &buf);
+        status = TEST_SKIP;
+    }
+    free(candidate);
+    free(p);
+    free(search.choices);
+    return status;
+}
 
-#define ASSERT_EQ_INT64(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int64_t);                 \
-        TYPE_CHECK(b, int64_t);                 \
-        ASSERT_BASE(a, ==, b, int64_t, PRId64); \
-    } while (0)
+#define PROPERTY(name)                                      \
+    static void name##_property(void);                      \
+    TEST(name)                                              \
+    {                                                       \
+        return myassert_property_run(#name, name##_property); \
+    }                                                       \
+    static void name##_property(void)
 
-#define ASSERT_GE_INT64(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int64_t);                 \
-        TYPE_CHECK(b, int64_t);                 \
-        ASSERT_BASE(a, >=, b, int64_t, PRId64); \
-    } while (0)
+#endif
 
-#define ASSERT_GT_INT64(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int64_t);                \
-        TYPE_CHECK(b, int64_t);                \
-        ASSERT_BASE(a, >, b, int64_t, PRId64); \
-    } while (0)
+// =============================================================
+// DEBUG ASSERTIONS
+// =============================================================
 
-#define ASSERT_LE_INT64(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int64_t);                 \
-        TYPE_CHECK(b, int64_t);                 \
-        ASSERT_BASE(a, <=, b, int64_t, PRId64); \
-    } while (0)
+// DEBUG_ASSERT_* mirror the ASSERT_* macros for checks too expensive to
+// keep in every build. They are only checked at MYASSERT_LEVEL_PARANOID.
 
-#define ASSERT_LT_INT64(a, b)                  \
-    do                                         \
-    {                                          \
-        TYPE_CHECK(a, int64_t);                \
-        TYPE_CHECK(b, int64_t);                \
-        ASSERT_BASE(a, <, b, int64_t, PRId64); \
-    } while (0)
+#define DEBUG_ASSERT(expr) MYASSERT_DEBUG(ASSERT(expr))
+#define DEBUG_ASSERT_OK(a) MYASSERT_DEBUG(ASSERT_OK(a))
+#define DEBUG_ASSERT_TRUE(a) MYASSERT_DEBUG(ASSERT_TRUE(a))
+#define DEBUG_ASSERT_FALSE(a) MYASSERT_DEBUG(ASSERT_FALSE(a))
+#define DEBUG_ASSERT_NULL(a) MYASSERT_DEBUG(ASSERT_NULL(a))
+#define DEBUG_ASSERT_NOT_NULL(a) MYASSERT_DEBUG(ASSERT_NOT_NULL(a))
+#define DEBUG_ASSERT_EQ_MEM(a, b, len) MYASSERT_DEBUG(ASSERT_EQ_MEM(a, b, len))
+#define DEBUG_ASSERT_NE_MEM(a, b, len) MYASSERT_DEBUG(ASSERT_NE_MEM(a, b, len))
+#define DEBUG_ASSERT_FILE_EQ(path_a, path_b) \
+    MYASSERT_DEBUG(ASSERT_FILE_EQ(path_a, path_b))
+#define DEBUG_ASSERT_FILE_EQ_MEM(path, buf, len) \
+    MYASSERT_DEBUG(ASSERT_FILE_EQ_MEM(path, buf, len))
+#define DEBUG_ASSERT_SNAPSHOT(name, buf, len) \
+    MYASSERT_DEBUG(ASSERT_SNAPSHOT(name, buf, len))
+#define DEBUG_ASSERT_EQ_STR(a, b) MYASSERT_DEBUG(ASSERT_EQ_STR(a, b))
+#define DEBUG_ASSERT_NE_STR(a, b) MYASSERT_DEBUG(ASSERT_NE_STR(a, b))
+#define DEBUG_ASSERT_EQ_STR_LEN(a, b, len) \
+    MYASSERT_DEBUG(ASSERT_EQ_STR_LEN(a, b, len))
+#define DEBUG_ASSERT_NE_STR_LEN(a, b, len) \
+    MYASSERT_DEBUG(ASSERT_NE_STR_LEN(a, b, len))
+#define DEBUG_ASSERT_EQ(a, b) MYASSERT_DEBUG(ASSERT_EQ(a, b))
+#define DEBUG_ASSERT_GE(a, b) MYASSERT_DEBUG(ASSERT_GE(a, b))
+#define DEBUG_ASSERT_GT(a, b) MYASSERT_DEBUG(ASSERT_GT(a, b))
+#define DEBUG_ASSERT_LE(a, b) MYASSERT_DEBUG(ASSERT_LE(a, b))
+#define DEBUG_ASSERT_LT(a, b) MYASSERT_DEBUG(ASSERT_LT(a, b))
+#define DEBUG_ASSERT_NE(a, b) MYASSERT_DEBUG(ASSERT_NE(a, b))
 
-#define ASSERT_NE_INT64(a, b)                   \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, int64_t);                 \
-        TYPE_CHECK(b, int64_t);                 \
-        ASSERT_BASE(a, !=, b, int64_t, PRId64); \
-    } while (0)
+#if MYASSERT_TYPED_MACROS
 
 // ==============================================
-// UINT64_T ASSERTIONS
+// INT8_T DEBUG ASSERTIONS
 // ==============================================
 
-#define ASSERT_EQ_UINT64(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint64_t);                 \
-        TYPE_CHECK(b, uint64_t);                 \
-        ASSERT_BASE(a, ==, b, uint64_t, PRIu64); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_INT8(a, b) MYASSERT_DEBUG(ASSERT_EQ_INT8(a, b))
+#define DEBUG_ASSERT_GE_INT8(a, b) MYASSERT_DEBUG(ASSERT_GE_INT8(a, b))
+#define DEBUG_ASSERT_GT_INT8(a, b) MYASSERT_DEBUG(ASSERT_GT_INT8(a, b))
+#define DEBUG_ASSERT_LE_INT8(a, b) MYASSERT_DEBUG(ASSERT_LE_INT8(a, b))
+#define DEBUG_ASSERT_LT_INT8(a, b) MYASSERT_DEBUG(ASSERT_LT_INT8(a, b))
+#define DEBUG_ASSERT_NE_INT8(a, b) MYASSERT_DEBUG(ASSERT_NE_INT8(a, b))
 
-#define ASSERT_GE_UINT64(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint64_t);                 \
-        TYPE_CHECK(b, uint64_t);                 \
-        ASSERT_BASE(a, >=, b, uint64_t, PRIu64); \
-    } while (0)
+// ==============================================
+// UINT8_T DEBUG ASSERTIONS
+// ==============================================
 
-#define ASSERT_GT_UINT64(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint64_t);                \
-        TYPE_CHECK(b, uint64_t);                \
-        ASSERT_BASE(a, >, b, uint64_t, PRIu64); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_UINT8(a, b) MYASSERT_DEBUG(ASSERT_EQ_UINT8(a, b))
+#define DEBUG_ASSERT_GE_UINT8(a, b) MYASSERT_DEBUG(ASSERT_GE_UINT8(a, b))
+#define DEBUG_ASSERT_GT_UINT8(a, b) MYASSERT_DEBUG(ASSERT_GT_UINT8(a, b))
+#define DEBUG_ASSERT_LE_UINT8(a, b) MYASSERT_DEBUG(ASSERT_LE_UINT8(a, b))
+#define DEBUG_ASSERT_LT_UINT8(a, b) MYASSERT_DEBUG(ASSERT_LT_UINT8(a, b))
+#define DEBUG_ASSERT_NE_UINT8(a, b) MYASSERT_DEBUG(ASSERT_NE_UINT8(a, b))
 
-#define ASSERT_LE_UINT64(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint64_t);                 \
-        TYPE_CHECK(b, uint64_t);                 \
-        ASSERT_BASE(a, <=, b, uint64_t, PRIu64); \
-    } while (0)
+// ==============================================
+// INT16_T DEBUG ASSERTIONS
+// ==============================================
 
-#define ASSERT_LT_UINT64(a, b)                  \
-    do                                          \
-    {                                           \
-        TYPE_CHECK(a, uint64_t);                \
-        TYPE_CHECK(b, uint64_t);                \
-        ASSERT_BASE(a, <, b, uint64_t, PRIu64); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_INT16(a, b) MYASSERT_DEBUG(ASSERT_EQ_INT16(a, b))
+#define DEBUG_ASSERT_GE_INT16(a, b) MYASSERT_DEBUG(ASSERT_GE_INT16(a, b))
+#define DEBUG_ASSERT_GT_INT16(a, b) MYASSERT_DEBUG(ASSERT_GT_INT16(a, b))
+#define DEBUG_ASSERT_LE_INT16(a, b) MYASSERT_DEBUG(ASSERT_LE_INT16(a, b))
+#define DEBUG_ASSERT_LT_INT16(a, b) MYASSERT_DEBUG(ASSERT_LT_INT16(a, b))
+#define DEBUG_ASSERT_NE_INT16(a, b) MYASSERT_DEBUG(ASSERT_NE_INT16(a, b))
 
-#define ASSERT_NE_UINT64(a, b)                   \
-    do                                           \
-    {                                            \
-        TYPE_CHECK(a, uint64_t);                 \
-        TYPE_CHECK(b, uint64_t);                 \
-        ASSERT_BASE(a, !=, b, uint64_t, PRIu64); \
-    } while (0)
+// ==============================================
+// UINT16_T DEBUG ASSERTIONS
+// ==============================================
+
+#define DEBUG_ASSERT_EQ_UINT16(a, b) MYASSERT_DEBUG(ASSERT_EQ_UINT16(a, b))
+#define DEBUG_ASSERT_GE_UINT16(a, b) MYASSERT_DEBUG(ASSERT_GE_UINT16(a, b))
+#define DEBUG_ASSERT_GT_UINT16(a, b) MYASSERT_DEBUG(ASSERT_GT_UINT16(a, b))
+#define DEBUG_ASSERT_LE_UINT16(a, b) MYASSERT_DEBUG(ASSERT_LE_UINT16(a, b))
+#define DEBUG_ASSERT_LT_UINT16(a, b) MYASSERT_DEBUG(ASSERT_LT_UINT16(a, b))
+#define DEBUG_ASSERT_NE_UINT16(a, b) MYASSERT_DEBUG(ASSERT_NE_UINT16(a, b))
 
 // ==============================================
-// SIZE_T ASSERTIONS
+// INT32_T DEBUG ASSERTIONS
 // ==============================================
 
-#define ASSERT_EQ_SIZE(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, size_t);               \
-        TYPE_CHECK(b, size_t);               \
-        ASSERT_BASE(a, ==, b, size_t, "zu"); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_INT32(a, b) MYASSERT_DEBUG(ASSERT_EQ_INT32(a, b))
+#define DEBUG_ASSERT_GE_INT32(a, b) MYASSERT_DEBUG(ASSERT_GE_INT32(a, b))
+#define DEBUG_ASSERT_GT_INT32(a, b) MYASSERT_DEBUG(ASSERT_GT_INT32(a, b))
+#define DEBUG_ASSERT_LE_INT32(a, b) MYASSERT_DEBUG(ASSERT_LE_INT32(a, b))
+#define DEBUG_ASSERT_LT_INT32(a, b) MYASSERT_DEBUG(ASSERT_LT_INT32(a, b))
+#define DEBUG_ASSERT_NE_INT32(a, b) MYASSERT_DEBUG(ASSERT_NE_INT32(a, b))
 
-#define ASSERT_GE_SIZE(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, size_t);               \
-        TYPE_CHECK(b, size_t);               \
-        ASSERT_BASE(a, >=, b, size_t, "zu"); \
-    } while (0)
+// ==============================================
+// UINT32_T DEBUG ASSERTIONS
+// ==============================================
 
-#define ASSERT_GT_SIZE(a, b)                \
-    do                                      \
-    {                                       \
-        TYPE_CHECK(a, size_t);              \
-        TYPE_CHECK(b, size_t);              \
-        ASSERT_BASE(a, >, b, size_t, "zu"); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_UINT32(a, b) MYASSERT_DEBUG(ASSERT_EQ_UINT32(a, b))
+#define DEBUG_ASSERT_GE_UINT32(a, b) MYASSERT_DEBUG(ASSERT_GE_UINT32(a, b))
+#define DEBUG_ASSERT_GT_UINT32(a, b) MYASSERT_DEBUG(ASSERT_GT_UINT32(a, b))
+#define DEBUG_ASSERT_LE_UINT32(a, b) MYASSERT_DEBUG(ASSERT_LE_UINT32(a, b))
+#define DEBUG_ASSERT_LT_UINT32(a, b) MYASSERT_DEBUG(ASSERT_LT_UINT32(a, b))
+#define DEBUG_ASSERT_NE_UINT32(a, b) MYASSERT_DEBUG(ASSERT_NE_UINT32(a, b))
 
-#define ASSERT_LE_SIZE(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, size_t);               \
-        TYPE_CHECK(b, size_t);               \
-        ASSERT_BASE(a, <=, b, size_t, "zu"); \
-    } while (0)
+// ==============================================
+// INT64_T DEBUG ASSERTIONS
+// ==============================================
 
-#define ASSERT_LT_SIZE(a, b)                \
-    do                                      \
-    {                                       \
-        TYPE_CHECK(a, size_t);              \
-        TYPE_CHECK(b, size_t);              \
-        ASSERT_BASE(a, <, b, size_t, "zu"); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_INT64(a, b) MYASSERT_DEBUG(ASSERT_EQ_INT64(a, b))
+#define DEBUG_ASSERT_GE_INT64(a, b) MYASSERT_DEBUG(ASSERT_GE_INT64(a, b))
+#define DEBUG_ASSERT_GT_INT64(a, b) MYASSERT_DEBUG(ASSERT_GT_INT64(a, b))
+#define DEBUG_ASSERT_LE_INT64(a, b) MYASSERT_DEBUG(ASSERT_LE_INT64(a, b))
+#define DEBUG_ASSERT_LT_INT64(a, b) MYASSERT_DEBUG(ASSERT_LT_INT64(a, b))
+#define DEBUG_ASSERT_NE_INT64(a, b) MYASSERT_DEBUG(ASSERT_NE_INT64(a, b))
 
-#define ASSERT_NE_SIZE(a, b)                 \
-    do                                       \
-    {                                        \
-        TYPE_CHECK(a, size_t);               \
-        TYPE_CHECK(b, size_t);               \
-        ASSERT_BASE(a, !=, b, size_t, "zu"); \
-    } while (0)
+// ==============================================
+// UINT64_T DEBUG ASSERTIONS
+// ==============================================
+
+#define DEBUG_ASSERT_EQ_UINT64(a, b) MYASSERT_DEBUG(ASSERT_EQ_UINT64(a, b))
+#define DEBUG_ASSERT_GE_UINT64(a, b) MYASSERT_DEBUG(ASSERT_GE_UINT64(a, b))
+#define DEBUG_ASSERT_GT_UINT64(a, b) MYASSERT_DEBUG(ASSERT_GT_UINT64(a, b))
+#define DEBUG_ASSERT_LE_UINT64(a, b) MYASSERT_DEBUG(ASSERT_LE_UINT64(a, b))
+#define DEBUG_ASSERT_LT_UINT64(a, b) MYASSERT_DEBUG(ASSERT_LT_UINT64(a, b))
+#define DEBUG_ASSERT_NE_UINT64(a, b) MYASSERT_DEBUG(ASSERT_NE_UINT64(a, b))
 
 // ==============================================
-// CHAR ASSERTIONS
+// SIZE_T DEBUG ASSERTIONS
 // ==============================================
 
-#define ASSERT_EQ_CHAR(a, b)              \
-    do                                    \
-    {                                     \
-        TYPE_CHECK(a, char);              \
-        TYPE_CHECK(b, char);              \
-        ASSERT_BASE(a, ==, b, char, "c"); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_SIZE(a, b) MYASSERT_DEBUG(ASSERT_EQ_SIZE(a, b))
+#define DEBUG_ASSERT_GE_SIZE(a, b) MYASSERT_DEBUG(ASSERT_GE_SIZE(a, b))
+#define DEBUG_ASSERT_GT_SIZE(a, b) MYASSERT_DEBUG(ASSERT_GT_SIZE(a, b))
+#define DEBUG_ASSERT_LE_SIZE(a, b) MYASSERT_DEBUG(ASSERT_LE_SIZE(a, b))
+#define DEBUG_ASSERT_LT_SIZE(a, b) MYASSERT_DEBUG(ASSERT_LT_SIZE(a, b))
+#define DEBUG_ASSERT_NE_SIZE(a, b) MYASSERT_DEBUG(ASSERT_NE_SIZE(a, b))
 
-#define ASSERT_NE_CHAR(a, b)              \
-    do                                    \
-    {                                     \
-        TYPE_CHECK(a, char);              \
-        TYPE_CHECK(b, char);              \
-        ASSERT_BASE(a, !=, b, char, "c"); \
-    } while (0)
+// ==============================================
+// CHAR DEBUG ASSERTIONS
+// ==============================================
 
-#define ASSERT_EQ_UCHAR(a, b)                      \
-    do                                             \
-    {                                              \
-        TYPE_CHECK(a, unsigned char);              \
-        TYPE_CHECK(b, unsigned char);              \
-        ASSERT_BASE(a, ==, b, unsigned char, "u"); \
-    } while (0)
+#define DEBUG_ASSERT_EQ_CHAR(a, b) MYASSERT_DEBUG(ASSERT_EQ_CHAR(a, b))
+#define DEBUG_ASSERT_NE_CHAR(a, b) MYASSERT_DEBUG(ASSERT_NE_CHAR(a, b))
+#define DEBUG_ASSERT_EQ_UCHAR(a, b) MYASSERT_DEBUG(ASSERT_EQ_UCHAR(a, b))
+#define DEBUG_ASSERT_NE_UCHAR(a, b) MYASSERT_DEBUG(ASSERT_NE_UCHAR(a, b))
 
-#define ASSERT_NE_UCHAR(a, b)                      \
-    do                                             \
-    {                                              \
-        TYPE_CHECK(a, unsigned char);              \
-        TYPE_CHECK(b, unsigned char);              \
-        ASSERT_BASE(a, !=, b, unsigned char, "u"); \
-    } while (0)
+#endif
 
 // ==============================================
-// FLOAT ASSERTIONS (with epsilon)
+// FLOAT DEBUG ASSERTIONS
 // ==============================================
 
-#define ASSERT_EQ_FLOAT(a, b, epsilon)                               \
-    do                                                               \
-    {                                                                \
-        TYPE_CHECK(a, float);                                        \
-        TYPE_CHECK(b, float);                                        \
-        TYPE_CHECK(epsilon, float);                                  \
-        float const eval_a = (a);                                    \
-        float const eval_b = (b);                                    \
-        float const eval_eps = (epsilon);                            \
-        if (!(fabsf(eval_a - eval_b) <= eval_eps))                   \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s == %s` " \
-                    "(%f == %f, diff: %f > %f)\n",                   \
-                    __FILE__, __LINE__, #a, #b, eval_a, eval_b,      \
-                    fabsf(eval_a - eval_b), eval_eps);               \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
-
-#define ASSERT_NE_FLOAT(a, b, epsilon)                               \
-    do                                                               \
-    {                                                                \
-        TYPE_CHECK(a, float);                                        \
-        TYPE_CHECK(b, float);                                        \
-        TYPE_CHECK(epsilon, float);                                  \
-        float const eval_a = (a);                                    \
-        float const eval_b = (b);                                    \
-        float const eval_eps = (epsilon);                            \
-        if (!(fabsf(eval_a - eval_b) > eval_eps))                    \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s != %s` " \
-                    "(%f != %f, diff: %f <= %f)\n",                  \
-                    __FILE__, __LINE__, #a, #b, eval_a, eval_b,      \
-                    fabsf(eval_a - eval_b), eval_eps);               \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+#define DEBUG_ASSERT_EQ_FLOAT(a, b, epsilon) \
+    MYASSERT_DEBUG(ASSERT_EQ_FLOAT(a, b, epsilon))
+#define DEBUG_ASSERT_NE_FLOAT(a, b, epsilon) \
+    MYASSERT_DEBUG(ASSERT_NE_FLOAT(a, b, epsilon))
+#define DEBUG_ASSERT_NEAR_FLOAT(a, b, abs_tol, rel_tol) \
+    MYASSERT_DEBUG(ASSERT_NEAR_FLOAT(a, b, abs_tol, rel_tol))
+#define DEBUG_ASSERT_ULP_FLOAT(a, b, ulps) \
+    MYASSERT_DEBUG(ASSERT_ULP_FLOAT(a, b, ulps))
+#define DEBUG_ASSERT_NEAR_ARRAY_FLOAT(a, b, count, abs_tol, rel_tol) \
+    MYASSERT_DEBUG(ASSERT_NEAR_ARRAY_FLOAT(a, b, count, abs_tol, rel_tol))
+#define DEBUG_ASSERT_ULP_ARRAY_FLOAT(a, b, count, ulps) \
+    MYASSERT_DEBUG(ASSERT_ULP_ARRAY_FLOAT(a, b, count, ulps))
 
 // ==============================================
-// DOUBLE ASSERTIONS (with epsilon)
+// DOUBLE DEBUG ASSERTIONS
 // ==============================================
 
-#define ASSERT_EQ_DOUBLE(a, b, epsilon)                              \
-    do                                                               \
-    {                                                                \
-        TYPE_CHECK(a, double);                                       \
-        TYPE_CHECK(b, double);                                       \
-        TYPE_CHECK(epsilon, double);                                 \
-        double const eval_a = (a);                                   \
-        double const eval_b = (b);                                   \
-        double const eval_eps = (epsilon);                           \
-        if (!(fabs(eval_a - eval_b) <= eval_eps))                    \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s == %s` " \
-                    "(%f == %f, diff: %f > %f)\n",                   \
-                    __FILE__, __LINE__, #a, #b, eval_a, eval_b,      \
-                    fabs(eval_a - eval_b), eval_eps);                \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+#define DEBUG_ASSERT_EQ_DOUBLE(a, b, epsilon) \
+    MYASSERT_DEBUG(ASSERT_EQ_DOUBLE(a, b, epsilon))
+#define DEBUG_ASSERT_NE_DOUBLE(a, b, epsilon) \
+    MYASSERT_DEBUG(ASSERT_NE_DOUBLE(a, b, epsilon))
+#define DEBUG_ASSERT_NEAR_DOUBLE(a, b, abs_tol, rel_tol) \
+    MYASSERT_DEBUG(ASSERT_NEAR_DOUBLE(a, b, abs_tol, rel_tol))
+#define DEBUG_ASSERT_ULP_DOUBLE(a, b, ulps) \
+    MYASSERT_DEBUG(ASSERT_ULP_DOUBLE(a, b, ulps))
+#define DEBUG_ASSERT_NEAR_ARRAY_DOUBLE(a, b, count, abs_tol, rel_tol) \
+    MYASSERT_DEBUG(ASSERT_NEAR_ARRAY_DOUBLE(a, b, count, abs_tol, rel_tol))
+#define DEBUG_ASSERT_ULP_ARRAY_DOUBLE(a, b, count, ulps) \
+    MYASSERT_DEBUG(ASSERT_ULP_ARRAY_DOUBLE(a, b, count, ulps))
 
-#define ASSERT_NE_DOUBLE(a, b, epsilon)                              \
-    do                                                               \
-    {                                                                \
-        TYPE_CHECK(a, double);                                       \
-        TYPE_CHECK(b, double);                                       \
-        TYPE_CHECK(epsilon, double);                                 \
-        double const eval_a = (a);                                   \
-        double const eval_b = (b);                                   \
-        double const eval_eps = (epsilon);                           \
-        if (!(fabs(eval_a - eval_b) > eval_eps))                     \
-        {                                                            \
-            fprintf(stderr,                                          \
-                    "Assertion failed in %s on line %d: `%s != %s` " \
-                    "(%f != %f, diff: %f <= %f)\n",                  \
-                    __FILE__, __LINE__, #a, #b, eval_a, eval_b,      \
-                    fabs(eval_a - eval_b), eval_eps);                \
-            abort();                                                 \
-        }                                                            \
-    } while (0)
+// ==============================================
+// ARRAY DEBUG ASSERTIONS
+// ==============================================
+
+#define DEBUG_ASSERT_EQ_ARRAY_INT8(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_INT8(a, b, count))
+#define DEBUG_ASSERT_ALL_INT8(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_INT8(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_UINT8(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_UINT8(a, b, count))
+#define DEBUG_ASSERT_ALL_UINT8(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_UINT8(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_INT16(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_INT16(a, b, count))
+#define DEBUG_ASSERT_ALL_INT16(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_INT16(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_UINT16(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_UINT16(a, b, count))
+#define DEBUG_ASSERT_ALL_UINT16(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_UINT16(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_INT32(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_INT32(a, b, count))
+#define DEBUG_ASSERT_ALL_INT32(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_INT32(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_UINT32(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_UINT32(a, b, count))
+#define DEBUG_ASSERT_ALL_UINT32(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_UINT32(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_INT64(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_INT64(a, b, count))
+#define DEBUG_ASSERT_ALL_INT64(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_INT64(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_UINT64(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_UINT64(a, b, count))
+#define DEBUG_ASSERT_ALL_UINT64(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_UINT64(a, value, count))
+#define DEBUG_ASSERT_EQ_ARRAY_SIZE(a, b, count) \
+    MYASSERT_DEBUG(ASSERT_EQ_ARRAY_SIZE(a, b, count))
+#define DEBUG_ASSERT_ALL_SIZE(a, value, count) \
+    MYASSERT_DEBUG(ASSERT_ALL_SIZE(a, value, count))
 
 #endif
@@ -0,0 +1,448 @@
+// MIT License
+
+// Copyright (c) 2025 savashn
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MYASSERT_HPP
+#define MYASSERT_HPP
+
+// C++ front-end for myassert.h. ASSERT_EQ, ASSERT_NE, ASSERT_LT, ASSERT_LE,
+// ASSERT_GT and ASSERT_GE deduce the operand types instead of naming them,
+// so one macro replaces the ASSERT_*_INT8 ... ASSERT_*_SIZE matrix. The
+// typed macros are not defined here unless MYASSERT_TYPED_MACROS is 1.
+// Needs C++11.
+
+#ifndef MYASSERT_TYPED_MACROS
+#define MYASSERT_TYPED_MACROS 0
+#endif
+
+#include "myassert.h"
+
+#include <iosfwd>
+#include <type_traits>
+
+namespace myassert
+{
+
+// Appends text to a failure message. Custom printers receive one.
+class writer
+{
+public:
+    explicit writer(struct myassert_buf &buf) : buf_(buf)
+    {
+    }
+
+    writer &operator<<(const char *s)
+    {
+        myassert_put_str(&buf_, s);
+        return *this;
+    }
+
+    writer &operator<<(char c)
+    {
+        return write(&c, 1);
+    }
+
+    writer &operator<<(bool b)
+    {
+        return *this << (b ? "true" : "false");
+    }
+
+    template <class T>
+    writer &operator<<(const T &value);
+
+    writer &write(const char *s, size_t len)
+    {
+        myassert_put(&buf_, s, len);
+        return *this;
+    }
+
+    struct myassert_buf &buf()
+    {
+        return buf_;
+    }
+
+private:
+    struct myassert_buf &buf_;
+};
+
+// Prints values of type T in failure messages. Specialize it for a type
+// that has no operator<<, or to print it differently:
+//
+//     template <>
+//     struct myassert::printer<point>
+//     {
+//         static void print(myassert::writer &out, const point &p)
+//         {
+//             out << "(" << p.x << ", " << p.y << ")";
+//         }
+//     };
+template <class T>
+struct printer;
+
+namespace detail
+{
+
+template <class T>
+struct decay
+{
+    typedef typename std::remove_cv<typename std::remove_reference<T>::type>::type type;
+};
+
+template <int N>
+struct rank : rank<N - 1>
+{
+};
+
+template <>
+struct rank<0>
+{
+};
+
+enum category
+{
+    CATEGORY_BOOL,
+    CATEGORY_CHAR,
+    CATEGORY_SIGNED,
+    CATEGORY_UNSIGNED,
+    CATEGORY_FLOAT,
+    CATEGORY_POINTER,
+    CATEGORY_OTHER
+};
+
+template <class T>
+struct integer
+{
+    typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>,
+                                      std::common_type<T>>::type::type type;
+};
+
+template <class T>
+constexpr category category_of()
+{
+    return std::is_same<T, bool>::value   ? CATEGORY_BOOL
+           : std::is_same<T, char>::value ? CATEGORY_CHAR
+           : std::is_integral<T>::value || std::is_enum<T>::value
+               ? (std::is_signed<typename integer<T>::type>::value ? CATEGORY_SIGNED
+                                                                   : CATEGORY_UNSIGNED)
+           : std::is_floating_point<T>::value ? CATEGORY_FLOAT
+           : std::is_pointer<T>::value || std::is_same<T, std::nullptr_t>::value
+               ? CATEGORY_POINTER
+               : CATEGORY_OTHER;
+}
+
+// How the operands of a comparison are checked and reported. Integers of
+// the same signedness are widened to the larger one and reported like
+// the C macros, other arithmetic operands must have the same type, and
+// pointers are reported as addresses. Everything else is compared with
+// its own operator and printed as text.
+template <class A, class B, category CA = category_of<A>(), category CB = category_of<B>()>
+struct comparison
+{
+    static_assert(CA == CATEGORY_OTHER || CB == CATEGORY_OTHER,
+                  "operands of different kinds (signed, unsigned, bool, char, floating "
+                  "point, pointer): cast one of them");
+    typedef void value_type;
+    static constexpr int kind = MYASSERT_SITE_TEXT;
+    static constexpr const char *conv = "s";
+};
+
+template <class A, class B, category C>
+struct comparison<A, B, C, C>
+{
+    static_assert(C != CATEGORY_FLOAT || std::is_same<A, B>::value,
+                  "float compared with double: cast one of them");
+    typedef typename std::conditional<
+        C == CATEGORY_POINTER, const volatile void *,
+        typename std::conditional<(sizeof(B) > sizeof(A)), B, A>::type>::type value_type;
+    static constexpr int kind = MYASSERT_SITE_VALUE;
+    static constexpr const char *conv = C == CATEGORY_POINTER    ? "p"
+                                        : C == CATEGORY_FLOAT    ? "f"
+                                        : C == CATEGORY_CHAR     ? "c"
+                                        : C == CATEGORY_UNSIGNED ? PRIu64
+                                                                 : PRId64;
+};
+
+template <class A, class B>
+struct comparison<A, B, CATEGORY_OTHER, CATEGORY_OTHER>
+{
+    typedef void value_type;
+    static constexpr int kind = MYASSERT_SITE_TEXT;
+    static constexpr const char *conv = "s";
+};
+
+// An operand converted to the reported type, which is what
+// myassert_put_value reads back.
+template <class V>
+struct value
+{
+    template <class T>
+    explicit value(const T &v) : raw(static_cast<V>(v))
+    {
+    }
+    V raw;
+};
+
+template <class T>
+static inline void print_value(writer &out, const T &v, rank<0>)
+{
+    static const char digits[] = "0123456789abcdef";
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&v);
+    out << "<" << sizeof(T) << "-byte object ";
+    for (size_t i = 0; i < sizeof(T) && i < 16; i++)
+    {
+        char hex[2] = {digits[bytes[i] >> 4], digits[bytes[i] & 15]};
+        out.write(hex, sizeof(hex));
+    }
+    out << (sizeof(T) > 16 ? "...>" : ">");
+}
+
+// Lets operator<< write into a writer. Char is always char; it only
+// defers the need for <ostream> to the types that are printed this way.
+template <class Char>
+class stream_buffer : public std::basic_streambuf<Char>
+{
+public:
+    typedef typename std::basic_streambuf<Char>::int_type int_type;
+    typedef typename std::basic_streambuf<Char>::traits_type traits_type;
+
+    explicit stream_buffer(writer &out) : out_(out)
+    {
+    }
+
+protected:
+    int_type overflow(int_type c)
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            char ch = traits_type::to_char_type(c);
+            out_.write(&ch, 1);
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(const Char *s, std::streamsize n)
+    {
+        out_.write(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    writer &out_;
+};
+
+template <class T, class Char = char>
+static inline auto print_value(writer &out, const T &v, rank<1>)
+    -> decltype(std::declval<std::basic_ostream<Char> &>() << v, void())
+{
+    stream_buffer<Char> buffer(out);
+    std::basic_ostream<Char> stream(&buffer);
+    stream << v;
+}
+
+template <class T>
+static inline auto print_value(writer &out, const T &v, rank<2>)
+    -> decltype(out.write(v.data(), v.size()), void())
+{
+    out.write(v.data(), v.size());
+}
+
+template <class T>
+static inline
+    typename std::enable_if<comparison<T, T>::kind == MYASSERT_SITE_VALUE>::type
+    print_value(writer &out, const T &v, rank<3>)
+{
+    typedef comparison<T, T> traits;
+    value<typename traits::value_type> raw(v);
+    myassert_put_value(&out.buf(), traits::conv,
+                       reinterpret_cast<const unsigned char *>(&raw.raw), sizeof(raw.raw));
+}
+
+template <class T>
+static inline auto print_value(writer &out, const T &v, rank<4>)
+    -> decltype(printer<T>::print(out, v), void())
+{
+    printer<T>::print(out, v);
+}
+
+} // namespace detail
+
+template <class T>
+inline writer &writer::operator<<(const T &value)
+{
+    detail::print_value(*this, value, detail::rank<4>());
+    return *this;
+}
+
+namespace detail
+{
+
+// Formats an operand into text that outlives the failure record only as
+// long as the caller's frame, like the strings of ASSERT_EQ_STR.
+template <class T>
+static inline void format(char *text, size_t size, const T &v)
+{
+    struct myassert_buf buf = {text, 0, size - 1};
+    writer out(buf);
+    out << v;
+    text[buf.len] = '\0';
+}
+
+template <class A, class B>
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void fail(const struct myassert_site *site, const A &a, const B &b, std::true_type)
+{
+    typedef typename comparison<A, B>::value_type V;
+    value<V> va(a);
+    value<V> vb(b);
+    myassert_fail_value(site, &va.raw, &vb.raw, sizeof(V));
+}
+
+template <class A, class B>
+MYASSERT_COLD MYASSERT_ATTR((noreturn))
+static void fail(const struct myassert_site *site, const A &a, const B &b, std::false_type)
+{
+    char text[2][MYASSERT_MESSAGE_SIZE / 4];
+    format(text[0], sizeof(text[0]), a);
+    format(text[1], sizeof(text[1]), b);
+    myassert_fail_text(site, text[0], text[1], SIZE_MAX);
+}
+
+template <class A, class B>
+MYASSERT_COLD
+static void expect(const struct myassert_site *site, const A &a, const B &b, std::true_type)
+{
+    typedef typename comparison<A, B>::value_type V;
+    value<V> va(a);
+    value<V> vb(b);
+    myassert_expect_value(site, &va.raw, &vb.raw, sizeof(V));
+}
+
+template <class A, class B>
+MYASSERT_COLD
+static void expect(const struct myassert_site *site, const A &a, const B &b, std::false_type)
+{
+    char text[2][MYASSERT_EXPECT_CAPTURE];
+    format(text[0], sizeof(text[0]), a);
+    format(text[1], sizeof(text[1]), b);
+    myassert_expect_text(site, text[0], text[1], SIZE_MAX);
+}
+
+template <class A, class B>
+struct is_value
+    : std::integral_constant<bool, comparison<typename decay<A>::type,
+                                              typename decay<B>::type>::kind ==
+                                       MYASSERT_SITE_VALUE>
+{
+};
+
+// The operators are types so that a check expands to a single call, and
+// every check on the same operand types shares one instantiation instead
+// of each carrying its own comparison and failure path.
+#define MYASSERT_OPERATOR(name, operator)                 \
+    struct name                                           \
+    {                                                     \
+        template <class A, class B>                       \
+        static bool test(const A &a, const B &b)          \
+        {                                                 \
+            return a operator b;                          \
+        }                                                 \
+    }
+
+MYASSERT_OPERATOR(eq, ==);
+MYASSERT_OPERATOR(ne, !=);
+MYASSERT_OPERATOR(lt, <);
+MYASSERT_OPERATOR(le, <=);
+MYASSERT_OPERATOR(gt, >);
+MYASSERT_OPERATOR(ge, >=);
+
+#undef MYASSERT_OPERATOR
+
+template <class Op, class A, class B>
+static inline void check_fail(const struct myassert_site *site, const A &a, const B &b)
+{
+    if (MYASSERT_UNLIKELY(!Op::test(a, b)))
+    {
+        fail(site, a, b, is_value<A, B>());
+    }
+}
+
+template <class Op, class A, class B>
+static inline void check_expect(const struct myassert_site *site, const A &a, const B &b)
+{
+    if (MYASSERT_UNLIKELY(!Op::test(a, b)))
+    {
+        expect(site, a, b, is_value<A, B>());
+    }
+}
+
+} // namespace detail
+
+} // namespace myassert
+
+// =============================================================
+// DEDUCED COMPARISONS
+// =============================================================
+
+#undef ASSERT_EQ
+#undef ASSERT_NE
+#undef ASSERT_LT
+#undef ASSERT_LE
+#undef ASSERT_GT
+#undef ASSERT_GE
+#undef EXPECT_EQ
+#undef EXPECT_NE
+#undef EXPECT_LT
+#undef EXPECT_LE
+#undef EXPECT_GT
+#undef EXPECT_GE
+
+#define MYASSERT_COMPARE(macro, level, handler, a, op, operator, b)                     \
+    do                                                                                  \
+    {                                                                                   \
+        typedef ::myassert::detail::comparison<                                         \
+            ::myassert::detail::decay<decltype(a)>::type,                               \
+            ::myassert::detail::decay<decltype(b)>::type>                               \
+            myassert_comparison;                                                        \
+        if (!MYASSERT_ENABLED(level))                                                   \
+        {                                                                               \
+            break;                                                                      \
+        }                                                                               \
+        MYASSERT_SITE(level, myassert_site, macro, myassert_comparison::kind,           \
+                      #a, #operator, #b, myassert_comparison::conv);                    \
+        MYASSERT_HIT(myassert_site);                                                    \
+        ::myassert::detail::handler< ::myassert::detail::op>(&myassert_site, (a), (b)); \
+    } while (0)
+
+#define ASSERT_EQ(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, eq, ==, b)
+#define ASSERT_NE(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, ne, !=, b)
+#define ASSERT_LT(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, lt, <, b)
+#define ASSERT_LE(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, le, <=, b)
+#define ASSERT_GT(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, gt, >, b)
+#define ASSERT_GE(a, b) MYASSERT_COMPARE("ASSERT", MYASSERT_LEVEL_FATAL, check_fail, a, ge, >=, b)
+
+#define EXPECT_EQ(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, eq, ==, b)
+#define EXPECT_NE(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, ne, !=, b)
+#define EXPECT_LT(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, lt, <, b)
+#define EXPECT_LE(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, le, <=, b)
+#define EXPECT_GT(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, gt, >, b)
+#define EXPECT_GE(a, b) MYASSERT_COMPARE("EXPECT", MYASSERT_LEVEL_NORMAL, check_expect, a, ge, >=, b)
+
+#endif
@@ -0,0 +1,314 @@
+// Differential test of the array and tolerance kernels: every check is
+// run with the scalar kernels and with each SIMD kernel the CPU supports,
+// and must find the same first mismatch as an element-by-element loop.
+// The kernel is switched through myassert_simd_level, so the tests take
+// turns.
+//
+//   cc -O2 -D_GNU_SOURCE -DMYASSERT_AVX2=1 -I.. simd.c -o simd -pthread -lm && ./simd
+//   c++ -x c++ -O2 -DMYASSERT_AVX2=1 -I.. simd.c -o simd -pthread && ./simd
+//
+// SIMD_CASES sets the number of random cases per kernel (default 20000)
+// and SIMD_SEED the seed.
+
+#include "myassert.h"
+
+#define MAX_BYTES 1200
+
+static const char *const simd_names[] = {"scalar", "sse2", "avx2"};
+
+static pthread_mutex_t simd_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t simd_state;
+
+static uint64_t simd_random(void)
+{
+    simd_state ^= simd_state << 13;
+    simd_state ^= simd_state >> 7;
+    simd_state ^= simd_state << 17;
+    return simd_state;
+}
+
+static size_t simd_below(size_t n)
+{
+    return n == 0 ? 0 : (size_t)(simd_random() % n);
+}
+
+static unsigned long simd_cases(void)
+{
+    const char *env = getenv("SIMD_CASES");
+    return env != NULL ? strtoul(env, NULL, 10) : 20000;
+}
+
+static void simd_seed(void)
+{
+    const char *env = getenv("SIMD_SEED");
+    simd_state = env != NULL ? strtoull(env, NULL, 10) : 0;
+    if (simd_state == 0)
+    {
+        simd_state = UINT64_C(0x9e3779b97f4a7c15);
+    }
+}
+
+// A length near a multiple of the kernels' 16, 32, 64 and 128 byte steps,
+// or any length up to max, so that every tail size is covered.
+static size_t simd_length(size_t max)
+{
+    if (simd_random() % 2 == 0)
+    {
+        return simd_below(max + 1);
+    }
+    size_t step = (size_t)16 << simd_below(4);
+    size_t length = step * simd_below(max / step + 1) + simd_below(3);
+    length = length > 0 ? length - 1 : 0;
+    return length < max ? length : max;
+}
+
+// An index to change: often the last element, or one that ends a vector.
+static size_t simd_position(size_t count, size_t size)
+{
+    switch (simd_random() % 4)
+    {
+    case 0:
+        return count - 1;
+    case 1:
+    {
+        size_t lanes = ((size_t)16 << simd_below(3)) / size;
+        size_t end = lanes * (simd_below(count / lanes + 1) + 1) - 1;
+        return end < count ? end : count - 1;
+    }
+    default:
+        return simd_below(count);
+    }
+}
+
+static size_t simd_reference(const unsigned char *a, const unsigned char *b, size_t count,
+                             size_t size, bool all, size_t from)
+{
+    for (size_t i = from; i < count; i++)
+    {
+        if (memcmp(a + i * size, all ? b : b + i * size, size) != 0)
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+TEST(simd_array_mismatch)
+{
+    static unsigned char a_buffer[MAX_BYTES + 32];
+    static unsigned char b_buffer[MAX_BYTES + 32];
+    static const size_t sizes[] = {1, 2, 4, 8};
+    int widest = myassert_simd();
+    unsigned long cases = simd_cases();
+
+    pthread_mutex_lock(&simd_lock);
+    simd_seed();
+    for (unsigned long n = 0; n < cases; n++)
+    {
+        size_t size = sizes[simd_below(4)];
+        size_t count = simd_length(MAX_BYTES) / size;
+        bool all = simd_random() % 4 == 0;
+        // Misaligned by any amount, so loads never line up by accident.
+        unsigned char *a = a_buffer + simd_below(32);
+        unsigned char *b = b_buffer + simd_below(32);
+        for (size_t i = 0; i < size; i++)
+        {
+            b[i] = (unsigned char)simd_random();
+        }
+        for (size_t i = 0; i < count * size; i++)
+        {
+            a[i] = all ? b[i % size] : (unsigned char)simd_random();
+            if (!all)
+            {
+                b[i] = a[i];
+            }
+        }
+        for (int change = (int)simd_below(3); count > 0 && change > 0; change--)
+        {
+            size_t at = simd_position(count, size) * size + simd_below(size);
+            a[at] ^= (unsigned char)(1u << simd_below(8));
+        }
+        size_t from = simd_random() % 4 == 0 ? simd_below(count + 1) : 0;
+
+        size_t want = simd_reference(a, b, count, size, all, from);
+        for (int simd = MYASSERT_SIMD_SCALAR; simd <= widest; simd++)
+        {
+            myassert_simd_level = simd;
+            size_t got = myassert_array_mismatch(a, b, count, size, all, from);
+            if (got != want)
+            {
+                printf("%s: case %lu, %zu elements of %zu bytes%s from %zu\n",
+                       simd_names[simd], n, count, size, all ? " against one value" : "", from);
+            }
+            EXPECT_EQ_SIZE(got, want);
+        }
+        myassert_simd_level = widest;
+    }
+    pthread_mutex_unlock(&simd_lock);
+    RETURN_OK();
+}
+
+// Values around a, including the cases the vector kernels cannot decide
+// and hand back to myassert_near_float.
+static double simd_value(double a, double tolerance)
+{
+    switch (simd_random() % 16)
+    {
+    case 0:
+        return NAN;
+    case 1:
+        return a == 0.0 ? -a : 0.0;
+    case 2:
+        return simd_random() % 2 ? INFINITY : -INFINITY;
+    case 3:
+        return -a;
+    case 4:
+        return a * (1.0 + tolerance * 4.0);
+    case 5:
+        return a + tolerance * ((double)simd_below(5) - 2.0);
+    default:
+        return a;
+    }
+}
+
+static double simd_start(void)
+{
+    switch (simd_random() % 8)
+    {
+    case 0:
+        return 0.0;
+    case 1:
+        return -0.0;
+    case 2:
+        return ldexp((double)(simd_random() >> 11), -1100);
+    case 3:
+        return ldexp((double)(simd_random() >> 11), 900);
+    case 4:
+        return NAN;
+    default:
+        return ((double)(simd_random() >> 11) / 9007199254740992.0 - 0.5) * 1000.0;
+    }
+}
+
+struct simd_tolerance
+{
+    double abs_tol;
+    double rel_tol;
+    uint64_t ulps;
+};
+
+static struct simd_tolerance simd_tolerance(void)
+{
+    static const double tolerances[] = {0.0, 1e-30, 1e-6, 1e-3, 1.0};
+    static const uint64_t ulps[] = {0, 1, 4, 1u << 20, UINT64_MAX};
+    struct simd_tolerance t;
+    t.abs_tol = tolerances[simd_below(5)];
+    t.rel_tol = tolerances[simd_below(5)];
+    t.ulps = ulps[simd_below(5)];
+    return t;
+}
+
+TEST(simd_near_array_float)
+{
+    static float a[MAX_BYTES / 4];
+    static float b[MAX_BYTES / 4];
+    int widest = myassert_simd();
+    unsigned long cases = simd_cases();
+
+    pthread_mutex_lock(&simd_lock);
+    simd_seed();
+    for (unsigned long n = 0; n < cases; n++)
+    {
+        size_t count = simd_length(MAX_BYTES) / sizeof(float);
+        struct simd_tolerance t = simd_tolerance();
+        bool noisy = simd_random() % 2 == 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = (float)simd_start();
+            b[i] = noisy ? (float)simd_value(a[i], t.abs_tol + 1e-6) : a[i];
+        }
+        if (count > 0)
+        {
+            size_t at = simd_position(count, sizeof(float));
+            b[at] = (float)simd_value(a[at], t.abs_tol + 1e-6);
+        }
+        size_t from = simd_random() % 4 == 0 ? simd_below(count + 1) : 0;
+
+        size_t want = from;
+        while (want < count &&
+               myassert_near_float(a[want], b[want], (float)t.abs_tol, (float)t.rel_tol, t.ulps))
+        {
+            want++;
+        }
+        for (int simd = MYASSERT_SIMD_SCALAR; simd <= widest; simd++)
+        {
+            myassert_simd_level = simd;
+            size_t got = myassert_near_array_float(a, b, count, (float)t.abs_tol,
+                                                   (float)t.rel_tol, t.ulps, from);
+            if (got != want)
+            {
+                printf("%s: case %lu, %zu floats from %zu, tolerance %g, %g, %" PRIu64 " ulps\n",
+                       simd_names[simd], n, count, from, t.abs_tol, t.rel_tol, t.ulps);
+            }
+            EXPECT_EQ_SIZE(got, want);
+        }
+        myassert_simd_level = widest;
+    }
+    pthread_mutex_unlock(&simd_lock);
+    RETURN_OK();
+}
+
+TEST(simd_near_array_double)
+{
+    static double a[MAX_BYTES / 8];
+    static double b[MAX_BYTES / 8];
+    int widest = myassert_simd();
+    unsigned long cases = simd_cases();
+
+    pthread_mutex_lock(&simd_lock);
+    simd_seed();
+    for (unsigned long n = 0; n < cases; n++)
+    {
+        size_t count = simd_length(MAX_BYTES) / sizeof(double);
+        struct simd_tolerance t = simd_tolerance();
+        bool noisy = simd_random() % 2 == 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = simd_start();
+            b[i] = noisy ? simd_value(a[i], t.abs_tol + 1e-12) : a[i];
+        }
+        if (count > 0)
+        {
+            size_t at = simd_position(count, sizeof(double));
+            b[at] = simd_value(a[at], t.abs_tol + 1e-12);
+        }
+        size_t from = simd_random() % 4 == 0 ? simd_below(count + 1) : 0;
+
+        size_t want = from;
+        while (want < count && myassert_near_double(a[want], b[want], t.abs_tol, t.rel_tol, t.ulps))
+        {
+            want++;
+        }
+        for (int simd = MYASSERT_SIMD_SCALAR; simd <= widest; simd++)
+        {
+            myassert_simd_level = simd;
+            size_t got =
+                myassert_near_array_double(a, b, count, t.abs_tol, t.rel_tol, t.ulps, from);
+            if (got != want)
+            {
+                printf("%s: case %lu, %zu doubles from %zu, tolerance %g, %g, %" PRIu64 " ulps\n",
+                       simd_names[simd], n, count, from, t.abs_tol, t.rel_tol, t.ulps);
+            }
+            EXPECT_EQ_SIZE(got, want);
+        }
+        myassert_simd_level = widest;
+    }
+    pthread_mutex_unlock(&simd_lock);
+    RETURN_OK();
+}
+
+int main(void)
+{
+    printf("Kernels: scalar to %s\n", simd_names[myassert_simd()]);
+    return myassert_run_all();
+}